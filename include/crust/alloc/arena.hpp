@@ -0,0 +1,295 @@
+#ifndef CRUST_ALLOC_ARENA_HPP
+#define CRUST_ALLOC_ARENA_HPP
+
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace alloc {
+/// bump allocator over a list of chunks. individual frees are no-ops, memory
+/// is given back all at once by `reset' or when the arena is dropped.
+struct Arena {
+private:
+  static constexpr usize MIN_CHUNK = 4096;
+
+  struct Chunk {
+    Chunk *prev;
+    usize capacity;
+  };
+
+  /// pending destructor of a value placed by `alloc', kept in the arena
+  /// itself.
+  struct Drop {
+    Drop *prev;
+    void (*drop)(void *);
+    void *ptr;
+  };
+
+  Chunk *chunk;
+  usize cursor;
+  usize end;
+  Drop *drops;
+
+  template <class T>
+  static void drop_value(void *ptr) {
+    static_cast<T *>(ptr)->~T();
+  }
+
+  /// newest first, so values may refer to older ones while dropping.
+  void run_drops() {
+    while (drops != nullptr) {
+      drops->drop(drops->ptr);
+      drops = drops->prev;
+    }
+  }
+
+  static usize data_of(Chunk *chunk) {
+    return reinterpret_cast<usize>(chunk) + sizeof(Chunk);
+  }
+
+  void grow(usize size, usize align) {
+    usize capacity = chunk == nullptr ? MIN_CHUNK : chunk->capacity * 2;
+    while (capacity < size + align) {
+      capacity *= 2;
+    }
+
+    Chunk *next = static_cast<Chunk *>(
+        Global{}.allocate(sizeof(Chunk) + capacity, alignof(Chunk)));
+    next->prev = chunk;
+    next->capacity = capacity;
+    chunk = next;
+    cursor = data_of(next);
+    end = cursor + capacity;
+  }
+
+  static void free_chunks(Chunk *chunk) {
+    while (chunk != nullptr) {
+      Chunk *prev = chunk->prev;
+      Global{}.deallocate(
+          chunk, sizeof(Chunk) + chunk->capacity, alignof(Chunk));
+      chunk = prev;
+    }
+  }
+
+public:
+  Arena() : chunk{nullptr}, cursor{0}, end{0}, drops{nullptr} {}
+
+  Arena(const Arena &) = delete;
+
+  Arena &operator=(const Arena &) = delete;
+
+  void *allocate(usize size, usize align) {
+    crust_debug_assert(_impl_alloc::is_power_of_two(align));
+
+    usize addr = _impl_alloc::align_up(cursor, align);
+    if (chunk == nullptr || addr + size > end) {
+      grow(size, align);
+      addr = _impl_alloc::align_up(cursor, align);
+    }
+    cursor = addr + size;
+    return reinterpret_cast<void *>(addr);
+  }
+
+  void deallocate(void *, usize, usize) {}
+
+  /// extends the latest allocation in place while its chunk has room,
+  /// anything else is copied to a new block.
+  void *grow(void *ptr, usize old_size, usize new_size, usize align) {
+    usize addr = reinterpret_cast<usize>(ptr);
+    if (addr + old_size == cursor && new_size <= end - addr) {
+      cursor = addr + new_size;
+      return ptr;
+    }
+    void *ret = allocate(new_size, align);
+    std::memcpy(ret, ptr, old_size);
+    return ret;
+  }
+
+  /// always in place, the tail is only reclaimed from the latest allocation.
+  void *shrink(void *ptr, usize old_size, usize new_size, usize) {
+    usize addr = reinterpret_cast<usize>(ptr);
+    if (addr + old_size == cursor) {
+      cursor = addr + new_size;
+    }
+    return ptr;
+  }
+
+  /// moves `value' into the arena. its destructor runs on `reset' or when the
+  /// arena is dropped, and is skipped entirely for trivially destructible
+  /// types.
+  template <class T>
+  RefMut<T> alloc(T value) {
+    T *ptr = static_cast<T *>(allocate(sizeof(T), alignof(T)));
+    new (ptr) T{move(value)};
+    if (!std::is_trivially_destructible<T>::value) {
+      Drop *drop = static_cast<Drop *>(allocate(sizeof(Drop), alignof(Drop)));
+      *drop = Drop{drops, &drop_value<T>, ptr};
+      drops = drop;
+    }
+    return RefMut<T>{*ptr};
+  }
+
+  /// releases every allocation at once, the newest chunk is kept for reuse.
+  void reset() {
+    run_drops();
+    if (chunk != nullptr) {
+      free_chunks(chunk->prev);
+      chunk->prev = nullptr;
+      cursor = data_of(chunk);
+    }
+  }
+
+  ~Arena() {
+    run_drops();
+    free_chunks(chunk);
+  }
+};
+
+struct ArenaRef;
+} // namespace alloc
+
+template <class S>
+CRUST_IMPL_FOR(alloc::Allocator<S>, IsSame<S, alloc::ArenaRef>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  void *allocate(usize size, usize align) const {
+    return self().arena->allocate(size, align);
+  }
+
+  void deallocate(void *ptr, usize size, usize align) const {
+    self().arena->deallocate(ptr, size, align);
+  }
+
+  void *grow(void *ptr, usize old_size, usize new_size, usize align) const {
+    return self().arena->grow(ptr, old_size, new_size, align);
+  }
+
+  void *shrink(void *ptr, usize old_size, usize new_size, usize align) const {
+    return self().arena->shrink(ptr, old_size, new_size, align);
+  }
+};
+
+namespace alloc {
+/// copyable handle to an `Arena', for containers that store their allocator
+/// by value.
+struct crust_ebco ArenaRef : Impl<ArenaRef, Trait<Allocator>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  Arena *arena;
+
+public:
+  ArenaRef(Arena &arena) : arena{&arena} {}
+};
+
+/// arena of a single type. values sit back to back in chunks that double in
+/// size, and the destructors of a whole chunk run in one pass on `reset' or
+/// drop, or not at all for trivially destructible types.
+template <class T>
+struct TypedArena {
+private:
+  static constexpr usize MIN_CHUNK = 4096;
+
+  struct Chunk {
+    Chunk *prev;
+    usize capacity;
+  };
+
+  /// room for the header in front of the values, keeping them aligned.
+  static constexpr usize HEADER =
+      (sizeof(Chunk) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+  static constexpr usize ALIGN =
+      alignof(T) > alignof(Chunk) ? alignof(T) : alignof(Chunk);
+
+  Chunk *chunk;
+  T *cursor;
+  T *end;
+
+  static T *data_of(Chunk *chunk) {
+    return reinterpret_cast<T *>(reinterpret_cast<u8 *>(chunk) + HEADER);
+  }
+
+  void grow() {
+    usize capacity = chunk == nullptr ?
+        (sizeof(T) >= MIN_CHUNK ? 1 : MIN_CHUNK / sizeof(T)) :
+        chunk->capacity * 2;
+    Chunk *next = static_cast<Chunk *>(
+        Global{}.allocate(HEADER + capacity * sizeof(T), ALIGN));
+    next->prev = chunk;
+    next->capacity = capacity;
+    chunk = next;
+    cursor = data_of(next);
+    end = cursor + capacity;
+  }
+
+  /// every chunk but the newest one is full.
+  static void drop_values(Chunk *chunk, T *cursor) {
+    if (std::is_trivially_destructible<T>::value) {
+      return;
+    }
+    for (T *ptr = data_of(chunk); ptr != cursor; ++ptr) {
+      ptr->~T();
+    }
+    for (Chunk *prev = chunk->prev; prev != nullptr; prev = prev->prev) {
+      T *data = data_of(prev);
+      for (usize i = 0; i < prev->capacity; ++i) {
+        data[i].~T();
+      }
+    }
+  }
+
+  static void free_chunks(Chunk *chunk) {
+    while (chunk != nullptr) {
+      Chunk *prev = chunk->prev;
+      Global{}.deallocate(
+          chunk, HEADER + chunk->capacity * sizeof(T), ALIGN);
+      chunk = prev;
+    }
+  }
+
+public:
+  TypedArena() : chunk{nullptr}, cursor{nullptr}, end{nullptr} {}
+
+  TypedArena(const TypedArena &) = delete;
+
+  TypedArena &operator=(const TypedArena &) = delete;
+
+  RefMut<T> alloc(T value) {
+    if (cursor == end) {
+      grow();
+    }
+    T *ptr = cursor++;
+    new (ptr) T{move(value)};
+    return RefMut<T>{*ptr};
+  }
+
+  /// drops every value at once, the newest chunk is kept for reuse.
+  void reset() {
+    if (chunk != nullptr) {
+      drop_values(chunk, cursor);
+      free_chunks(chunk->prev);
+      chunk->prev = nullptr;
+      cursor = data_of(chunk);
+    }
+  }
+
+  ~TypedArena() {
+    if (chunk != nullptr) {
+      drop_values(chunk, cursor);
+      free_chunks(chunk);
+    }
+  }
+};
+} // namespace alloc
+} // namespace crust
+
+
+#endif // CRUST_ALLOC_ARENA_HPP
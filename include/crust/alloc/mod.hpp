@@ -0,0 +1,368 @@
+#ifndef CRUST_ALLOC_MOD_HPP
+#define CRUST_ALLOC_MOD_HPP
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace _impl_alloc {
+/// strongest alignment `malloc' guarantees on its own.
+constexpr usize DEFAULT_ALIGN = alignof(std::max_align_t);
+
+constexpr bool is_power_of_two(usize value) {
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+inline usize align_up(usize value, usize align) {
+  return (value + align - 1) & ~(align - 1);
+}
+
+inline void *check(void *ptr, usize size) {
+  if (ptr == nullptr && size != 0) {
+    crust_panic("memory allocation failed!");
+  }
+  return ptr;
+}
+} // namespace _impl_alloc
+
+namespace alloc {
+/// allocation counters of one thread. they are only maintained when
+/// `CRUST_ALLOC_STATS' is defined, and stay zero otherwise. crust's own
+/// allocators record their calls, `crust/alloc/stats_new.hpp' adds the
+/// global `operator new' and `operator delete'.
+struct Stats {
+  usize allocations;
+  /// `grow' and `shrink' calls, whether or not the block moved.
+  usize reallocations;
+  usize deallocations;
+  /// total requested, blocks resized in place count their growth.
+  usize allocated_bytes;
+  /// signed, since a block is counted by the thread freeing it, which need
+  /// not be the one that allocated it.
+  isize live_bytes;
+  isize peak_bytes;
+
+  constexpr bool is_zero() const {
+    return allocations == 0 && reallocations == 0 && deallocations == 0;
+  }
+};
+} // namespace alloc
+
+namespace _impl_alloc {
+inline alloc::Stats &local_stats() {
+  static thread_local alloc::Stats stats{};
+  return stats;
+}
+
+crust_always_inline void record_allocate(usize size) {
+#if defined(CRUST_ALLOC_STATS)
+  alloc::Stats &stats = local_stats();
+  ++stats.allocations;
+  stats.allocated_bytes += size;
+  stats.live_bytes += static_cast<isize>(size);
+  if (stats.live_bytes > stats.peak_bytes) {
+    stats.peak_bytes = stats.live_bytes;
+  }
+#else
+  (void)size;
+#endif
+}
+
+crust_always_inline void record_reallocate(usize old_size, usize new_size) {
+#if defined(CRUST_ALLOC_STATS)
+  alloc::Stats &stats = local_stats();
+  ++stats.reallocations;
+  if (new_size > old_size) {
+    stats.allocated_bytes += new_size - old_size;
+  }
+  stats.live_bytes +=
+      static_cast<isize>(new_size) - static_cast<isize>(old_size);
+  if (stats.live_bytes > stats.peak_bytes) {
+    stats.peak_bytes = stats.live_bytes;
+  }
+#else
+  (void)old_size;
+  (void)new_size;
+#endif
+}
+
+crust_always_inline void record_deallocate(usize size) {
+#if defined(CRUST_ALLOC_STATS)
+  alloc::Stats &stats = local_stats();
+  ++stats.deallocations;
+  stats.live_bytes -= static_cast<isize>(size);
+#else
+  (void)size;
+#endif
+}
+} // namespace _impl_alloc
+
+namespace alloc {
+/// counters of the calling thread since it started.
+inline Stats stats() { return _impl_alloc::local_stats(); }
+
+/// counts what the calling thread allocates while the scope is alive, the
+/// peak is measured from the live bytes at construction. the live bytes go
+/// negative when the scope frees more than it allocated. scopes nest.
+struct StatsScope {
+private:
+  Stats start;
+
+public:
+  StatsScope() : start{_impl_alloc::local_stats()} {
+    _impl_alloc::local_stats().peak_bytes = start.live_bytes;
+  }
+
+  StatsScope(const StatsScope &) = delete;
+
+  StatsScope &operator=(const StatsScope &) = delete;
+
+  Stats stats() const {
+    const Stats &now = _impl_alloc::local_stats();
+    return Stats{
+        now.allocations - start.allocations,
+        now.reallocations - start.reallocations,
+        now.deallocations - start.deallocations,
+        now.allocated_bytes - start.allocated_bytes,
+        now.live_bytes - start.live_bytes,
+        now.peak_bytes - start.live_bytes,
+    };
+  }
+
+  /// the thread wide peak covers the scope's peak as well.
+  ~StatsScope() {
+    Stats &now = _impl_alloc::local_stats();
+    if (start.peak_bytes > now.peak_bytes) {
+      now.peak_bytes = start.peak_bytes;
+    }
+  }
+};
+} // namespace alloc
+
+namespace alloc {
+/// source of raw memory for containers. allocators are stored by value, so
+/// stateful ones are small handles such as `ArenaRef'. `grow' and `shrink'
+/// keep the leading bytes of a block and may resize it in place, the
+/// defaults copy it to a new block.
+CRUST_TRAIT(Allocator) {
+  CRUST_TRAIT_USE_SELF(Allocator);
+
+  void *allocate(usize size, usize align) const;
+
+  void deallocate(void *ptr, usize size, usize align) const;
+
+  void *grow(void *ptr, usize old_size, usize new_size, usize align) const {
+    void *ret = self().allocate(new_size, align);
+    std::memcpy(ret, ptr, old_size);
+    self().deallocate(ptr, old_size, align);
+    return ret;
+  }
+
+  void *shrink(void *ptr, usize old_size, usize new_size, usize align) const {
+    void *ret = self().allocate(new_size, align);
+    std::memcpy(ret, ptr, new_size);
+    self().deallocate(ptr, old_size, align);
+    return ret;
+  }
+};
+
+struct Global;
+
+struct ThreadCache;
+} // namespace alloc
+
+template <class S>
+CRUST_IMPL_FOR(alloc::Allocator<S>, IsSame<S, alloc::Global>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  /// over-aligned requests get extra room in front of the block to record
+  /// where the underlying allocation starts.
+  void *allocate(usize size, usize align) const {
+    crust_debug_assert(_impl_alloc::is_power_of_two(align));
+
+    _impl_alloc::record_allocate(size);
+    if (align <= _impl_alloc::DEFAULT_ALIGN) {
+      return _impl_alloc::check(std::malloc(size), size);
+    }
+
+    usize raw_size = size + align - 1 + sizeof(void *);
+    void *raw = _impl_alloc::check(std::malloc(raw_size), raw_size);
+    usize addr = _impl_alloc::align_up(
+        reinterpret_cast<usize>(raw) + sizeof(void *), align);
+    reinterpret_cast<void **>(addr)[-1] = raw;
+    return reinterpret_cast<void *>(addr);
+  }
+
+  void deallocate(void *ptr, usize size, usize align) const {
+    _impl_alloc::record_deallocate(size);
+    if (align <= _impl_alloc::DEFAULT_ALIGN) {
+      std::free(ptr);
+    } else {
+      std::free(static_cast<void **>(ptr)[-1]);
+    }
+  }
+
+  /// a single `realloc', which often extends the block in place.
+  void *grow(void *ptr, usize old_size, usize new_size, usize align) const {
+    if (align > _impl_alloc::DEFAULT_ALIGN) {
+      return alloc::Allocator<S>::grow(ptr, old_size, new_size, align);
+    }
+    _impl_alloc::record_reallocate(old_size, new_size);
+    return _impl_alloc::check(std::realloc(ptr, new_size), new_size);
+  }
+
+  void *shrink(void *ptr, usize old_size, usize new_size, usize align) const {
+    if (align > _impl_alloc::DEFAULT_ALIGN || new_size == 0) {
+      return alloc::Allocator<S>::shrink(ptr, old_size, new_size, align);
+    }
+    _impl_alloc::record_reallocate(old_size, new_size);
+    return _impl_alloc::check(std::realloc(ptr, new_size), new_size);
+  }
+};
+
+namespace alloc {
+/// the global heap.
+struct crust_ebco Global : Impl<Global, Trait<Allocator>> {
+  constexpr Global() {}
+};
+} // namespace alloc
+
+namespace _impl_alloc {
+/// thread local cache of freed blocks, bucketed by size. blocks are never
+/// handed to another thread, so no synchronization is needed. they come
+/// from `malloc' rather than `operator new', which may be counted itself.
+struct FreeList {
+private:
+  static constexpr usize GRANULE = 16;
+  static constexpr usize CLASSES = 128;
+  static constexpr usize CACHE_LIMIT = 64;
+
+  struct Node {
+    Node *next;
+  };
+
+  Node *free_list[CLASSES];
+  usize cached[CLASSES];
+
+  /// empty blocks still take a granule, freeing one stores a `Node' in it.
+  static usize class_of(usize size) {
+    return size == 0 ? 1 : (size + GRANULE - 1) / GRANULE;
+  }
+
+  FreeList() : free_list{}, cached{} {}
+
+public:
+  /// whether a block of `old_size' can hold `new_size' bytes as is.
+  static bool same_class(usize old_size, usize new_size) {
+    usize index = class_of(old_size);
+    return index < CLASSES && index == class_of(new_size);
+  }
+
+  FreeList(const FreeList &) = delete;
+
+  FreeList &operator=(const FreeList &) = delete;
+
+  static FreeList &local() {
+    static thread_local FreeList list;
+    return list;
+  }
+
+  void *allocate(usize size) {
+    usize index = class_of(size);
+    if (index >= CLASSES) {
+      return check(std::malloc(size), size);
+    }
+
+    Node *node = free_list[index];
+    if (node != nullptr) {
+      free_list[index] = node->next;
+      --cached[index];
+      return node;
+    }
+
+    return check(std::malloc(index * GRANULE), index * GRANULE);
+  }
+
+  void deallocate(void *ptr, usize size) {
+    usize index = class_of(size);
+    if (index >= CLASSES || cached[index] >= CACHE_LIMIT) {
+      std::free(ptr);
+      return;
+    }
+
+    Node *node = static_cast<Node *>(ptr);
+    node->next = free_list[index];
+    free_list[index] = node;
+    ++cached[index];
+  }
+
+  ~FreeList() {
+    for (usize i = 0; i < CLASSES; ++i) {
+      while (free_list[i] != nullptr) {
+        Node *node = free_list[i];
+        free_list[i] = node->next;
+        std::free(node);
+      }
+    }
+  }
+};
+} // namespace _impl_alloc
+
+template <class S>
+CRUST_IMPL_FOR(alloc::Allocator<S>, IsSame<S, alloc::ThreadCache>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  void *allocate(usize size, usize align) const {
+    if (align > _impl_alloc::DEFAULT_ALIGN) {
+      return alloc::Global{}.allocate(size, align);
+    }
+    _impl_alloc::record_allocate(size);
+    return _impl_alloc::FreeList::local().allocate(size);
+  }
+
+  void deallocate(void *ptr, usize size, usize align) const {
+    if (align > _impl_alloc::DEFAULT_ALIGN) {
+      alloc::Global{}.deallocate(ptr, size, align);
+    } else {
+      _impl_alloc::record_deallocate(size);
+      _impl_alloc::FreeList::local().deallocate(ptr, size);
+    }
+  }
+
+  /// resizing within a size class keeps the block.
+  void *grow(void *ptr, usize old_size, usize new_size, usize align) const {
+    if (align <= _impl_alloc::DEFAULT_ALIGN &&
+        _impl_alloc::FreeList::same_class(old_size, new_size)) {
+      _impl_alloc::record_reallocate(old_size, new_size);
+      return ptr;
+    }
+    return alloc::Allocator<S>::grow(ptr, old_size, new_size, align);
+  }
+
+  void *shrink(void *ptr, usize old_size, usize new_size, usize align) const {
+    if (align <= _impl_alloc::DEFAULT_ALIGN &&
+        _impl_alloc::FreeList::same_class(old_size, new_size)) {
+      _impl_alloc::record_reallocate(old_size, new_size);
+      return ptr;
+    }
+    return alloc::Allocator<S>::shrink(ptr, old_size, new_size, align);
+  }
+};
+
+namespace alloc {
+/// per thread free list in front of the global heap, blocks must be freed on
+/// the thread that allocated them.
+struct crust_ebco ThreadCache : Impl<ThreadCache, Trait<Allocator>> {
+  constexpr ThreadCache() {}
+};
+} // namespace alloc
+} // namespace crust
+
+
+#endif // CRUST_ALLOC_MOD_HPP
@@ -0,0 +1,155 @@
+#ifndef CRUST_ALLOC_STATS_NEW_HPP
+#define CRUST_ALLOC_STATS_NEW_HPP
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/utility.hpp"
+
+
+/// replaces the global `operator new' and `operator delete' so that memory
+/// bypassing crust's allocators, from `new' expressions or the standard
+/// library, shows up in `alloc::Stats' too. replacement functions may not be
+/// inline, so exactly one translation unit of a program includes this.
+#if !defined(CRUST_ALLOC_STATS)
+#error "`crust/alloc/stats_new.hpp' needs `CRUST_ALLOC_STATS' to be defined"
+#endif
+
+namespace crust {
+namespace _impl_alloc {
+/// stored in front of every block, the unsized `operator delete' has to
+/// learn what it frees.
+struct NewHeader {
+  void *raw;
+  usize size;
+};
+
+inline void *counted_new(usize size, usize align) {
+  usize raw_size = size + align - 1 + sizeof(NewHeader);
+  void *raw = std::malloc(raw_size);
+  if (raw == nullptr) {
+    return nullptr;
+  }
+  usize addr =
+      align_up(reinterpret_cast<usize>(raw) + sizeof(NewHeader), align);
+  reinterpret_cast<NewHeader *>(addr)[-1] = NewHeader{raw, size};
+  record_allocate(size);
+  return reinterpret_cast<void *>(addr);
+}
+
+/// for the variants that cannot return null.
+inline void *counted_new_or_panic(usize size, usize align) {
+  void *ret = counted_new(size, align);
+  if (ret == nullptr) {
+    crust_panic("memory allocation failed!");
+  }
+  return ret;
+}
+
+inline void counted_delete(void *ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  NewHeader header = static_cast<NewHeader *>(ptr)[-1];
+  record_deallocate(header.size);
+  std::free(header.raw);
+}
+} // namespace _impl_alloc
+} // namespace crust
+
+void *operator new(std::size_t size) {
+  return crust::_impl_alloc::counted_new_or_panic(
+      size, crust::_impl_alloc::DEFAULT_ALIGN);
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return crust::_impl_alloc::counted_new(
+      size, crust::_impl_alloc::DEFAULT_ALIGN);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return operator new(size, std::nothrow);
+}
+
+void operator delete(void *ptr) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+
+/// defined for every standard, objects built as c++14 or later call these
+/// even when this translation unit is not.
+void operator delete(void *ptr, std::size_t) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+
+#if defined(__cpp_aligned_new)
+void *operator new(std::size_t size, std::align_val_t align) {
+  return crust::_impl_alloc::counted_new_or_panic(
+      size, static_cast<std::size_t>(align));
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) {
+  return operator new(size, align);
+}
+
+void *operator new(
+    std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+  return crust::_impl_alloc::counted_new(
+      size, static_cast<std::size_t>(align));
+}
+
+void *operator new[](
+    std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+  return crust::_impl_alloc::counted_new(
+      size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+
+void operator delete(
+    void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+
+void operator delete[](
+    void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  crust::_impl_alloc::counted_delete(ptr);
+}
+#endif
+
+
+#endif // CRUST_ALLOC_STATS_NEW_HPP
@@ -0,0 +1,184 @@
+#ifndef CRUST_BORROW_HPP
+#define CRUST_BORROW_HPP
+
+
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/enum.hpp"
+#include "crust/slice.hpp"
+#include "crust/str.hpp"
+#include "crust/string.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+namespace crust {
+namespace borrow {
+template <class B>
+struct Borrowed;
+
+template <class B>
+struct Owned;
+
+template <class B>
+struct Cow;
+
+/// the owned counterpart of a borrowed `B', `B' itself cloned through
+/// `clone::Clone' unless specialized. `View' is what the owned value is
+/// read through as a `B'.
+template <class B>
+struct ToOwned : TmplType<B> {
+  using View = const B &;
+
+  static B to_owned(const B &value) { return _impl_clone::clone_of(value); }
+
+  static View view(const B &owned) { return owned; }
+};
+
+template <>
+struct ToOwned<Str> : TmplType<String> {
+  using View = Str;
+
+  static String to_owned(const Str &value) { return String::from(value); }
+
+  static View view(const String &owned) { return owned.as_str(); }
+};
+
+template <class T>
+struct ToOwned<Slice<const T>> : TmplType<Vec<T>> {
+  using View = Slice<const T>;
+
+  static Vec<T> to_owned(const Slice<const T> &value) {
+    Vec<T> ret = Vec<T>::with_capacity(value.len());
+    ret.extend_from_slice(value);
+    return ret;
+  }
+
+  static View view(const Vec<T> &owned) { return owned.as_slice(); }
+};
+} // namespace borrow
+
+using borrow::Cow;
+
+template <class B>
+struct BluePrint<borrow::Borrowed<B>> : TmplType<TupleStruct<Ref<B>>> {};
+
+template <class B>
+struct BluePrint<borrow::Owned<B>> :
+    TmplType<TupleStruct<typename borrow::ToOwned<B>::Result>> {};
+
+template <class B>
+struct BluePrint<Cow<B>> :
+    TmplType<Enum<borrow::Borrowed<B>, borrow::Owned<B>>> {};
+
+template <class B>
+CRUST_IMPL_FOR(clone::Clone<Cow<B>>) {
+  CRUST_IMPL_USE_SELF(Cow<B>);
+
+  Self clone() const {
+    return self().template visit<Self>(
+        [](const borrow::Borrowed<B> &value) {
+          return borrow::Borrowed<B>{value.template get<0>()};
+        },
+        [](const borrow::Owned<B> &value) {
+          return borrow::Owned<B>{
+              _impl_clone::clone_of(value.template get<0>())};
+        });
+  }
+};
+
+template <class B>
+CRUST_IMPL_FOR(cmp::PartialEq<Cow<B>>, Require<B, cmp::PartialEq>) {
+  CRUST_IMPL_USE_SELF(Cow<B>);
+
+  bool eq(const Self &other) const { return *self() == *other; }
+};
+
+template <class B>
+CRUST_IMPL_FOR(cmp::Eq<Cow<B>>, Require<B, cmp::Eq>){};
+
+namespace borrow {
+template <class B>
+CRUST_ENUM_TUPLE_VARIANT(Borrowed, Borrowed<B>, Ref<B>);
+
+template <class B>
+CRUST_ENUM_TUPLE_VARIANT(Owned, Owned<B>, typename ToOwned<B>::Result);
+
+/// clone on write, a value that is borrowed until it has to be changed.
+/// `to_mut' turns the borrowed value into its owned form through `ToOwned'
+/// the first time it is called, e.g. a `Str' into a `String', so a pipeline
+/// that passes most of its input through unchanged only pays for the values
+/// it actually rewrites.
+template <class B>
+struct crust_ebco Cow :
+    Enum<Borrowed<B>, Owned<B>>,
+    Impl<Cow<B>, Trait<clone::Clone>, Trait<cmp::PartialEq>, Trait<cmp::Eq>> {
+  CRUST_ENUM_USE_BASE(Cow, Enum<Borrowed<B>, Owned<B>>);
+
+  using Target = typename ToOwned<B>::Result;
+  using View = typename ToOwned<B>::View;
+
+  /// what `operator->' returns, keeps a `View' held by value alive until
+  /// the member access is done.
+  struct Arrow {
+    View view;
+
+    const typename RemoveConstOrRefType<View>::Result *operator->() const {
+      return &view;
+    }
+  };
+
+  constexpr bool is_borrowed() const {
+    return this->template is_variant<Borrowed<B>>();
+  }
+
+  constexpr bool is_owned() const {
+    return this->template is_variant<Owned<B>>();
+  }
+
+  constexpr View operator*() const {
+    return this->template visit<View>(
+        [](const Borrowed<B> &value) -> View {
+          return *value.template get<0>();
+        },
+        [](const Owned<B> &value) -> View {
+          return ToOwned<B>::view(value.template get<0>());
+        });
+  }
+
+  Arrow operator->() const { return Arrow{**this}; }
+
+  /// the owned value, converting the borrowed one first if needed.
+  Target &to_mut() {
+    if (is_borrowed()) {
+      *this = Owned<B>{ToOwned<B>::to_owned(**this)};
+    }
+    return this->template visit<Target &>(
+        [](Borrowed<B> &) -> Target & { crust_unreachable(); },
+        [](Owned<B> &value) -> Target & { return value.template get<0>(); });
+  }
+
+  /// the owned value, the borrowed one is converted.
+  Target into_owned() && {
+    return this->template visit<Target>(
+        [](Borrowed<B> &value) {
+          return ToOwned<B>::to_owned(*value.template get<0>());
+        },
+        [](Owned<B> &value) { return move(value.template get<0>()); });
+  }
+};
+
+template <class B>
+constexpr Cow<B> make_borrowed(const B &value) {
+  return Borrowed<B>{Ref<B>{value}};
+}
+
+template <class B>
+constexpr Cow<typename RemoveConstOrRefType<B>::Result> make_owned(B &&value) {
+  return Owned<typename RemoveConstOrRefType<B>::Result>{forward<B>(value)};
+}
+} // namespace borrow
+} // namespace crust
+
+
+#endif // CRUST_BORROW_HPP
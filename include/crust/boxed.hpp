@@ -0,0 +1,416 @@
+#ifndef CRUST_BOXED_HPP
+#define CRUST_BOXED_HPP
+
+
+#include <new>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/fmt/mod.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/ops/function.hpp"
+#include "crust/option.hpp"
+#include "crust/tuple.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace boxed {
+/// owning pointer to a single value in memory from `A'. a moved from box is
+/// empty and must not be dereferenced.
+template <class T, class A = alloc::Global>
+struct crust_ebco Box :
+    private A,
+    Impl<
+        Box<T, A>,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<cmp::PartialOrd>,
+        Trait<cmp::Ord>,
+        Trait<fmt::Debug>,
+        Trait<fmt::Display>> {
+private:
+  crust_static_assert(!IsConstOrRefVal<T>::result);
+
+  T *ptr;
+
+  A &allocator() { return *this; }
+
+  void drop() {
+    if (ptr != nullptr) {
+      ptr->~T();
+      allocator().deallocate(ptr, sizeof(T), alignof(T));
+      ptr = nullptr;
+    }
+  }
+
+  struct Raw {};
+
+  Box(Raw, T *ptr, A alloc) : A{alloc}, ptr{ptr} {}
+
+public:
+  explicit Box(T value, A alloc = A{}) : A{alloc}, ptr{nullptr} {
+    void *raw = allocator().allocate(sizeof(T), alignof(T));
+    ptr = ::new (raw) T{move(value)};
+  }
+
+  /// takes ownership of `ptr', which must come from `alloc' with the size
+  /// and alignment of `T'.
+  static Box from_raw(T *ptr, A alloc = A{}) { return Box{Raw{}, ptr, alloc}; }
+
+  Box(const Box &) = delete;
+
+  Box(Box &&other) noexcept : A{other.allocator()}, ptr{other.ptr} {
+    other.ptr = nullptr;
+  }
+
+  Box &operator=(const Box &) = delete;
+
+  Box &operator=(Box &&other) noexcept {
+    if (this != &other) {
+      drop();
+      allocator() = other.allocator();
+      ptr = other.ptr;
+      other.ptr = nullptr;
+    }
+
+    return *this;
+  }
+
+  const A &allocator() const { return *this; }
+
+  const T *as_ptr() const { return ptr; }
+
+  T *as_mut_ptr() { return ptr; }
+
+  const T &operator*() const {
+    crust_debug_assert(ptr != nullptr);
+    return *ptr;
+  }
+
+  T &operator*() {
+    crust_debug_assert(ptr != nullptr);
+    return *ptr;
+  }
+
+  const T *operator->() const { return &**this; }
+
+  T *operator->() { return &**this; }
+
+  /// releases ownership without dropping the value.
+  T *into_raw() {
+    T *ret = ptr;
+    ptr = nullptr;
+    return ret;
+  }
+
+  /// moves the value out and frees the memory.
+  T into_inner() {
+    T value{move(**this)};
+    drop();
+    return value;
+  }
+
+  ~Box() { drop(); }
+};
+
+/// dyn compatible traits specialize this for their `Trait<...>' marker with
+///
+///  - `Methods', a table of function pointers taking the erased object,
+///  - `template <class Self> static constexpr Methods methods()', filling
+///    the table for a concrete type,
+///
+/// and implement the trait itself for `DynBox' by forwarding to the table.
+template <class Tr>
+struct DynTrait;
+
+template <class Tr, class A = alloc::Global, usize inline_words = 0>
+struct DynBox;
+
+/// `DynBox' storing objects up to `words' pointers inline.
+template <class Tr, usize words = 3, class A = alloc::Global>
+using InlineDynBox = DynBox<Tr, A, words>;
+} // namespace boxed
+
+namespace _impl_boxed {
+using ops::_impl_fn::Holder;
+using ops::_impl_fn::IsInline;
+using ops::_impl_fn::Storage;
+
+template <class Tr, class A>
+struct VTable {
+  void (*drop)(void *, A &);
+  void (*relocate)(void *, void *);
+  usize size;
+  usize align;
+  bool is_inline;
+  typename boxed::DynTrait<Tr>::Methods methods;
+};
+
+template <class Self, class Tr, class A, usize words>
+struct StaticVTable {
+  static const VTable<Tr, A> vtable;
+};
+
+template <class Self, class Tr, class A, usize words>
+const VTable<Tr, A> StaticVTable<Self, Tr, A, words>::vtable{
+    Holder<Self, A, words>::drop,
+    Holder<Self, A, words>::relocate,
+    sizeof(Self),
+    alignof(Self),
+    IsInline<Self, words>::result,
+    boxed::DynTrait<Tr>::template methods<Self>(),
+};
+
+template <class Self, class Tr>
+struct Implements;
+
+template <class Self, template <class, class...> class T, class... Args>
+struct Implements<Self, Trait<T, Args...>> : Require<Self, T, Args...> {};
+} // namespace _impl_boxed
+
+namespace boxed {
+/// owning trait object. the vtable is generated from `DynTrait<Tr>' for each
+/// concrete type, so no virtual functions or rtti are involved. objects that
+/// do not fit `inline_words' pointers are placed in memory from `A'.
+template <class Tr, class A, usize inline_words>
+struct crust_ebco DynBox : private A, Impl<DynBox<Tr, A, inline_words>, Tr> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  template <class T>
+  using Self = typename RemoveConstOrRefType<T>::Result;
+
+  using Methods = typename DynTrait<Tr>::Methods;
+
+  _impl_boxed::Storage<inline_words> storage;
+  const _impl_boxed::VTable<Tr, A> *vtable;
+
+  A &allocator() { return *this; }
+
+  void drop() {
+    if (vtable != nullptr) {
+      vtable->drop(&storage, allocator());
+      vtable = nullptr;
+    }
+  }
+
+  void move_from(DynBox &other) {
+    vtable = other.vtable;
+    if (vtable != nullptr) {
+      vtable->relocate(&storage, &other.storage);
+      other.vtable = nullptr;
+    }
+  }
+
+  const Methods &methods() const {
+    crust_debug_assert(vtable != nullptr);
+    return vtable->methods;
+  }
+
+  const void *as_ptr() const {
+    return inline_words != 0 && vtable->is_inline ?
+        static_cast<const void *>(&storage) :
+        storage.ptr;
+  }
+
+  void *as_mut_ptr() {
+    return inline_words != 0 && vtable->is_inline ?
+        static_cast<void *>(&storage) :
+        storage.ptr;
+  }
+
+public:
+  template <
+      class T,
+      class = EnableIf<Not<IsSame<Self<T>, DynBox>>>,
+      class = EnableIf<_impl_boxed::Implements<Self<T>, Tr>>>
+  DynBox(T &&self, A alloc = A{}) :
+      A{alloc},
+      vtable{&_impl_boxed::StaticVTable<Self<T>, Tr, A, inline_words>::vtable} {
+    _impl_boxed::Holder<Self<T>, A, inline_words>::construct(
+        storage, allocator(), forward<T>(self));
+  }
+
+  DynBox(const DynBox &) = delete;
+
+  DynBox(DynBox &&other) noexcept : A{other.allocator()} { move_from(other); }
+
+  DynBox &operator=(const DynBox &) = delete;
+
+  DynBox &operator=(DynBox &&other) noexcept {
+    if (this != &other) {
+      drop();
+      allocator() = other.allocator();
+      move_from(other);
+    }
+
+    return *this;
+  }
+
+  const A &allocator() const { return *this; }
+
+  /// `false' once moved from.
+  bool is_valid() const { return vtable != nullptr; }
+
+  usize size_of_val() const { return vtable->size; }
+
+  usize align_of_val() const { return vtable->align; }
+
+  ~DynBox() { drop(); }
+};
+
+template <>
+struct DynTrait<Trait<fmt::Debug>> {
+  struct Methods {
+    bool (*fmt_debug)(const void *, fmt::Formatter &);
+  };
+
+  template <class Self>
+  static bool fmt_debug(const void *self, fmt::Formatter &fmt) {
+    return static_cast<const Self *>(self)->fmt_debug(fmt);
+  }
+
+  template <class Self>
+  static constexpr Methods methods() {
+    return Methods{fmt_debug<Self>};
+  }
+};
+
+template <>
+struct DynTrait<Trait<fmt::Display>> {
+  struct Methods {
+    bool (*fmt_display)(const void *, fmt::Formatter &);
+  };
+
+  template <class Self>
+  static bool fmt_display(const void *self, fmt::Formatter &fmt) {
+    return static_cast<const Self *>(self)->fmt_display(fmt);
+  }
+
+  template <class Self>
+  static constexpr Methods methods() {
+    return Methods{fmt_display<Self>};
+  }
+};
+
+template <class Item>
+struct DynTrait<Trait<iter::Iterator, Item>> {
+  struct Methods {
+    Option<Item> (*next)(void *);
+    Tuple<usize, Option<usize>> (*size_hint)(const void *);
+  };
+
+  template <class Self>
+  static Option<Item> next(void *self) {
+    return static_cast<Self *>(self)->next();
+  }
+
+  template <class Self>
+  static Tuple<usize, Option<usize>> size_hint(const void *self) {
+    return static_cast<const Self *>(self)->size_hint();
+  }
+
+  template <class Self>
+  static constexpr Methods methods() {
+    return Methods{next<Self>, size_hint<Self>};
+  }
+};
+} // namespace boxed
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(clone::Clone<boxed::Box<T, A>>)) {
+  CRUST_IMPL_USE_SELF(boxed::Box<T, A>);
+
+  Self clone() const {
+    return Self{_impl_clone::clone_of(*self()), self().allocator()};
+  }
+
+  void clone_from(const Self &other) {
+    _impl_clone::clone_into(*self(), *other);
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialEq<boxed::Box<T, A>>)) {
+  CRUST_IMPL_USE_SELF(boxed::Box<T, A>);
+
+  bool eq(const Self &other) const { return *self() == *other; }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Eq<boxed::Box<T, A>>)){};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialOrd<boxed::Box<T, A>>)) {
+  CRUST_IMPL_USE_SELF(boxed::Box<T, A>);
+
+  Option<cmp::Ordering> partial_cmp(const Self &other) const {
+    return operator_partial_cmp(*self(), *other);
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Ord<boxed::Box<T, A>>)) {
+  CRUST_IMPL_USE_SELF(boxed::Box<T, A>);
+
+  cmp::Ordering cmp(const Self &other) const {
+    return operator_cmp(*self(), *other);
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(fmt::Debug<boxed::Box<T, A>>)) {
+  CRUST_IMPL_USE_SELF(boxed::Box<T, A>);
+
+  bool fmt_debug(fmt::Formatter &fmt) const { return self()->fmt_debug(fmt); }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(fmt::Display<boxed::Box<T, A>>)) {
+  CRUST_IMPL_USE_SELF(boxed::Box<T, A>);
+
+  bool fmt_display(fmt::Formatter &fmt) const {
+    return self()->fmt_display(fmt);
+  }
+};
+
+template <class A, usize words>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(fmt::Debug<boxed::DynBox<Trait<fmt::Debug>, A, words>>)) {
+  CRUST_IMPL_USE_SELF(boxed::DynBox<Trait<fmt::Debug>, A, words>);
+
+  bool fmt_debug(fmt::Formatter &fmt) const {
+    return self().methods().fmt_debug(self().as_ptr(), fmt);
+  }
+};
+
+template <class A, usize words>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(fmt::Display<boxed::DynBox<Trait<fmt::Display>, A, words>>)) {
+  CRUST_IMPL_USE_SELF(boxed::DynBox<Trait<fmt::Display>, A, words>);
+
+  bool fmt_display(fmt::Formatter &fmt) const {
+    return self().methods().fmt_display(self().as_ptr(), fmt);
+  }
+};
+
+template <class Item, class A, usize words>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<
+                           boxed::DynBox<Trait<iter::Iterator, Item>, A, words>,
+                           Item>)) {
+  CRUST_IMPL_USE_SELF(boxed::DynBox<Trait<iter::Iterator, Item>, A, words>);
+
+  Option<Item> next() { return self().methods().next(self().as_mut_ptr()); }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    return self().methods().size_hint(self().as_ptr());
+  }
+};
+} // namespace crust
+
+
+#endif // CRUST_BOXED_HPP
@@ -23,6 +23,40 @@ CRUST_TRAIT(Clone) {
   }
 };
 } // namespace clone
+
+namespace _impl_clone {
+/// `clone::Clone' types are cloned, anything else is copied.
+template <class T>
+T clone_of(const T &value, BoolVal<true>) {
+  return value.clone();
+}
+
+template <class T>
+T clone_of(const T &value, BoolVal<false>) {
+  return value;
+}
+
+template <class T>
+T clone_of(const T &value) {
+  return clone_of(value, BoolVal<Require<T, clone::Clone>::result>{});
+}
+
+template <class T>
+void clone_into(T &dst, const T &src, BoolVal<true>) {
+  dst.clone_from(src);
+}
+
+template <class T>
+void clone_into(T &dst, const T &src, BoolVal<false>) {
+  dst = src;
+}
+
+/// `clone_from' for `clone::Clone' types, assignment for anything else.
+template <class T>
+void clone_into(T &dst, const T &src) {
+  clone_into(dst, src, BoolVal<Require<T, clone::Clone>::result>{});
+}
+} // namespace _impl_clone
 } // namespace crust
 
 
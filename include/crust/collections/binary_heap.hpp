@@ -0,0 +1,258 @@
+#ifndef CRUST_COLLECTIONS_BINARY_HEAP_HPP
+#define CRUST_COLLECTIONS_BINARY_HEAP_HPP
+
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/option.hpp"
+#include "crust/slice.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+namespace crust {
+namespace collections {
+template <class T, usize D = 4, class A = alloc::Global>
+struct BinaryHeap;
+} // namespace collections
+
+namespace binary_heap {
+template <class T, usize D, class A>
+struct PeekMut;
+} // namespace binary_heap
+
+namespace collections {
+/// max-heap ordered by `operator_cmp', stored in a `Vec' on `A'. each node
+/// has `D' children in consecutive slots, so a sift-down step compares one
+/// group of siblings, and a wider heap is shallower. the default 4 halves
+/// the depth of a binary heap at the cost of 3 comparisons per level instead
+/// of 1.
+template <class T, usize D, class A>
+struct crust_ebco BinaryHeap :
+    Impl<
+        BinaryHeap<T, D, A>,
+        Trait<clone::Clone>,
+        Trait<iter::FromIterator, T>> {
+private:
+  crust_static_assert(D >= 2);
+
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  friend struct binary_heap::PeekMut<T, D, A>;
+
+  Vec<T, A> data;
+
+  explicit BinaryHeap(Vec<T, A> &&data) : data{move(data)} {}
+
+  static bool less(const T &a, const T &b) {
+    return operator_cmp(a, b) == cmp::make_less();
+  }
+
+  /// moves the element at `pos' up to its place, shifting parents down into
+  /// the hole instead of swapping.
+  void sift_up(usize pos) {
+    T *ptr = data.as_mut_ptr();
+    T elem{move(ptr[pos])};
+    while (pos > 0) {
+      usize parent = (pos - 1) / D;
+      if (!less(ptr[parent], elem)) {
+        break;
+      }
+      ptr[pos] = move(ptr[parent]);
+      pos = parent;
+    }
+    ptr[pos] = move(elem);
+  }
+
+  /// moves the element at `pos' down to its place within `[0, end)'.
+  void sift_down(usize pos, usize end) {
+    T *ptr = data.as_mut_ptr();
+    T elem{move(ptr[pos])};
+    while (true) {
+      usize first = D * pos + 1;
+      if (first >= end) {
+        break;
+      }
+      usize last = end - first < D ? end : first + D;
+      usize child = first;
+      for (usize i = first + 1; i < last; ++i) {
+        if (less(ptr[child], ptr[i])) {
+          child = i;
+        }
+      }
+      if (!less(elem, ptr[child])) {
+        break;
+      }
+      ptr[pos] = move(ptr[child]);
+      pos = child;
+    }
+    ptr[pos] = move(elem);
+  }
+
+  /// bottom-up heap construction, O(n).
+  void rebuild() {
+    usize len = data.len();
+    if (len < 2) {
+      return;
+    }
+    for (usize i = (len - 2) / D + 1; i != 0; --i) {
+      sift_down(i - 1, len);
+    }
+  }
+
+public:
+  BinaryHeap() = default;
+
+  explicit BinaryHeap(A alloc) : data{alloc} {}
+
+  static BinaryHeap with_capacity(usize cap, A alloc = A{}) {
+    return from_vec(Vec<T, A>::with_capacity(cap, alloc));
+  }
+
+  /// takes over the vector's buffer and heapifies it in place.
+  static BinaryHeap from_vec(Vec<T, A> vec) {
+    BinaryHeap ret{move(vec)};
+    ret.rebuild();
+    return ret;
+  }
+
+  BinaryHeap(BinaryHeap &&) noexcept = default;
+
+  BinaryHeap &operator=(BinaryHeap &&) noexcept = default;
+
+  usize len() const { return data.len(); }
+
+  bool is_empty() const { return data.is_empty(); }
+
+  usize capacity() const { return data.capacity(); }
+
+  void reserve(usize additional) { data.reserve(additional); }
+
+  void clear() { data.clear(); }
+
+  /// the greatest element.
+  Option<Ref<T>> peek() const { return data.first(); }
+
+  /// the greatest element for modification, it is sifted back into place
+  /// when the returned guard is dropped.
+  Option<binary_heap::PeekMut<T, D, A>> peek_mut() {
+    if (is_empty()) {
+      return None{};
+    }
+    return make_some(binary_heap::PeekMut<T, D, A>{*this});
+  }
+
+  void push(T value) {
+    data.push(move(value));
+    sift_up(data.len() - 1);
+  }
+
+  Option<T> pop() {
+    Option<T> last = data.pop();
+    if (last.is_none() || data.is_empty()) {
+      return last;
+    }
+    T &root = data.as_mut_ptr()[0];
+    T ret{move(root)};
+    root = move(last).unwrap();
+    sift_down(0, data.len());
+    return make_some(move(ret));
+  }
+
+  /// the elements in heap order.
+  Slice<const T> as_slice() const { return data.as_slice(); }
+
+  slice::Iter<T> iter() const { return data.iter(); }
+
+  Vec<T, A> into_vec() && { return move(data); }
+
+  /// ascending order, sorted in place by repeatedly moving the greatest
+  /// element behind the shrinking heap.
+  Vec<T, A> into_sorted_vec() && {
+    T *ptr = data.as_mut_ptr();
+    for (usize end = data.len(); end > 1; --end) {
+      T max{move(ptr[0])};
+      ptr[0] = move(ptr[end - 1]);
+      ptr[end - 1] = move(max);
+      sift_down(0, end - 1);
+    }
+    return move(data);
+  }
+};
+} // namespace collections
+
+namespace binary_heap {
+/// mutable access to the top of a `BinaryHeap', see `peek_mut'.
+template <class T, usize D, class A>
+struct PeekMut {
+private:
+  friend struct collections::BinaryHeap<T, D, A>;
+
+  collections::BinaryHeap<T, D, A> *heap;
+
+  explicit PeekMut(collections::BinaryHeap<T, D, A> &heap) : heap{&heap} {}
+
+public:
+  PeekMut(const PeekMut &) = delete;
+
+  PeekMut(PeekMut &&other) noexcept : heap{other.heap} {
+    other.heap = nullptr;
+  }
+
+  PeekMut &operator=(const PeekMut &) = delete;
+
+  PeekMut &operator=(PeekMut &&) = delete;
+
+  T &operator*() const { return heap->data.as_mut_ptr()[0]; }
+
+  T *operator->() const { return heap->data.as_mut_ptr(); }
+
+  /// removes the element instead of sifting it back.
+  T pop() && {
+    collections::BinaryHeap<T, D, A> *owner = heap;
+    heap = nullptr;
+    return owner->pop().unwrap();
+  }
+
+  ~PeekMut() {
+    if (heap != nullptr && heap->len() > 1) {
+      heap->sift_down(0, heap->len());
+    }
+  }
+};
+} // namespace binary_heap
+
+template <class T, usize D, class A>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(clone::Clone<collections::BinaryHeap<T, D, A>>)) {
+  CRUST_IMPL_USE_SELF(collections::BinaryHeap<T, D, A>);
+
+  Self clone() const {
+    Self ret{self().data.allocator()};
+    ret.data.reserve(self().len());
+    for (usize i = 0; i < self().len(); ++i) {
+      ret.data.push(_impl_clone::clone_of(self().data[i]));
+    }
+    return ret;
+  }
+
+  void clone_from(const Self &other) { self() = other.clone(); }
+};
+
+template <class T, usize D, class A>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::FromIterator<collections::BinaryHeap<T, D, A>, T>)) {
+  CRUST_IMPL_USE_SELF(collections::BinaryHeap<T, D, A>);
+
+  template <class I>
+  static Self from_iter(I &&iter) {
+    return Self::from_vec(move(iter).template collect<Vec<T, A>>());
+  }
+};
+} // namespace crust
+
+
+#endif // CRUST_COLLECTIONS_BINARY_HEAP_HPP
@@ -0,0 +1,152 @@
+#ifndef CRUST_COLLECTIONS_BIT_SET_HPP
+#define CRUST_COLLECTIONS_BIT_SET_HPP
+
+
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/collections/bit_vec.hpp"
+#include "crust/option.hpp"
+#include "crust/slice.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace collections {
+/// set of integers below `N', stored inline as `N' bits. the set operations
+/// run over whole words, see `BitVec'.
+template <usize N>
+struct crust_ebco BitSet :
+    Impl<
+        BitSet<N>,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>> {
+private:
+  crust_static_assert(N > 0);
+
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  static constexpr usize WORDS =
+      (N + _impl_bit::WORD_BITS - 1) / _impl_bit::WORD_BITS;
+
+  u64 words[WORDS];
+
+  static void check_index(usize index) {
+    if (index >= N) {
+      crust_panic("bit index out of boundary!");
+    }
+  }
+
+public:
+  constexpr BitSet() : words{} {}
+
+  static constexpr usize capacity() { return N; }
+
+  usize len() const { return _impl_bit::count_ones(words, WORDS); }
+
+  bool is_empty() const { return len() == 0; }
+
+  bool contains(usize index) const {
+    return index < N && ((words[index / 64] >> (index % 64)) & 1) != 0;
+  }
+
+  /// whether `index' was absent.
+  bool insert(usize index) {
+    check_index(index);
+    u64 bit = u64{1} << (index % 64);
+    u64 &word = words[index / 64];
+    bool ret = (word & bit) == 0;
+    word |= bit;
+    return ret;
+  }
+
+  /// whether `index' was present.
+  bool remove(usize index) {
+    if (index >= N) {
+      return false;
+    }
+    u64 bit = u64{1} << (index % 64);
+    u64 &word = words[index / 64];
+    bool ret = (word & bit) != 0;
+    word &= ~bit;
+    return ret;
+  }
+
+  void clear() {
+    for (usize i = 0; i < WORDS; ++i) {
+      words[i] = 0;
+    }
+  }
+
+  void union_with(const BitSet &other) {
+    _impl_bit::or_words(words, other.words, WORDS);
+  }
+
+  void intersect_with(const BitSet &other) {
+    _impl_bit::and_words(words, other.words, WORDS);
+  }
+
+  void difference_with(const BitSet &other) {
+    _impl_bit::andnot_words(words, other.words, WORDS);
+  }
+
+  void symmetric_difference_with(const BitSet &other) {
+    _impl_bit::xor_words(words, other.words, WORDS);
+  }
+
+  bool is_subset(const BitSet &other) const {
+    return _impl_bit::is_subset(words, other.words, WORDS);
+  }
+
+  bool is_superset(const BitSet &other) const { return other.is_subset(*this); }
+
+  bool is_disjoint(const BitSet &other) const {
+    return _impl_bit::is_disjoint(words, other.words, WORDS);
+  }
+
+  /// elements below `index', which may equal `N'.
+  usize rank(usize index) const {
+    if (index > N) {
+      crust_panic("bit index out of boundary!");
+    }
+    return _impl_bit::rank(words, index);
+  }
+
+  /// the `k'-th smallest element counting from 0.
+  Option<usize> select(usize k) const {
+    return _impl_bit::select(words, WORDS, k);
+  }
+
+  /// elements in ascending order.
+  bit_vec::IterOnes iter() const { return bit_vec::IterOnes{words, WORDS}; }
+
+  Slice<const u64> as_words() const {
+    return Slice<const u64>::from_raw_parts(words, WORDS);
+  }
+};
+} // namespace collections
+
+template <usize N>
+CRUST_IMPL_FOR(clone::Clone<collections::BitSet<N>>){};
+
+template <usize N>
+CRUST_IMPL_FOR(cmp::PartialEq<collections::BitSet<N>>) {
+  CRUST_IMPL_USE_SELF(collections::BitSet<N>);
+
+  bool eq(const Self &other) const {
+    for (usize i = 0; i < Self::WORDS; ++i) {
+      if (self().words[i] != other.words[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+template <usize N>
+CRUST_IMPL_FOR(cmp::Eq<collections::BitSet<N>>){};
+} // namespace crust
+
+
+#endif // CRUST_COLLECTIONS_BIT_SET_HPP
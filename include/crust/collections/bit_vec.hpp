@@ -0,0 +1,481 @@
+#ifndef CRUST_COLLECTIONS_BIT_VEC_HPP
+#define CRUST_COLLECTIONS_BIT_VEC_HPP
+
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/num/mod.hpp"
+#include "crust/option.hpp"
+#include "crust/slice.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+namespace crust {
+namespace _impl_bit {
+constexpr usize WORD_BITS = 64;
+
+crust_always_inline usize words_for(usize bits) {
+  return (bits + WORD_BITS - 1) / WORD_BITS;
+}
+
+/// bits below `bit' within its word.
+crust_always_inline u64 low_mask(usize bit) {
+  return (u64{1} << (bit % WORD_BITS)) - 1;
+}
+
+/// position of the `k'-th lowest set bit, `k' must be below the popcount.
+crust_always_inline u32 select_in_word(u64 word, u32 k) {
+#if defined(__BMI2__)
+  return num::trailing_zeros(_pdep_u64(u64{1} << k, word));
+#else
+  for (; k != 0; --k) {
+    word &= word - 1;
+  }
+  return num::trailing_zeros(word);
+#endif
+}
+
+// the word loops below are kept free of early exits and cross iteration
+// dependencies, so the compiler vectorizes them to the widest registers the
+// target has.
+inline void and_words(u64 *dst, const u64 *src, usize len) {
+  for (usize i = 0; i < len; ++i) {
+    dst[i] &= src[i];
+  }
+}
+
+inline void or_words(u64 *dst, const u64 *src, usize len) {
+  for (usize i = 0; i < len; ++i) {
+    dst[i] |= src[i];
+  }
+}
+
+inline void xor_words(u64 *dst, const u64 *src, usize len) {
+  for (usize i = 0; i < len; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+inline void andnot_words(u64 *dst, const u64 *src, usize len) {
+  for (usize i = 0; i < len; ++i) {
+    dst[i] &= ~src[i];
+  }
+}
+
+inline usize count_ones(const u64 *words, usize len) {
+  usize ret = 0;
+  for (usize i = 0; i < len; ++i) {
+    ret += num::count_ones(words[i]);
+  }
+  return ret;
+}
+
+/// whether no bit of `a' is missing from `b'.
+inline bool is_subset(const u64 *a, const u64 *b, usize len) {
+  u64 missing = 0;
+  for (usize i = 0; i < len; ++i) {
+    missing |= a[i] & ~b[i];
+  }
+  return missing == 0;
+}
+
+inline bool is_disjoint(const u64 *a, const u64 *b, usize len) {
+  u64 common = 0;
+  for (usize i = 0; i < len; ++i) {
+    common |= a[i] & b[i];
+  }
+  return common == 0;
+}
+
+/// set bits in `[0, bit)'.
+inline usize rank(const u64 *words, usize bit) {
+  usize word = bit / WORD_BITS;
+  usize ret = count_ones(words, word);
+  if (bit % WORD_BITS != 0) {
+    ret += num::count_ones(words[word] & low_mask(bit));
+  }
+  return ret;
+}
+
+/// position of the `k'-th set bit counting from 0.
+inline Option<usize> select(const u64 *words, usize len, usize k) {
+  for (usize i = 0; i < len; ++i) {
+    usize ones = num::count_ones(words[i]);
+    if (k < ones) {
+      return make_some(
+          i * WORD_BITS + select_in_word(words[i], static_cast<u32>(k)));
+    }
+    k -= ones;
+  }
+  return None{};
+}
+} // namespace _impl_bit
+
+namespace collections {
+struct BitVec;
+} // namespace collections
+
+namespace bit_vec {
+struct IterOnes;
+
+struct RankIndex;
+} // namespace bit_vec
+
+template <class S>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::Iterator<S, usize>), IsSame<S, bit_vec::IterOnes>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  /// one `tzcnt' and one `blsr' per set bit, zero words are skipped.
+  Option<usize> next() {
+    while (self().current == 0) {
+      if (++self().index >= self().len) {
+        self().index = self().len;
+        return None{};
+      }
+      self().current = self().words[self().index];
+    }
+    usize bit = num::trailing_zeros(self().current);
+    self().current &= self().current - 1;
+    return make_some(self().index * _impl_bit::WORD_BITS + bit);
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    usize remain = num::count_ones(self().current) +
+        (self().len - self().index) * _impl_bit::WORD_BITS;
+    return tuple(usize{0}, make_some(remain));
+  }
+};
+
+namespace bit_vec {
+/// indices of the set bits in ascending order.
+struct crust_ebco IterOnes : Impl<IterOnes, Trait<iter::Iterator, usize>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  const u64 *words;
+  usize len;
+  usize index;
+  u64 current;
+
+public:
+  IterOnes(const u64 *words, usize len) :
+      words{words}, len{len}, index{0}, current{len == 0 ? 0 : words[0]} {}
+};
+} // namespace bit_vec
+
+template <class S>
+CRUST_IMPL_FOR(clone::Clone<S>, IsSame<S, collections::BitVec>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  Self clone() const {
+    Self ret;
+    ret.words = self().words.clone();
+    ret.nbits = self().nbits;
+    return ret;
+  }
+
+  void clone_from(const Self &other) {
+    self().words.clone_from(other.words);
+    self().nbits = other.nbits;
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::PartialEq<S>, IsSame<S, collections::BitVec>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  bool eq(const Self &other) const {
+    return self().nbits == other.nbits && self().words == other.words;
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::Eq<S>, IsSame<S, collections::BitVec>){};
+
+template <class S>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::FromIterator<S, bool>),
+    IsSame<S, collections::BitVec>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  template <class I>
+  static Self from_iter(I &&iter) {
+    Self ret = Self::with_capacity(iter.size_hint().template get<0>());
+    while (true) {
+      auto x = iter.next();
+      if (x.is_none()) {
+        return ret;
+      }
+      ret.push(move(x).unwrap());
+    }
+  }
+};
+
+namespace collections {
+/// growable array of bits packed into 64 bit words. bits past `len()' in the
+/// last word are kept clear, so counting and comparing work on whole words.
+struct crust_ebco BitVec :
+    Impl<
+        BitVec,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<iter::FromIterator, bool>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  Vec<u64> words;
+  usize nbits;
+
+  void check_index(usize index) const {
+    if (index >= nbits) {
+      crust_panic("bit index out of boundary!");
+    }
+  }
+
+  void check_len(const BitVec &other) const {
+    if (nbits != other.nbits) {
+      crust_panic("bit vectors differ in length!");
+    }
+  }
+
+public:
+  BitVec() : nbits{0} {}
+
+  static BitVec with_capacity(usize bits) {
+    BitVec ret;
+    ret.words.reserve_exact(_impl_bit::words_for(bits));
+    return ret;
+  }
+
+  static BitVec from_elem(usize len, bool value) {
+    BitVec ret = with_capacity(len);
+    for (usize i = _impl_bit::words_for(len); i != 0; --i) {
+      ret.words.push(value ? ~u64{0} : 0);
+    }
+    ret.nbits = len;
+    ret.fill(value);
+    return ret;
+  }
+
+  BitVec(BitVec &&other) noexcept :
+      words{move(other.words)}, nbits{other.nbits} {
+    other.nbits = 0;
+  }
+
+  BitVec &operator=(BitVec &&other) noexcept {
+    if (this != &other) {
+      words = move(other.words);
+      nbits = other.nbits;
+      other.nbits = 0;
+    }
+
+    return *this;
+  }
+
+  usize len() const { return nbits; }
+
+  bool is_empty() const { return nbits == 0; }
+
+  Option<bool> get(usize index) const {
+    if (index >= nbits) {
+      return None{};
+    }
+    return make_some(((words[index / 64] >> (index % 64)) & 1) != 0);
+  }
+
+  void set(usize index, bool value) {
+    check_index(index);
+    u64 bit = u64{1} << (index % 64);
+    u64 &word = words[index / 64];
+    word = value ? word | bit : word & ~bit;
+  }
+
+  void push(bool value) {
+    if (nbits % 64 == 0) {
+      words.push(0);
+    }
+    ++nbits;
+    set(nbits - 1, value);
+  }
+
+  Option<bool> pop() {
+    if (nbits == 0) {
+      return None{};
+    }
+    bool value = get(nbits - 1).unwrap();
+    truncate(nbits - 1);
+    return make_some(value);
+  }
+
+  void truncate(usize len) {
+    if (len >= nbits) {
+      return;
+    }
+    words.truncate(_impl_bit::words_for(len));
+    nbits = len;
+    if (len % 64 != 0) {
+      words[words.len() - 1] &= _impl_bit::low_mask(len);
+    }
+  }
+
+  void clear() {
+    words.clear();
+    nbits = 0;
+  }
+
+  void fill(bool value) {
+    u64 *ptr = words.as_mut_ptr();
+    for (usize i = 0; i < words.len(); ++i) {
+      ptr[i] = value ? ~u64{0} : 0;
+    }
+    if (value && nbits % 64 != 0) {
+      ptr[words.len() - 1] = _impl_bit::low_mask(nbits);
+    }
+  }
+
+  usize count_ones() const {
+    return _impl_bit::count_ones(words.as_ptr(), words.len());
+  }
+
+  bool any() const { return count_ones() != 0; }
+
+  /// word-wise `or', both must have the same length.
+  void union_with(const BitVec &other) {
+    check_len(other);
+    _impl_bit::or_words(words.as_mut_ptr(), other.words.as_ptr(), words.len());
+  }
+
+  /// word-wise `and'.
+  void intersect_with(const BitVec &other) {
+    check_len(other);
+    _impl_bit::and_words(
+        words.as_mut_ptr(), other.words.as_ptr(), words.len());
+  }
+
+  /// word-wise `and not'.
+  void difference_with(const BitVec &other) {
+    check_len(other);
+    _impl_bit::andnot_words(
+        words.as_mut_ptr(), other.words.as_ptr(), words.len());
+  }
+
+  /// word-wise `xor'.
+  void symmetric_difference_with(const BitVec &other) {
+    check_len(other);
+    _impl_bit::xor_words(
+        words.as_mut_ptr(), other.words.as_ptr(), words.len());
+  }
+
+  /// set bits before `index', which may equal `len()'. a linear scan, see
+  /// `rank_index' for repeated queries.
+  usize rank(usize index) const {
+    if (index > nbits) {
+      crust_panic("bit index out of boundary!");
+    }
+    return _impl_bit::rank(words.as_ptr(), index);
+  }
+
+  /// position of the `k'-th set bit counting from 0.
+  Option<usize> select(usize k) const {
+    return _impl_bit::select(words.as_ptr(), words.len(), k);
+  }
+
+  bit_vec::IterOnes iter_ones() const {
+    return bit_vec::IterOnes{words.as_ptr(), words.len()};
+  }
+
+  bit_vec::RankIndex rank_index() const;
+
+  Slice<const u64> as_words() const { return words.as_slice(); }
+};
+} // namespace collections
+
+namespace bit_vec {
+/// set bits before every 512 bit block, one cache line of words, for
+/// constant time `rank' and logarithmic `select'. it borrows the `BitVec',
+/// which must outlive the index and stay unmodified.
+struct RankIndex {
+private:
+  friend struct collections::BitVec;
+
+  static constexpr usize BLOCK_WORDS = 8;
+
+  const u64 *words;
+  usize len;
+  /// `blocks[b]' counts the set bits before block `b', the last entry is
+  /// the total.
+  Vec<usize> blocks;
+
+  RankIndex(const u64 *words, usize len) : words{words}, len{len} {
+    usize word_len = _impl_bit::words_for(len);
+    usize total = 0;
+    blocks.reserve_exact(word_len / BLOCK_WORDS + 2);
+    for (usize i = 0; i < word_len; i += BLOCK_WORDS) {
+      blocks.push(total);
+      usize end = word_len - i < BLOCK_WORDS ? word_len : i + BLOCK_WORDS;
+      total += _impl_bit::count_ones(words + i, end - i);
+    }
+    blocks.push(total);
+  }
+
+public:
+  usize count_ones() const { return blocks[blocks.len() - 1]; }
+
+  /// set bits before `index', which may equal the length.
+  usize rank(usize index) const {
+    if (index > len) {
+      crust_panic("bit index out of boundary!");
+    }
+    usize word = index / 64;
+    usize block_start = word / BLOCK_WORDS * BLOCK_WORDS;
+    usize ret = blocks[word / BLOCK_WORDS] +
+        _impl_bit::count_ones(words + block_start, word - block_start);
+    if (index % 64 != 0) {
+      ret += num::count_ones(words[word] & _impl_bit::low_mask(index));
+    }
+    return ret;
+  }
+
+  /// position of the `k'-th set bit counting from 0, found by binary search
+  /// over the blocks and a scan of at most one block.
+  Option<usize> select(usize k) const {
+    if (k >= count_ones()) {
+      return None{};
+    }
+    usize low = 0;
+    usize high = blocks.len() - 1;
+    while (high - low > 1) {
+      usize mid = low + (high - low) / 2;
+      if (blocks[mid] <= k) {
+        low = mid;
+      } else {
+        high = mid;
+      }
+    }
+    usize start = low * BLOCK_WORDS;
+    usize word_len = _impl_bit::words_for(len);
+    usize end = word_len - start < BLOCK_WORDS ? word_len : start + BLOCK_WORDS;
+    usize bit = _impl_bit::select(words + start, end - start, k - blocks[low])
+                    .unwrap();
+    return make_some(start * 64 + bit);
+  }
+};
+} // namespace bit_vec
+
+inline bit_vec::RankIndex collections::BitVec::rank_index() const {
+  return bit_vec::RankIndex{words.as_ptr(), nbits};
+}
+} // namespace crust
+
+
+#endif // CRUST_COLLECTIONS_BIT_VEC_HPP
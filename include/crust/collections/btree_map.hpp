@@ -0,0 +1,1113 @@
+#ifndef CRUST_COLLECTIONS_BTREE_MAP_HPP
+#define CRUST_COLLECTIONS_BTREE_MAP_HPP
+
+
+#include <new>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/ops/range.hpp"
+#include "crust/option.hpp"
+#include "crust/tuple.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+namespace crust {
+namespace _impl_btree {
+/// at least 11 keys per node, rounded up so the key array fills whole cache
+/// lines.
+template <class K>
+constexpr usize node_capacity() {
+  return (sizeof(K) * 11 + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE /
+      sizeof(K);
+}
+
+/// value type of a `BTreeSet'.
+struct SetValue {};
+
+template <class K, class V>
+struct InternalNode;
+
+/// keys and values live in separate arrays, the keys starting on a cache line,
+/// so a search within a node reads only the keys it compares against.
+template <class K, class V>
+struct LeafNode {
+  static constexpr usize CAPACITY = node_capacity<K>();
+  /// every node but the root holds at least this many keys.
+  static constexpr usize MIN_LEN = (CAPACITY - 1) / 2;
+  static constexpr usize KEY_ALIGN =
+      alignof(K) > CACHE_LINE ? alignof(K) : CACHE_LINE;
+
+  crust_static_assert(CAPACITY <= 0xFFFF);
+
+  alignas(KEY_ALIGN) u8 key_buffer[CAPACITY * sizeof(K)];
+  alignas(V) u8 val_buffer[CAPACITY * sizeof(V)];
+  InternalNode<K, V> *parent;
+  /// index of the edge pointing to this node in `parent'.
+  u16 parent_idx;
+  u16 len;
+
+  K *keys() { return reinterpret_cast<K *>(key_buffer); }
+
+  const K *keys() const { return reinterpret_cast<const K *>(key_buffer); }
+
+  V *vals() { return reinterpret_cast<V *>(val_buffer); }
+
+  const V *vals() const { return reinterpret_cast<const V *>(val_buffer); }
+};
+
+/// `edges[i]' holds the keys between `keys()[i - 1]' and `keys()[i]'.
+template <class K, class V>
+struct InternalNode {
+  LeafNode<K, V> data;
+  LeafNode<K, V> *edges[LeafNode<K, V>::CAPACITY + 1];
+};
+
+template <class K, class V>
+crust_always_inline InternalNode<K, V> *as_internal(LeafNode<K, V> *node) {
+  return reinterpret_cast<InternalNode<K, V> *>(node);
+}
+
+template <class K, class V>
+crust_always_inline const InternalNode<K, V> *
+as_internal(const LeafNode<K, V> *node) {
+  return reinterpret_cast<const InternalNode<K, V> *>(node);
+}
+
+/// points `edges[idx]' of `node' back at its slot.
+template <class K, class V>
+crust_always_inline void set_parent(InternalNode<K, V> *node, usize idx) {
+  node->edges[idx]->parent = node;
+  node->edges[idx]->parent_idx = static_cast<u16>(idx);
+}
+
+template <class T>
+crust_always_inline void relocate(T *dst, T *src) {
+  _impl_vec::RawMemory<T>::move_forward(dst, src, 1);
+}
+
+/// blocks of one size, carved out of chunks which double up to `MAX_CHUNK'
+/// blocks. freed blocks go to a free list, the chunks themselves are only
+/// given back by `release'.
+struct BlockPool {
+  static constexpr usize MAX_CHUNK = 64;
+
+  struct Free {
+    Free *next;
+  };
+
+  struct Chunk {
+    Chunk *next;
+    usize blocks;
+  };
+
+  Free *free;
+  Chunk *chunks;
+  /// blocks handed out from the newest chunk.
+  usize used;
+  usize size;
+  usize align;
+
+  BlockPool(usize size, usize align) :
+      free{nullptr}, chunks{nullptr}, used{0}, size{size}, align{align} {}
+
+  usize header() const { return _impl_alloc::align_up(sizeof(Chunk), align); }
+
+  template <class A>
+  void *allocate(A &alloc) {
+    if (free != nullptr) {
+      Free *block = free;
+      free = block->next;
+      return block;
+    }
+    if (chunks == nullptr || used == chunks->blocks) {
+      usize blocks = chunks == nullptr ? 1 : chunks->blocks * 2;
+      blocks = blocks < MAX_CHUNK ? blocks : MAX_CHUNK;
+      Chunk *chunk = static_cast<Chunk *>(
+          alloc.allocate(header() + blocks * size, align));
+      chunk->next = chunks;
+      chunk->blocks = blocks;
+      chunks = chunk;
+      used = 0;
+    }
+    return reinterpret_cast<u8 *>(chunks) + header() + size * used++;
+  }
+
+  void deallocate(void *block) {
+    Free *node = static_cast<Free *>(block);
+    node->next = free;
+    free = node;
+  }
+
+  template <class A>
+  void release(A &alloc) {
+    while (chunks != nullptr) {
+      Chunk *chunk = chunks;
+      chunks = chunk->next;
+      alloc.deallocate(chunk, header() + chunk->blocks * size, align);
+    }
+    forget();
+  }
+
+  void forget() {
+    free = nullptr;
+    chunks = nullptr;
+    used = 0;
+  }
+};
+
+/// a pair in a node of the given height.
+template <class K, class V>
+struct Handle {
+  LeafNode<K, V> *node;
+  usize height;
+  usize idx;
+};
+
+/// position between two adjacent pairs. every position is given by exactly
+/// one leaf edge, so two cursors are equal iff they are at the same position.
+template <class K, class V>
+struct Cursor {
+  LeafNode<K, V> *node;
+  usize idx;
+
+  bool operator==(const Cursor &other) const {
+    return node == other.node && idx == other.idx;
+  }
+};
+
+/// the pair after `edge', which is moved past it. there must be one.
+template <class K, class V>
+Handle<K, V> next_kv(Cursor<K, V> &edge) {
+  LeafNode<K, V> *node = edge.node;
+  usize idx = edge.idx;
+  usize height = 0;
+  while (idx == node->len) {
+    idx = node->parent_idx;
+    node = &node->parent->data;
+    ++height;
+  }
+  if (height == 0) {
+    edge = Cursor<K, V>{node, idx + 1};
+  } else {
+    LeafNode<K, V> *next = as_internal(node)->edges[idx + 1];
+    for (usize i = 1; i < height; ++i) {
+      next = as_internal(next)->edges[0];
+    }
+    edge = Cursor<K, V>{next, 0};
+  }
+  return Handle<K, V>{node, height, idx};
+}
+
+/// the pair before `edge', which is moved past it. there must be one.
+template <class K, class V>
+Handle<K, V> next_back_kv(Cursor<K, V> &edge) {
+  LeafNode<K, V> *node = edge.node;
+  usize idx = edge.idx;
+  usize height = 0;
+  while (idx == 0) {
+    idx = node->parent_idx;
+    node = &node->parent->data;
+    ++height;
+  }
+  --idx;
+  if (height == 0) {
+    edge = Cursor<K, V>{node, idx};
+  } else {
+    LeafNode<K, V> *next = as_internal(node)->edges[idx];
+    for (usize i = 1; i < height; ++i) {
+      next = as_internal(next)->edges[next->len];
+    }
+    edge = Cursor<K, V>{next, next->len};
+  }
+  return Handle<K, V>{node, height, idx};
+}
+
+/// pairs between two cursors.
+template <class K, class V>
+struct RawRange {
+  Cursor<K, V> front;
+  Cursor<K, V> back;
+
+  Handle<K, V> *next(Handle<K, V> &out) {
+    if (front == back) {
+      return nullptr;
+    }
+    out = next_kv(front);
+    return &out;
+  }
+
+  Handle<K, V> *next_back(Handle<K, V> &out) {
+    if (front == back) {
+      return nullptr;
+    }
+    out = next_back_kv(back);
+    return &out;
+  }
+};
+
+template <class K, class V>
+Option<Tuple<Ref<K>, Ref<V>>> pair_ref(Handle<K, V> *handle) {
+  if (handle == nullptr) {
+    return None{};
+  }
+  return make_some(tuple(
+      ref(handle->node->keys()[handle->idx]),
+      ref(handle->node->vals()[handle->idx])));
+}
+
+template <class K, class V>
+Option<Tuple<Ref<K>, RefMut<V>>> pair_mut(Handle<K, V> *handle) {
+  if (handle == nullptr) {
+    return None{};
+  }
+  return make_some(tuple(
+      ref(handle->node->keys()[handle->idx]),
+      ref_mut(handle->node->vals()[handle->idx])));
+}
+/// the B-tree shared by `BTreeMap' and `BTreeSet'. nodes come from two
+/// per-tree pools, one per node kind, so the nodes of a tree stay close in
+/// memory and a removal followed by an insertion does not hit the allocator.
+template <class K, class V, class A>
+struct crust_ebco Tree : private A {
+  using Leaf = LeafNode<K, V>;
+  using Internal = InternalNode<K, V>;
+  using Memory = _impl_vec::RawMemory<K>;
+  using ValMemory = _impl_vec::RawMemory<V>;
+
+  static constexpr usize CAPACITY = Leaf::CAPACITY;
+  static constexpr usize MIN_LEN = Leaf::MIN_LEN;
+
+  Leaf *root;
+  usize height;
+  usize length;
+  BlockPool leaves;
+  BlockPool internals;
+
+  explicit Tree(A alloc = A{}) :
+      A{alloc}, root{nullptr}, height{0}, length{0},
+      leaves{sizeof(Leaf), alignof(Leaf)},
+      internals{sizeof(Internal), alignof(Internal)} {}
+
+  Tree(const Tree &) = delete;
+
+  Tree(Tree &&other) noexcept :
+      A{other.allocator()}, root{other.root}, height{other.height},
+      length{other.length}, leaves{other.leaves},
+      internals{other.internals} {
+    other.forget();
+  }
+
+  Tree &operator=(const Tree &) = delete;
+
+  Tree &operator=(Tree &&other) noexcept {
+    if (this != &other) {
+      drop();
+      allocator() = other.allocator();
+      root = other.root;
+      height = other.height;
+      length = other.length;
+      leaves = other.leaves;
+      internals = other.internals;
+      other.forget();
+    }
+    return *this;
+  }
+
+  A &allocator() { return *this; }
+
+  const A &allocator() const { return *this; }
+
+  void forget() {
+    root = nullptr;
+    height = 0;
+    length = 0;
+    leaves.forget();
+    internals.forget();
+  }
+
+  Leaf *new_node(usize height) {
+    Leaf *node = static_cast<Leaf *>(
+        height == 0 ? leaves.allocate(allocator()) :
+                      internals.allocate(allocator()));
+    node->parent = nullptr;
+    node->parent_idx = 0;
+    node->len = 0;
+    return node;
+  }
+
+  void free_node(Leaf *node, usize height) {
+    if (height == 0) {
+      leaves.deallocate(node);
+    } else {
+      internals.deallocate(node);
+    }
+  }
+
+  /// first index whose key is not less than `key'.
+  static usize search_node(const Leaf *node, const K &key, bool &found) {
+    const K *keys = node->keys();
+    for (usize i = 0; i < node->len; ++i) {
+      cmp::Ordering ord = operator_cmp(key, keys[i]);
+      if (ord != cmp::make_greater()) {
+        found = ord == cmp::make_equal();
+        return i;
+      }
+    }
+    found = false;
+    return node->len;
+  }
+
+  /// the pair with `key' if `found', otherwise the leaf edge it belongs in.
+  /// `node' is null for an empty tree.
+  Handle<K, V> search(const K &key, bool &found) const {
+    found = false;
+    Leaf *node = root;
+    usize h = height;
+    while (node != nullptr) {
+      usize idx = search_node(node, key, found);
+      if (found || h == 0) {
+        return Handle<K, V>{node, h, idx};
+      }
+      node = as_internal(node)->edges[idx];
+      --h;
+    }
+    return Handle<K, V>{nullptr, 0, 0};
+  }
+
+  /// leaf edge before the first key not less than `key'.
+  Cursor<K, V> lower_bound(const K &key) const {
+    Leaf *node = root;
+    if (node == nullptr) {
+      return Cursor<K, V>{nullptr, 0};
+    }
+    for (usize h = height;; --h) {
+      bool found;
+      usize idx = search_node(node, key, found);
+      if (h == 0) {
+        return Cursor<K, V>{node, idx};
+      }
+      node = as_internal(node)->edges[idx];
+    }
+  }
+
+  Cursor<K, V> first_edge() const {
+    Leaf *node = root;
+    if (node == nullptr) {
+      return Cursor<K, V>{nullptr, 0};
+    }
+    for (usize h = height; h != 0; --h) {
+      node = as_internal(node)->edges[0];
+    }
+    return Cursor<K, V>{node, 0};
+  }
+
+  Cursor<K, V> last_edge() const {
+    Leaf *node = root;
+    if (node == nullptr) {
+      return Cursor<K, V>{nullptr, 0};
+    }
+    for (usize h = height; h != 0; --h) {
+      node = as_internal(node)->edges[node->len];
+    }
+    return Cursor<K, V>{node, node->len};
+  }
+
+  RawRange<K, V> full_range() const {
+    return RawRange<K, V>{first_edge(), last_edge()};
+  }
+
+  /// pairs with keys in `[start, end)', empty if `start' is past `end'.
+  RawRange<K, V> range(const K *start, const K *end) const {
+    Cursor<K, V> front = start == nullptr ? first_edge() : lower_bound(*start);
+    if (start != nullptr && end != nullptr &&
+        operator_cmp(*start, *end) == cmp::make_greater()) {
+      return RawRange<K, V>{front, front};
+    }
+    Cursor<K, V> back = end == nullptr ? last_edge() : lower_bound(*end);
+    return RawRange<K, V>{front, back};
+  }
+
+  /// puts the pair at `idx' of a non-full node, with `edge' right of it in
+  /// internal nodes.
+  void insert_fit(Leaf *node, usize idx, K &&key, V &&value, Leaf *edge) {
+    usize len = node->len;
+    Memory::move_backward(
+        node->keys() + idx + 1, node->keys() + idx, len - idx);
+    ValMemory::move_backward(
+        node->vals() + idx + 1, node->vals() + idx, len - idx);
+    ::new (node->keys() + idx) K{move(key)};
+    ::new (node->vals() + idx) V{move(value)};
+    if (edge != nullptr) {
+      Internal *internal = as_internal(node);
+      for (usize i = len + 1; i > idx + 1; --i) {
+        internal->edges[i] = internal->edges[i - 1];
+        set_parent(internal, i);
+      }
+      internal->edges[idx + 1] = edge;
+      set_parent(internal, idx + 1);
+    }
+    node->len = static_cast<u16>(len + 1);
+  }
+
+  /// splits a full node around its middle pair, which is moved out through
+  /// the arguments. the upper half goes to the returned sibling.
+  Leaf *split(Leaf *node, usize h, usize mid, K *key, V *value) {
+    Leaf *right = new_node(h);
+    usize moved = CAPACITY - mid - 1;
+    Memory::move_forward(right->keys(), node->keys() + mid + 1, moved);
+    ValMemory::move_forward(right->vals(), node->vals() + mid + 1, moved);
+    relocate(key, node->keys() + mid);
+    relocate(value, node->vals() + mid);
+    if (h != 0) {
+      for (usize i = 0; i <= moved; ++i) {
+        as_internal(right)->edges[i] = as_internal(node)->edges[mid + 1 + i];
+        set_parent(as_internal(right), i);
+      }
+    }
+    right->len = static_cast<u16>(moved);
+    node->len = static_cast<u16>(mid);
+    return right;
+  }
+
+  /// inserts into `node', splitting it and its ancestors as needed. returns
+  /// where the value ended up.
+  V *insert_recursing(
+      Leaf *node, usize h, usize idx, K &&key, V &&value, Leaf *edge) {
+    if (node->len < CAPACITY) {
+      insert_fit(node, idx, move(key), move(value), edge);
+      return node->vals() + idx;
+    }
+
+    usize mid = CAPACITY / 2;
+    Uninit<K> median_key;
+    Uninit<V> median_value;
+    Leaf *right = split(node, h, mid, &median_key.value, &median_value.value);
+
+    Leaf *target = idx <= mid ? node : right;
+    usize target_idx = idx <= mid ? idx : idx - mid - 1;
+    insert_fit(target, target_idx, move(key), move(value), edge);
+
+    Internal *parent = node->parent;
+    if (parent == nullptr) {
+      parent = as_internal(new_node(h + 1));
+      parent->edges[0] = node;
+      set_parent(parent, 0);
+      root = &parent->data;
+      ++height;
+    }
+    insert_recursing(
+        &parent->data,
+        h + 1,
+        node->parent_idx,
+        move(median_key.value),
+        move(median_value.value),
+        right);
+    median_key.value.~K();
+    median_value.value.~V();
+    return target->vals() + target_idx;
+  }
+
+  /// `edge' comes from a failed `search'.
+  V *insert(Handle<K, V> edge, K &&key, V &&value) {
+    ++length;
+    if (edge.node == nullptr) {
+      root = new_node(0);
+      height = 0;
+      edge = Handle<K, V>{root, 0, 0};
+    }
+    return insert_recursing(
+        edge.node, 0, edge.idx, move(key), move(value), nullptr);
+  }
+
+  /// moves the last key of the left sibling through the parent into
+  /// `edges[idx]'.
+  void steal_left(Internal *parent, usize idx, usize h) {
+    Leaf *node = parent->edges[idx];
+    Leaf *left = parent->edges[idx - 1];
+    usize len = node->len;
+    usize last = left->len - 1u;
+
+    Memory::move_backward(node->keys() + 1, node->keys(), len);
+    ValMemory::move_backward(node->vals() + 1, node->vals(), len);
+    relocate(node->keys(), parent->data.keys() + idx - 1);
+    relocate(node->vals(), parent->data.vals() + idx - 1);
+    relocate(parent->data.keys() + idx - 1, left->keys() + last);
+    relocate(parent->data.vals() + idx - 1, left->vals() + last);
+    if (h != 0) {
+      Internal *internal = as_internal(node);
+      for (usize i = len + 1; i > 0; --i) {
+        internal->edges[i] = internal->edges[i - 1];
+        set_parent(internal, i);
+      }
+      internal->edges[0] = as_internal(left)->edges[last + 1];
+      set_parent(internal, 0);
+    }
+    left->len = static_cast<u16>(last);
+    node->len = static_cast<u16>(len + 1);
+  }
+
+  /// moves the first key of the right sibling through the parent into
+  /// `edges[idx]'.
+  void steal_right(Internal *parent, usize idx, usize h) {
+    Leaf *node = parent->edges[idx];
+    Leaf *right = parent->edges[idx + 1];
+    usize len = node->len;
+    usize right_len = right->len;
+
+    relocate(node->keys() + len, parent->data.keys() + idx);
+    relocate(node->vals() + len, parent->data.vals() + idx);
+    relocate(parent->data.keys() + idx, right->keys());
+    relocate(parent->data.vals() + idx, right->vals());
+    Memory::move_forward(right->keys(), right->keys() + 1, right_len - 1);
+    ValMemory::move_forward(right->vals(), right->vals() + 1, right_len - 1);
+    if (h != 0) {
+      Internal *internal = as_internal(node);
+      Internal *sibling = as_internal(right);
+      internal->edges[len + 1] = sibling->edges[0];
+      set_parent(internal, len + 1);
+      for (usize i = 0; i < right_len; ++i) {
+        sibling->edges[i] = sibling->edges[i + 1];
+        set_parent(sibling, i);
+      }
+    }
+    node->len = static_cast<u16>(len + 1);
+    right->len = static_cast<u16>(right_len - 1);
+  }
+
+  /// merges `edges[idx + 1]' and the key between into `edges[idx]'.
+  void merge(Internal *parent, usize idx, usize h) {
+    Leaf *left = parent->edges[idx];
+    Leaf *right = parent->edges[idx + 1];
+    usize left_len = left->len;
+    usize right_len = right->len;
+    usize parent_len = parent->data.len;
+
+    relocate(left->keys() + left_len, parent->data.keys() + idx);
+    relocate(left->vals() + left_len, parent->data.vals() + idx);
+    Memory::move_forward(
+        left->keys() + left_len + 1, right->keys(), right_len);
+    ValMemory::move_forward(
+        left->vals() + left_len + 1, right->vals(), right_len);
+    if (h != 0) {
+      for (usize i = 0; i <= right_len; ++i) {
+        as_internal(left)->edges[left_len + 1 + i] =
+            as_internal(right)->edges[i];
+        set_parent(as_internal(left), left_len + 1 + i);
+      }
+    }
+    left->len = static_cast<u16>(left_len + 1 + right_len);
+
+    Memory::move_forward(
+        parent->data.keys() + idx,
+        parent->data.keys() + idx + 1,
+        parent_len - idx - 1);
+    ValMemory::move_forward(
+        parent->data.vals() + idx,
+        parent->data.vals() + idx + 1,
+        parent_len - idx - 1);
+    for (usize i = idx + 1; i < parent_len; ++i) {
+      parent->edges[i] = parent->edges[i + 1];
+      set_parent(parent, i);
+    }
+    parent->data.len = static_cast<u16>(parent_len - 1);
+    free_node(right, h);
+  }
+
+  /// restores the minimum length from a leaf up, then drops an empty root.
+  void rebalance(Leaf *node) {
+    usize h = 0;
+    while (node->len < MIN_LEN && node->parent != nullptr) {
+      Internal *parent = node->parent;
+      usize idx = node->parent_idx;
+      if (idx > 0 && parent->edges[idx - 1]->len > MIN_LEN) {
+        steal_left(parent, idx, h);
+        return;
+      }
+      if (idx < parent->data.len && parent->edges[idx + 1]->len > MIN_LEN) {
+        steal_right(parent, idx, h);
+        return;
+      }
+      merge(parent, idx > 0 ? idx - 1 : idx, h);
+      node = &parent->data;
+      ++h;
+    }
+    if (height != 0 && root->len == 0) {
+      Leaf *old = root;
+      root = as_internal(old)->edges[0];
+      root->parent = nullptr;
+      free_node(old, height--);
+    }
+  }
+
+  /// removes a pair found by `search'. pairs in internal nodes are swapped
+  /// with their predecessor, so removal always starts in a leaf.
+  Tuple<K, V> remove(Handle<K, V> handle) {
+    --length;
+    Leaf *leaf = handle.node;
+    usize idx = handle.idx;
+    if (handle.height != 0) {
+      leaf = as_internal(leaf)->edges[idx];
+      for (usize h = handle.height - 1; h != 0; --h) {
+        leaf = as_internal(leaf)->edges[leaf->len];
+      }
+      idx = leaf->len - 1u;
+    }
+
+    Tuple<K, V> ret{move(leaf->keys()[idx]), move(leaf->vals()[idx])};
+    leaf->keys()[idx].~K();
+    leaf->vals()[idx].~V();
+    usize len = leaf->len;
+    Memory::move_forward(
+        leaf->keys() + idx, leaf->keys() + idx + 1, len - idx - 1);
+    ValMemory::move_forward(
+        leaf->vals() + idx, leaf->vals() + idx + 1, len - idx - 1);
+    leaf->len = static_cast<u16>(len - 1);
+
+    if (handle.height != 0) {
+      K &key = handle.node->keys()[handle.idx];
+      V &value = handle.node->vals()[handle.idx];
+      K old_key{move(key)};
+      V old_value{move(value)};
+      key = move(ret.template get<0>());
+      value = move(ret.template get<1>());
+      ret.template get<0>() = move(old_key);
+      ret.template get<1>() = move(old_value);
+    }
+    rebalance(leaf);
+    return ret;
+  }
+
+  static void drop_node(Leaf *node, usize h) {
+    _impl_vec::drop_in_place(node->keys(), node->len);
+    _impl_vec::drop_in_place(node->vals(), node->len);
+    if (h != 0) {
+      for (usize i = 0; i <= node->len; ++i) {
+        drop_node(as_internal(node)->edges[i], h - 1);
+      }
+    }
+  }
+
+  Leaf *clone_node(const Leaf *src, usize h) {
+    Leaf *node = new_node(h);
+    for (usize i = 0; i < src->len; ++i) {
+      ::new (node->keys() + i) K{_impl_clone::clone_of(src->keys()[i])};
+      ::new (node->vals() + i) V{_impl_clone::clone_of(src->vals()[i])};
+    }
+    node->len = src->len;
+    if (h != 0) {
+      for (usize i = 0; i <= src->len; ++i) {
+        as_internal(node)->edges[i] =
+            clone_node(as_internal(src)->edges[i], h - 1);
+        set_parent(as_internal(node), i);
+      }
+    }
+    return node;
+  }
+
+  Tree clone() const {
+    Tree ret{allocator()};
+    if (root != nullptr) {
+      ret.root = ret.clone_node(root, height);
+      ret.height = height;
+      ret.length = length;
+    }
+    return ret;
+  }
+
+  /// elements are dropped by walking the tree, nodes all at once with the
+  /// pools.
+  void clear() {
+    if (root != nullptr && !(std::is_trivially_destructible<K>::value &&
+                             std::is_trivially_destructible<V>::value)) {
+      drop_node(root, height);
+    }
+    leaves.release(allocator());
+    internals.release(allocator());
+    root = nullptr;
+    height = 0;
+    length = 0;
+  }
+
+  void drop() { clear(); }
+
+  ~Tree() { drop(); }
+};
+} // namespace _impl_btree
+
+namespace collections {
+template <class K, class V, class A = alloc::Global>
+struct BTreeMap;
+} // namespace collections
+
+namespace btree_map {
+template <class K, class V>
+struct Iter;
+
+template <class K, class V>
+struct IterMut;
+
+template <class K, class V>
+struct Range;
+} // namespace btree_map
+
+namespace collections {
+/// ordered map on a B-tree, keys are compared with `operator_cmp'. a node
+/// holds many keys in a row, see `_impl_btree::LeafNode', which makes
+/// lookups and especially range scans far more cache friendly than a tree
+/// with a node per element.
+template <class K, class V, class A>
+struct crust_ebco BTreeMap :
+    Impl<
+        BTreeMap<K, V, A>,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<iter::FromIterator, Tuple<K, V>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  using Handle = _impl_btree::Handle<K, V>;
+
+  _impl_btree::Tree<K, V, A> tree;
+
+  V *find(const K &key) const {
+    bool found;
+    Handle handle = tree.search(key, found);
+    return found ? handle.node->vals() + handle.idx : nullptr;
+  }
+
+public:
+  explicit BTreeMap(A alloc = A{}) : tree{alloc} {}
+
+  BTreeMap(BTreeMap &&) noexcept = default;
+
+  BTreeMap &operator=(BTreeMap &&) noexcept = default;
+
+  usize len() const { return tree.length; }
+
+  bool is_empty() const { return len() == 0; }
+
+  void clear() { tree.clear(); }
+
+  Option<Ref<V>> get(const K &key) const {
+    V *value = find(key);
+    if (value == nullptr) {
+      return None{};
+    }
+    return make_some(ref(*value));
+  }
+
+  Option<RefMut<V>> get_mut(const K &key) {
+    V *value = find(key);
+    if (value == nullptr) {
+      return None{};
+    }
+    return make_some(ref_mut(*value));
+  }
+
+  bool contains_key(const K &key) const { return find(key) != nullptr; }
+
+  Option<Tuple<Ref<K>, Ref<V>>> first_key_value() const {
+    Handle handle;
+    _impl_btree::RawRange<K, V> range = tree.full_range();
+    return _impl_btree::pair_ref(range.next(handle));
+  }
+
+  Option<Tuple<Ref<K>, Ref<V>>> last_key_value() const {
+    Handle handle;
+    _impl_btree::RawRange<K, V> range = tree.full_range();
+    return _impl_btree::pair_ref(range.next_back(handle));
+  }
+
+  /// returns the previous value, the key is kept in that case.
+  Option<V> insert(K key, V value) {
+    bool found;
+    Handle handle = tree.search(key, found);
+    if (found) {
+      V &slot = handle.node->vals()[handle.idx];
+      V old{move(slot)};
+      slot = move(value);
+      return make_some(move(old));
+    }
+    tree.insert(handle, move(key), move(value));
+    return None{};
+  }
+
+  Option<V> remove(const K &key) {
+    bool found;
+    Handle handle = tree.search(key, found);
+    if (!found) {
+      return None{};
+    }
+    return make_some(move(tree.remove(handle).template get<1>()));
+  }
+
+  Option<Tuple<K, V>> pop_first() {
+    Handle handle;
+    _impl_btree::RawRange<K, V> range = tree.full_range();
+    if (range.next(handle) == nullptr) {
+      return None{};
+    }
+    return make_some(tree.remove(handle));
+  }
+
+  Option<Tuple<K, V>> pop_last() {
+    Handle handle;
+    _impl_btree::RawRange<K, V> range = tree.full_range();
+    if (range.next_back(handle) == nullptr) {
+      return None{};
+    }
+    return make_some(tree.remove(handle));
+  }
+
+  btree_map::Iter<K, V> iter() const {
+    return btree_map::Iter<K, V>{tree.full_range(), len()};
+  }
+
+  btree_map::IterMut<K, V> iter_mut() {
+    return btree_map::IterMut<K, V>{tree.full_range(), len()};
+  }
+
+  /// pairs with keys in `[bounds.start, bounds.end)', in order.
+  btree_map::Range<K, V> range(const range::Range<K> &bounds) const {
+    return btree_map::Range<K, V>{tree.range(&bounds.start, &bounds.end)};
+  }
+
+  btree_map::Range<K, V> range(const range::RangeFrom<K> &bounds) const {
+    return btree_map::Range<K, V>{tree.range(&bounds.start, nullptr)};
+  }
+
+  btree_map::Range<K, V> range(const range::RangeTo<K> &bounds) const {
+    return btree_map::Range<K, V>{tree.range(nullptr, &bounds.end)};
+  }
+
+  btree_map::Range<K, V> range(range::RangeFull) const {
+    return btree_map::Range<K, V>{tree.full_range()};
+  }
+};
+} // namespace collections
+
+namespace btree_map {
+template <class K, class V>
+struct crust_ebco Iter :
+    Impl<
+        Iter<K, V>,
+        Trait<iter::Iterator, Tuple<Ref<K>, Ref<V>>>,
+        Trait<iter::DoubleEndedIterator, Tuple<Ref<K>, Ref<V>>>,
+        Trait<iter::ExactSizeIterator, Tuple<Ref<K>, Ref<V>>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  template <class, class, class>
+  friend struct collections::BTreeMap;
+
+  _impl_btree::RawRange<K, V> inner;
+  usize remain;
+
+  Iter(_impl_btree::RawRange<K, V> inner, usize remain) :
+      inner{inner}, remain{remain} {}
+};
+
+template <class K, class V>
+struct crust_ebco IterMut :
+    Impl<
+        IterMut<K, V>,
+        Trait<iter::Iterator, Tuple<Ref<K>, RefMut<V>>>,
+        Trait<iter::DoubleEndedIterator, Tuple<Ref<K>, RefMut<V>>>,
+        Trait<iter::ExactSizeIterator, Tuple<Ref<K>, RefMut<V>>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  template <class, class, class>
+  friend struct collections::BTreeMap;
+
+  _impl_btree::RawRange<K, V> inner;
+  usize remain;
+
+  IterMut(_impl_btree::RawRange<K, V> inner, usize remain) :
+      inner{inner}, remain{remain} {}
+};
+
+/// pairs within a key range, see `BTreeMap::range'.
+template <class K, class V>
+struct crust_ebco Range :
+    Impl<
+        Range<K, V>,
+        Trait<iter::Iterator, Tuple<Ref<K>, Ref<V>>>,
+        Trait<iter::DoubleEndedIterator, Tuple<Ref<K>, Ref<V>>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  template <class, class, class>
+  friend struct collections::BTreeMap;
+
+  _impl_btree::RawRange<K, V> inner;
+
+  explicit Range(_impl_btree::RawRange<K, V> inner) : inner{inner} {}
+};
+} // namespace btree_map
+
+template <class K, class V>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::Iterator<btree_map::Iter<K, V>, Tuple<Ref<K>, Ref<V>>>)) {
+  CRUST_IMPL_USE_SELF(btree_map::Iter<K, V>);
+
+  Option<Tuple<Ref<K>, Ref<V>>> next() {
+    _impl_btree::Handle<K, V> handle;
+    auto *found = self().inner.next(handle);
+    self().remain -= found != nullptr;
+    return _impl_btree::pair_ref(found);
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    return tuple(self().remain, make_some(self().remain));
+  }
+};
+
+template <class K, class V>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::DoubleEndedIterator<
+                           btree_map::Iter<K, V>,
+                           Tuple<Ref<K>, Ref<V>>>)) {
+  CRUST_IMPL_USE_SELF(btree_map::Iter<K, V>);
+
+  Option<Tuple<Ref<K>, Ref<V>>> next_back() {
+    _impl_btree::Handle<K, V> handle;
+    auto *found = self().inner.next_back(handle);
+    self().remain -= found != nullptr;
+    return _impl_btree::pair_ref(found);
+  }
+};
+
+template <class K, class V>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::ExactSizeIterator<
+                           btree_map::Iter<K, V>,
+                           Tuple<Ref<K>, Ref<V>>>)){};
+
+template <class K, class V>
+CRUST_IMPL_FOR(CRUST_MACRO(
+    iter::Iterator<btree_map::IterMut<K, V>, Tuple<Ref<K>, RefMut<V>>>)) {
+  CRUST_IMPL_USE_SELF(btree_map::IterMut<K, V>);
+
+  Option<Tuple<Ref<K>, RefMut<V>>> next() {
+    _impl_btree::Handle<K, V> handle;
+    auto *found = self().inner.next(handle);
+    self().remain -= found != nullptr;
+    return _impl_btree::pair_mut(found);
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    return tuple(self().remain, make_some(self().remain));
+  }
+};
+
+template <class K, class V>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::DoubleEndedIterator<
+                           btree_map::IterMut<K, V>,
+                           Tuple<Ref<K>, RefMut<V>>>)) {
+  CRUST_IMPL_USE_SELF(btree_map::IterMut<K, V>);
+
+  Option<Tuple<Ref<K>, RefMut<V>>> next_back() {
+    _impl_btree::Handle<K, V> handle;
+    auto *found = self().inner.next_back(handle);
+    self().remain -= found != nullptr;
+    return _impl_btree::pair_mut(found);
+  }
+};
+
+template <class K, class V>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::ExactSizeIterator<
+                           btree_map::IterMut<K, V>,
+                           Tuple<Ref<K>, RefMut<V>>>)){};
+
+template <class K, class V>
+CRUST_IMPL_FOR(CRUST_MACRO(
+    iter::Iterator<btree_map::Range<K, V>, Tuple<Ref<K>, Ref<V>>>)) {
+  CRUST_IMPL_USE_SELF(btree_map::Range<K, V>);
+
+  Option<Tuple<Ref<K>, Ref<V>>> next() {
+    _impl_btree::Handle<K, V> handle;
+    return _impl_btree::pair_ref(self().inner.next(handle));
+  }
+};
+
+template <class K, class V>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::DoubleEndedIterator<
+                           btree_map::Range<K, V>,
+                           Tuple<Ref<K>, Ref<V>>>)) {
+  CRUST_IMPL_USE_SELF(btree_map::Range<K, V>);
+
+  Option<Tuple<Ref<K>, Ref<V>>> next_back() {
+    _impl_btree::Handle<K, V> handle;
+    return _impl_btree::pair_ref(self().inner.next_back(handle));
+  }
+};
+
+template <class K, class V, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(clone::Clone<collections::BTreeMap<K, V, A>>)) {
+  CRUST_IMPL_USE_SELF(collections::BTreeMap<K, V, A>);
+
+  Self clone() const {
+    Self ret{self().tree.allocator()};
+    ret.tree = self().tree.clone();
+    return ret;
+  }
+
+  void clone_from(const Self &other) { self() = other.clone(); }
+};
+
+template <class K, class V, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialEq<collections::BTreeMap<K, V, A>>)) {
+  CRUST_IMPL_USE_SELF(collections::BTreeMap<K, V, A>);
+
+  /// both are sorted, so the pairs are compared in order.
+  bool eq(const Self &other) const {
+    if (self().len() != other.len()) {
+      return false;
+    }
+    _impl_btree::RawRange<K, V> lhs = self().tree.full_range();
+    _impl_btree::RawRange<K, V> rhs = other.tree.full_range();
+    _impl_btree::Handle<K, V> a, b;
+    while (lhs.next(a) != nullptr) {
+      rhs.next(b);
+      if (!(a.node->keys()[a.idx] == b.node->keys()[b.idx]) ||
+          !(a.node->vals()[a.idx] == b.node->vals()[b.idx])) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+template <class K, class V, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Eq<collections::BTreeMap<K, V, A>>)){};
+
+template <class K, class V, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(
+    iter::FromIterator<collections::BTreeMap<K, V, A>, Tuple<K, V>>)) {
+  CRUST_IMPL_USE_SELF(collections::BTreeMap<K, V, A>);
+
+  template <class I>
+  static Self from_iter(I &&iter) {
+    Self ret;
+    while (true) {
+      auto x = iter.next();
+      if (x.is_none()) {
+        return ret;
+      }
+      Tuple<K, V> pair = move(x).unwrap();
+      ret.insert(move(pair.template get<0>()), move(pair.template get<1>()));
+    }
+  }
+};
+} // namespace crust
+
+
+#endif // CRUST_COLLECTIONS_BTREE_MAP_HPP
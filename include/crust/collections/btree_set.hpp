@@ -0,0 +1,310 @@
+#ifndef CRUST_COLLECTIONS_BTREE_SET_HPP
+#define CRUST_COLLECTIONS_BTREE_SET_HPP
+
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/collections/btree_map.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/ops/range.hpp"
+#include "crust/option.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace collections {
+template <class K, class A = alloc::Global>
+struct BTreeSet;
+} // namespace collections
+
+namespace btree_set {
+template <class K>
+struct Iter;
+
+template <class K>
+struct Range;
+} // namespace btree_set
+
+namespace _impl_btree {
+template <class K>
+Option<Ref<K>> key_ref(Handle<K, SetValue> *handle) {
+  if (handle == nullptr) {
+    return None{};
+  }
+  return make_some(ref(handle->node->keys()[handle->idx]));
+}
+} // namespace _impl_btree
+
+namespace collections {
+/// ordered set on the same tree as `BTreeMap', storing the keys alone.
+template <class K, class A>
+struct crust_ebco BTreeSet :
+    Impl<
+        BTreeSet<K, A>,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<iter::FromIterator, K>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  using SetValue = _impl_btree::SetValue;
+  using Handle = _impl_btree::Handle<K, SetValue>;
+
+  _impl_btree::Tree<K, SetValue, A> tree;
+
+  Option<K> pop(Handle *handle) {
+    if (handle == nullptr) {
+      return None{};
+    }
+    return make_some(move(tree.remove(*handle).template get<0>()));
+  }
+
+public:
+  explicit BTreeSet(A alloc = A{}) : tree{alloc} {}
+
+  BTreeSet(BTreeSet &&) noexcept = default;
+
+  BTreeSet &operator=(BTreeSet &&) noexcept = default;
+
+  usize len() const { return tree.length; }
+
+  bool is_empty() const { return len() == 0; }
+
+  void clear() { tree.clear(); }
+
+  bool contains(const K &key) const {
+    bool found;
+    tree.search(key, found);
+    return found;
+  }
+
+  Option<Ref<K>> get(const K &key) const {
+    bool found;
+    Handle handle = tree.search(key, found);
+    return _impl_btree::key_ref(found ? &handle : nullptr);
+  }
+
+  Option<Ref<K>> first() const {
+    Handle handle;
+    _impl_btree::RawRange<K, SetValue> range = tree.full_range();
+    return _impl_btree::key_ref(range.next(handle));
+  }
+
+  Option<Ref<K>> last() const {
+    Handle handle;
+    _impl_btree::RawRange<K, SetValue> range = tree.full_range();
+    return _impl_btree::key_ref(range.next_back(handle));
+  }
+
+  /// `false' if an equal key was present, which is kept.
+  bool insert(K key) {
+    bool found;
+    Handle handle = tree.search(key, found);
+    if (found) {
+      return false;
+    }
+    tree.insert(handle, move(key), SetValue{});
+    return true;
+  }
+
+  bool remove(const K &key) { return take(key).is_some(); }
+
+  Option<K> take(const K &key) {
+    bool found;
+    Handle handle = tree.search(key, found);
+    return pop(found ? &handle : nullptr);
+  }
+
+  Option<K> pop_first() {
+    Handle handle;
+    _impl_btree::RawRange<K, SetValue> range = tree.full_range();
+    return pop(range.next(handle));
+  }
+
+  Option<K> pop_last() {
+    Handle handle;
+    _impl_btree::RawRange<K, SetValue> range = tree.full_range();
+    return pop(range.next_back(handle));
+  }
+
+  btree_set::Iter<K> iter() const {
+    return btree_set::Iter<K>{tree.full_range(), len()};
+  }
+
+  /// keys in `[bounds.start, bounds.end)', in order.
+  btree_set::Range<K> range(const range::Range<K> &bounds) const {
+    return btree_set::Range<K>{tree.range(&bounds.start, &bounds.end)};
+  }
+
+  btree_set::Range<K> range(const range::RangeFrom<K> &bounds) const {
+    return btree_set::Range<K>{tree.range(&bounds.start, nullptr)};
+  }
+
+  btree_set::Range<K> range(const range::RangeTo<K> &bounds) const {
+    return btree_set::Range<K>{tree.range(nullptr, &bounds.end)};
+  }
+
+  btree_set::Range<K> range(range::RangeFull) const {
+    return btree_set::Range<K>{tree.full_range()};
+  }
+};
+} // namespace collections
+
+namespace btree_set {
+template <class K>
+struct crust_ebco Iter :
+    Impl<
+        Iter<K>,
+        Trait<iter::Iterator, Ref<K>>,
+        Trait<iter::DoubleEndedIterator, Ref<K>>,
+        Trait<iter::ExactSizeIterator, Ref<K>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  template <class, class>
+  friend struct collections::BTreeSet;
+
+  _impl_btree::RawRange<K, _impl_btree::SetValue> inner;
+  usize remain;
+
+  Iter(_impl_btree::RawRange<K, _impl_btree::SetValue> inner, usize remain) :
+      inner{inner}, remain{remain} {}
+};
+
+/// keys within a range, see `BTreeSet::range'.
+template <class K>
+struct crust_ebco Range :
+    Impl<
+        Range<K>,
+        Trait<iter::Iterator, Ref<K>>,
+        Trait<iter::DoubleEndedIterator, Ref<K>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  template <class, class>
+  friend struct collections::BTreeSet;
+
+  _impl_btree::RawRange<K, _impl_btree::SetValue> inner;
+
+  explicit Range(_impl_btree::RawRange<K, _impl_btree::SetValue> inner) :
+      inner{inner} {}
+};
+} // namespace btree_set
+
+template <class K>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<btree_set::Iter<K>, Ref<K>>)) {
+  CRUST_IMPL_USE_SELF(btree_set::Iter<K>);
+
+  Option<Ref<K>> next() {
+    _impl_btree::Handle<K, _impl_btree::SetValue> handle;
+    auto *found = self().inner.next(handle);
+    self().remain -= found != nullptr;
+    return _impl_btree::key_ref(found);
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    return tuple(self().remain, make_some(self().remain));
+  }
+};
+
+template <class K>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::DoubleEndedIterator<btree_set::Iter<K>, Ref<K>>)) {
+  CRUST_IMPL_USE_SELF(btree_set::Iter<K>);
+
+  Option<Ref<K>> next_back() {
+    _impl_btree::Handle<K, _impl_btree::SetValue> handle;
+    auto *found = self().inner.next_back(handle);
+    self().remain -= found != nullptr;
+    return _impl_btree::key_ref(found);
+  }
+};
+
+template <class K>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::ExactSizeIterator<btree_set::Iter<K>, Ref<K>>)){};
+
+template <class K>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<btree_set::Range<K>, Ref<K>>)) {
+  CRUST_IMPL_USE_SELF(btree_set::Range<K>);
+
+  Option<Ref<K>> next() {
+    _impl_btree::Handle<K, _impl_btree::SetValue> handle;
+    return _impl_btree::key_ref(self().inner.next(handle));
+  }
+};
+
+template <class K>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::DoubleEndedIterator<btree_set::Range<K>, Ref<K>>)) {
+  CRUST_IMPL_USE_SELF(btree_set::Range<K>);
+
+  Option<Ref<K>> next_back() {
+    _impl_btree::Handle<K, _impl_btree::SetValue> handle;
+    return _impl_btree::key_ref(self().inner.next_back(handle));
+  }
+};
+
+template <class K, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(clone::Clone<collections::BTreeSet<K, A>>)) {
+  CRUST_IMPL_USE_SELF(collections::BTreeSet<K, A>);
+
+  Self clone() const {
+    Self ret{self().tree.allocator()};
+    ret.tree = self().tree.clone();
+    return ret;
+  }
+
+  void clone_from(const Self &other) { self() = other.clone(); }
+};
+
+template <class K, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialEq<collections::BTreeSet<K, A>>)) {
+  CRUST_IMPL_USE_SELF(collections::BTreeSet<K, A>);
+
+  bool eq(const Self &other) const {
+    if (self().len() != other.len()) {
+      return false;
+    }
+    auto lhs = self().tree.full_range();
+    auto rhs = other.tree.full_range();
+    _impl_btree::Handle<K, _impl_btree::SetValue> a, b;
+    while (lhs.next(a) != nullptr) {
+      rhs.next(b);
+      if (!(a.node->keys()[a.idx] == b.node->keys()[b.idx])) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+template <class K, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Eq<collections::BTreeSet<K, A>>)){};
+
+template <class K, class A>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::FromIterator<collections::BTreeSet<K, A>, K>)) {
+  CRUST_IMPL_USE_SELF(collections::BTreeSet<K, A>);
+
+  template <class I>
+  static Self from_iter(I &&iter) {
+    Self ret;
+    while (true) {
+      auto x = iter.next();
+      if (x.is_none()) {
+        return ret;
+      }
+      ret.insert(move(x).unwrap());
+    }
+  }
+};
+} // namespace crust
+
+
+#endif // CRUST_COLLECTIONS_BTREE_SET_HPP
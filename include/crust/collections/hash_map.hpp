@@ -0,0 +1,857 @@
+#ifndef CRUST_COLLECTIONS_HASH_MAP_HPP
+#define CRUST_COLLECTIONS_HASH_MAP_HPP
+
+
+#include <cstring>
+#include <new>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/hash/mod.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/num/mod.hpp"
+#include "crust/ops/function.hpp"
+#include "crust/option.hpp"
+#include "crust/tuple.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace _impl_hash_map {
+/// control bytes, a full slot stores the top 7 bits of its hash instead.
+constexpr u8 EMPTY = 0xFF;
+constexpr u8 DELETED = 0x80;
+
+crust_always_inline bool is_full(u8 ctrl) { return (ctrl & 0x80) == 0; }
+
+crust_always_inline u8 h2(u64 hash) { return static_cast<u8>(hash >> 57); }
+
+/// set of matching slots in a group, `stride' bits per slot with the lowest
+/// one of each slot set on a match.
+template <class Word, usize stride, usize width>
+struct BitMask {
+  Word bits;
+
+  bool any() const { return bits != 0; }
+
+  usize lowest() const {
+    return num::trailing_zeros(bits) / stride;
+  }
+
+  BitMask remove_lowest() const {
+    return BitMask{static_cast<Word>(bits & (bits - 1))};
+  }
+
+  usize trailing_zeros() const { return bits == 0 ? width : lowest(); }
+
+  usize leading_zeros() const {
+    if (bits == 0) {
+      return width;
+    }
+    usize unused = 64 - width * stride;
+    return (num::leading_zeros(bits) - unused) / stride;
+  }
+};
+
+/// 8 control bytes in a word, matched with bit tricks on any target.
+struct SwarGroup {
+  static constexpr usize WIDTH = 8;
+  static constexpr u64 LSB = 0x0101010101010101ull;
+  static constexpr u64 MSB = 0x8080808080808080ull;
+
+  using Mask = BitMask<u64, 8, WIDTH>;
+
+  u64 word;
+
+  static SwarGroup load(const u8 *ctrl) {
+    u64 word;
+    std::memcpy(&word, ctrl, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = num::swap_bytes(word);
+#endif
+    return SwarGroup{word};
+  }
+
+  /// may report false positives next to a real match, callers compare the
+  /// keys anyway.
+  Mask match_byte(u8 byte) const {
+    u64 cmp = word ^ (LSB * byte);
+    return Mask{(cmp - LSB) & ~cmp & MSB};
+  }
+
+  Mask match_empty() const { return Mask{word & (word << 1) & MSB}; }
+
+  Mask match_empty_or_deleted() const { return Mask{word & MSB}; }
+
+  Mask match_full() const { return Mask{~word & MSB}; }
+};
+
+#if defined(__SSE2__) || defined(_M_X64)
+/// 16 control bytes compared at once with SSE2.
+struct SseGroup {
+  static constexpr usize WIDTH = 16;
+
+  using Mask = BitMask<u32, 1, WIDTH>;
+
+  __m128i vector;
+
+  static SseGroup load(const u8 *ctrl) {
+    return SseGroup{_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))};
+  }
+
+  static Mask mask_of(__m128i vector) {
+    return Mask{static_cast<u32>(_mm_movemask_epi8(vector))};
+  }
+
+  Mask match_byte(u8 byte) const {
+    return mask_of(
+        _mm_cmpeq_epi8(vector, _mm_set1_epi8(static_cast<char>(byte))));
+  }
+
+  Mask match_empty() const {
+    return mask_of(
+        _mm_cmpeq_epi8(vector, _mm_set1_epi8(static_cast<char>(EMPTY))));
+  }
+
+  Mask match_empty_or_deleted() const { return mask_of(vector); }
+
+  Mask match_full() const { return Mask{mask_of(vector).bits ^ 0xFFFF}; }
+};
+
+using Group = SseGroup;
+#else
+using Group = SwarGroup;
+#endif
+
+/// control bytes of every table without an allocation, a template so that
+/// all translation units share one copy.
+template <class = void>
+struct EmptyGroup {
+  alignas(Group) static const u8 ctrl[Group::WIDTH];
+};
+
+template <class T>
+alignas(Group) const u8 EmptyGroup<T>::ctrl[Group::WIDTH] = {
+    EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY,
+#if defined(__SSE2__) || defined(_M_X64)
+    EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY,
+#endif
+};
+
+/// triangular probing, which visits every group once for power of two
+/// bucket counts.
+struct ProbeSeq {
+  usize pos;
+  usize stride;
+
+  void next(usize bucket_mask) {
+    stride += Group::WIDTH;
+    pos = (pos + stride) & bucket_mask;
+  }
+};
+
+/// the table is kept at most 7/8 full.
+inline usize bucket_mask_to_capacity(usize bucket_mask) {
+  return bucket_mask < 8 ? bucket_mask : (bucket_mask + 1) / 8 * 7;
+}
+
+inline usize capacity_to_buckets(usize cap) {
+  if (cap < 8) {
+    return cap < 4 ? 4 : 8;
+  }
+  usize buckets = 1;
+  usize adjusted = cap / 7 * 8 + (cap % 7 != 0 ? 8 : 0);
+  while (buckets < adjusted) {
+    buckets *= 2;
+  }
+  return buckets;
+}
+
+/// open addressing table after google's swiss table. each slot has a control
+/// byte, and a group of them is matched against the 7 bit hash tag in one
+/// step. the first `Group::WIDTH' control bytes are mirrored past the end so
+/// that a group can be loaded at any slot. slots and control bytes share one
+/// allocation from `A'.
+template <class T, class A>
+struct crust_ebco RawTable : private A {
+  u8 *ctrl;
+  T *slots;
+  usize bucket_mask;
+  usize items;
+  usize growth_left;
+
+  explicit RawTable(A alloc = A{}) : A{alloc} { set_empty(); }
+
+  RawTable(const RawTable &) = delete;
+
+  RawTable(RawTable &&other) noexcept : A{other.allocator()} {
+    take_from(other);
+  }
+
+  RawTable &operator=(const RawTable &) = delete;
+
+  RawTable &operator=(RawTable &&other) noexcept {
+    if (this != &other) {
+      drop();
+      allocator() = other.allocator();
+      take_from(other);
+    }
+
+    return *this;
+  }
+
+  A &allocator() { return *this; }
+
+  const A &allocator() const { return *this; }
+
+  bool is_allocated() const { return bucket_mask != 0; }
+
+  usize buckets() const { return bucket_mask + 1; }
+
+  usize capacity() const { return items + growth_left; }
+
+  void set_empty() {
+    ctrl = const_cast<u8 *>(EmptyGroup<>::ctrl);
+    slots = nullptr;
+    bucket_mask = 0;
+    items = 0;
+    growth_left = 0;
+  }
+
+  void take_from(RawTable &other) {
+    ctrl = other.ctrl;
+    slots = other.slots;
+    bucket_mask = other.bucket_mask;
+    items = other.items;
+    growth_left = other.growth_left;
+    other.set_empty();
+  }
+
+  static usize ctrl_offset(usize buckets) { return buckets * sizeof(T); }
+
+  static usize alloc_size(usize buckets) {
+    return ctrl_offset(buckets) + buckets + Group::WIDTH;
+  }
+
+  /// table with `buckets' slots, all of them empty.
+  static RawTable with_buckets(usize buckets, A alloc) {
+    RawTable ret{alloc};
+    u8 *ptr = static_cast<u8 *>(
+        ret.allocator().allocate(alloc_size(buckets), alignof(T)));
+    ret.slots = reinterpret_cast<T *>(ptr);
+    ret.ctrl = ptr + ctrl_offset(buckets);
+    ret.bucket_mask = buckets - 1;
+    ret.growth_left = bucket_mask_to_capacity(buckets - 1);
+    std::memset(ret.ctrl, EMPTY, buckets + Group::WIDTH);
+    return ret;
+  }
+
+  void set_ctrl(usize index, u8 value) {
+    ctrl[index] = value;
+    ctrl[((index - Group::WIDTH) & bucket_mask) + Group::WIDTH] = value;
+  }
+
+  ProbeSeq probe_seq(u64 hash) const {
+    return ProbeSeq{static_cast<usize>(hash) & bucket_mask, 0};
+  }
+
+  template <class Eq>
+  T *find(u64 hash, Eq &&eq) const {
+    u8 tag = h2(hash);
+    ProbeSeq seq = probe_seq(hash);
+    while (true) {
+      Group group = Group::load(ctrl + seq.pos);
+      for (auto mask = group.match_byte(tag); mask.any();
+           mask = mask.remove_lowest()) {
+        usize index = (seq.pos + mask.lowest()) & bucket_mask;
+        if (crust_likely(eq(slots[index]))) {
+          return slots + index;
+        }
+      }
+      if (crust_likely(group.match_empty().any())) {
+        return nullptr;
+      }
+      seq.next(bucket_mask);
+    }
+  }
+
+  /// first empty or deleted slot on the probe sequence of `hash'.
+  usize find_insert_slot(u64 hash) const {
+    ProbeSeq seq = probe_seq(hash);
+    while (true) {
+      auto mask = Group::load(ctrl + seq.pos).match_empty_or_deleted();
+      if (mask.any()) {
+        usize index = (seq.pos + mask.lowest()) & bucket_mask;
+        // tables smaller than a group see the padding past their end as
+        // empty, which wraps around to a full slot. the table is never
+        // full, so the first group from the start has a free one.
+        if (crust_unlikely(is_full(ctrl[index]))) {
+          index = Group::load(ctrl).match_empty_or_deleted().lowest();
+        }
+        return index;
+      }
+      seq.next(bucket_mask);
+    }
+  }
+
+  /// inserts without looking for an equal element, `hasher' rehashes the
+  /// elements when the table has to grow.
+  template <class H>
+  T *insert(u64 hash, T value, H &&hasher) {
+    usize index = find_insert_slot(hash);
+    if (crust_unlikely(growth_left == 0 && ctrl[index] == EMPTY)) {
+      reserve(1, hasher);
+      index = find_insert_slot(hash);
+    }
+    growth_left -= ctrl[index] == EMPTY ? 1 : 0;
+    set_ctrl(index, h2(hash));
+    ++items;
+    return ::new (slots + index) T{move(value)};
+  }
+
+  /// a slot can only become empty again if no group containing it was ever
+  /// full, otherwise probes passing it would stop early.
+  void erase_ctrl(usize index) {
+    usize before = (index - Group::WIDTH) & bucket_mask;
+    auto empty_before = Group::load(ctrl + before).match_empty();
+    auto empty_after = Group::load(ctrl + index).match_empty();
+    if (empty_before.leading_zeros() + empty_after.trailing_zeros() >=
+        Group::WIDTH) {
+      set_ctrl(index, DELETED);
+    } else {
+      set_ctrl(index, EMPTY);
+      ++growth_left;
+    }
+    --items;
+  }
+
+  /// moves the element out of `slot' and frees the slot.
+  T take(T *slot) {
+    T value{move(*slot)};
+    slot->~T();
+    erase_ctrl(static_cast<usize>(slot - slots));
+    return value;
+  }
+
+  void erase(T *slot) {
+    slot->~T();
+    erase_ctrl(static_cast<usize>(slot - slots));
+  }
+
+  template <class H>
+  void reserve(usize additional, H &&hasher) {
+    if (additional <= growth_left) {
+      return;
+    }
+    usize full_capacity = bucket_mask_to_capacity(bucket_mask);
+    usize needed = items + additional;
+    // deleted slots are what fills the table, rebuilding at the same size
+    // clears them.
+    resize(
+        needed <= full_capacity / 2 ? full_capacity :
+                                      (needed > full_capacity + 1 ?
+                                           needed :
+                                           full_capacity + 1),
+        hasher);
+  }
+
+  template <class H>
+  void resize(usize cap, H &&hasher) {
+    RawTable next = with_buckets(capacity_to_buckets(cap), allocator());
+    for (usize i = 0; i < buckets(); ++i) {
+      if (is_full(ctrl[i])) {
+        u64 hash = hasher(slots[i]);
+        usize index = next.find_insert_slot(hash);
+        next.set_ctrl(index, h2(hash));
+        ::new (next.slots + index) T{move(slots[i])};
+        slots[i].~T();
+      }
+    }
+    next.growth_left -= items;
+    next.items = items;
+    // the elements have been moved out, only the memory is left to free.
+    if (is_allocated()) {
+      allocator().deallocate(slots, alloc_size(buckets()), alignof(T));
+    }
+    take_from(next);
+  }
+
+  template <class H>
+  void shrink_to(usize cap, H &&hasher) {
+    if (cap < items) {
+      cap = items;
+    }
+    if (cap == 0) {
+      drop();
+    } else if (capacity_to_buckets(cap) < buckets()) {
+      resize(cap, hasher);
+    }
+  }
+
+  void clear() {
+    if (!is_allocated()) {
+      return;
+    }
+    for (usize i = 0; i < buckets(); ++i) {
+      if (is_full(ctrl[i])) {
+        slots[i].~T();
+      }
+    }
+    std::memset(ctrl, EMPTY, buckets() + Group::WIDTH);
+    items = 0;
+    growth_left = bucket_mask_to_capacity(bucket_mask);
+  }
+
+  /// copies the layout as is, without rehashing.
+  RawTable clone() const {
+    if (!is_allocated()) {
+      return RawTable{allocator()};
+    }
+    RawTable ret = with_buckets(buckets(), allocator());
+    std::memcpy(ret.ctrl, ctrl, buckets() + Group::WIDTH);
+    for (usize i = 0; i < buckets(); ++i) {
+      if (is_full(ctrl[i])) {
+        ::new (ret.slots + i) T{_impl_clone::clone_of(slots[i])};
+      }
+    }
+    ret.items = items;
+    ret.growth_left = growth_left;
+    return ret;
+  }
+
+  void drop() {
+    if (is_allocated()) {
+      clear();
+      allocator().deallocate(slots, alloc_size(buckets()), alignof(T));
+      set_empty();
+    }
+  }
+
+  ~RawTable() { drop(); }
+};
+
+/// walks the full slots one group at a time.
+template <class T>
+struct RawIter {
+  const u8 *ctrl;
+  T *slots;
+  Group::Mask mask;
+  usize remain;
+
+  RawIter(const u8 *ctrl, T *slots, usize items) :
+      ctrl{ctrl},
+      slots{slots},
+      mask(Group::load(ctrl).match_full()),
+      remain{items} {}
+
+  T *next() {
+    if (remain == 0) {
+      return nullptr;
+    }
+    while (!mask.any()) {
+      ctrl += Group::WIDTH;
+      slots += Group::WIDTH;
+      mask = Group::load(ctrl).match_full();
+    }
+    T *ret = slots + mask.lowest();
+    mask = mask.remove_lowest();
+    --remain;
+    return ret;
+  }
+};
+
+template <class K, class V>
+struct Bucket {
+  K key;
+  V value;
+
+  Bucket(K &&key, V &&value) : key{move(key)}, value{move(value)} {}
+
+  Bucket(const Bucket &other) :
+      key{_impl_clone::clone_of(other.key)},
+      value{_impl_clone::clone_of(other.value)} {}
+
+  Bucket(Bucket &&other) noexcept = default;
+};
+} // namespace _impl_hash_map
+
+namespace collections {
+template <
+    class K,
+    class V,
+    class S = hash::RandomState,
+    class A = alloc::Global>
+struct HashMap;
+} // namespace collections
+
+namespace hash_map {
+template <class K, class V>
+struct Iter;
+
+template <class K, class V>
+struct IterMut;
+
+template <class K, class V, class S, class A>
+struct Entry;
+} // namespace hash_map
+
+namespace collections {
+/// hash map with open addressing, see `_impl_hash_map::RawTable'. keys are
+/// hashed with `hash::Hash' through hashers built by `S' and compared with
+/// `cmp::Eq'.
+template <class K, class V, class S, class A>
+struct crust_ebco HashMap :
+    Impl<
+        HashMap<K, V, S, A>,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<iter::FromIterator, Tuple<K, V>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  friend struct hash_map::Entry<K, V, S, A>;
+
+  using Bucket = _impl_hash_map::Bucket<K, V>;
+
+  S hash_builder;
+  _impl_hash_map::RawTable<Bucket, A> table;
+
+  u64 hash_of(const K &key) const { return hash::hash_one(hash_builder, key); }
+
+  struct Hasher {
+    const S &hash_builder;
+
+    u64 operator()(const Bucket &bucket) const {
+      return hash::hash_one(hash_builder, bucket.key);
+    }
+  };
+
+  struct KeyEq {
+    const K &key;
+
+    bool operator()(const Bucket &bucket) const { return bucket.key == key; }
+  };
+
+  Bucket *find(const K &key) const {
+    return table.find(hash_of(key), KeyEq{key});
+  }
+
+public:
+  explicit HashMap(S hash_builder = S{}, A alloc = A{}) :
+      hash_builder{move(hash_builder)}, table{alloc} {}
+
+  static HashMap with_capacity(usize cap) {
+    HashMap ret;
+    ret.reserve(cap);
+    return ret;
+  }
+
+  HashMap(HashMap &&) noexcept = default;
+
+  HashMap &operator=(HashMap &&) noexcept = default;
+
+  usize len() const { return table.items; }
+
+  bool is_empty() const { return len() == 0; }
+
+  /// number of elements that fit without growing.
+  usize capacity() const { return table.capacity(); }
+
+  const S &hasher() const { return hash_builder; }
+
+  void reserve(usize additional) {
+    table.reserve(additional, Hasher{hash_builder});
+  }
+
+  void shrink_to_fit() { table.shrink_to(0, Hasher{hash_builder}); }
+
+  void clear() { table.clear(); }
+
+  Option<Ref<V>> get(const K &key) const {
+    Bucket *bucket = find(key);
+    if (bucket == nullptr) {
+      return None{};
+    }
+    return make_some(ref(bucket->value));
+  }
+
+  Option<RefMut<V>> get_mut(const K &key) {
+    Bucket *bucket = find(key);
+    if (bucket == nullptr) {
+      return None{};
+    }
+    return make_some(ref_mut(bucket->value));
+  }
+
+  bool contains_key(const K &key) const { return find(key) != nullptr; }
+
+  /// returns the previous value, the key is kept in that case.
+  Option<V> insert(K key, V value) {
+    u64 hash = hash_of(key);
+    Bucket *bucket = table.find(hash, KeyEq{key});
+    if (bucket != nullptr) {
+      V old{move(bucket->value)};
+      bucket->value = move(value);
+      return make_some(move(old));
+    }
+    table.insert(hash, Bucket{move(key), move(value)}, Hasher{hash_builder});
+    return None{};
+  }
+
+  Option<V> remove(const K &key) {
+    Bucket *bucket = find(key);
+    if (bucket == nullptr) {
+      return None{};
+    }
+    return make_some(table.take(bucket).value);
+  }
+
+  /// slot for `key', found or not with a single hash computation.
+  hash_map::Entry<K, V, S, A> entry(K key) {
+    u64 hash = hash_of(key);
+    Bucket *bucket = table.find(hash, KeyEq{key});
+    return hash_map::Entry<K, V, S, A>{*this, move(key), hash, bucket};
+  }
+
+  template <class F>
+  void retain(ops::FnMut<F, bool(const K &, V &)> f) {
+    _impl_hash_map::RawIter<Bucket> iter{table.ctrl, table.slots, len()};
+    for (Bucket *bucket = iter.next(); bucket != nullptr;
+         bucket = iter.next()) {
+      if (!f(bucket->key, bucket->value)) {
+        table.erase(bucket);
+      }
+    }
+  }
+
+  hash_map::Iter<K, V> iter() const {
+    return hash_map::Iter<K, V>{table.ctrl, table.slots, len()};
+  }
+
+  hash_map::IterMut<K, V> iter_mut() {
+    return hash_map::IterMut<K, V>{table.ctrl, table.slots, len()};
+  }
+};
+} // namespace collections
+
+namespace hash_map {
+/// a key's slot in a `HashMap', occupied or vacant.
+template <class K, class V, class S, class A>
+struct Entry {
+private:
+  friend struct collections::HashMap<K, V, S, A>;
+
+  using Map = collections::HashMap<K, V, S, A>;
+  using Bucket = _impl_hash_map::Bucket<K, V>;
+
+  Map &map;
+  K key_;
+  u64 hash;
+  Bucket *bucket;
+
+  Entry(Map &map, K &&key, u64 hash, Bucket *bucket) :
+      map{map}, key_{move(key)}, hash{hash}, bucket{bucket} {}
+
+public:
+  bool is_occupied() const { return bucket != nullptr; }
+
+  const K &key() const { return bucket != nullptr ? bucket->key : key_; }
+
+  template <class F>
+  Entry and_modify(ops::FnMut<F, void(V &)> f) && {
+    if (bucket != nullptr) {
+      f(bucket->value);
+    }
+    return move(*this);
+  }
+
+  V &or_insert(V value) && {
+    if (bucket == nullptr) {
+      bucket = map.table.insert(
+          hash,
+          Bucket{move(key_), move(value)},
+          typename Map::Hasher{map.hash_builder});
+    }
+    return bucket->value;
+  }
+
+  template <class F>
+  V &or_insert_with(ops::FnOnce<F, V()> f) && {
+    if (bucket == nullptr) {
+      bucket = map.table.insert(
+          hash,
+          Bucket{move(key_), move(f)()},
+          typename Map::Hasher{map.hash_builder});
+    }
+    return bucket->value;
+  }
+
+  V &or_default() && {
+    if (bucket == nullptr) {
+      return move(*this).or_insert(V{});
+    }
+    return bucket->value;
+  }
+
+  /// removes an occupied entry's value.
+  Option<V> remove() && {
+    if (bucket == nullptr) {
+      return None{};
+    }
+    V value{map.table.take(bucket).value};
+    bucket = nullptr;
+    return make_some(move(value));
+  }
+};
+
+template <class K, class V>
+struct crust_ebco Iter :
+    Impl<
+        Iter<K, V>,
+        Trait<iter::Iterator, Tuple<Ref<K>, Ref<V>>>,
+        Trait<iter::ExactSizeIterator, Tuple<Ref<K>, Ref<V>>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  template <class, class, class, class>
+  friend struct collections::HashMap;
+
+  _impl_hash_map::RawIter<_impl_hash_map::Bucket<K, V>> inner;
+
+  Iter(const u8 *ctrl, _impl_hash_map::Bucket<K, V> *slots, usize items) :
+      inner{ctrl, slots, items} {}
+};
+
+template <class K, class V>
+struct crust_ebco IterMut :
+    Impl<
+        IterMut<K, V>,
+        Trait<iter::Iterator, Tuple<Ref<K>, RefMut<V>>>,
+        Trait<iter::ExactSizeIterator, Tuple<Ref<K>, RefMut<V>>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  template <class, class, class, class>
+  friend struct collections::HashMap;
+
+  _impl_hash_map::RawIter<_impl_hash_map::Bucket<K, V>> inner;
+
+  IterMut(const u8 *ctrl, _impl_hash_map::Bucket<K, V> *slots, usize items) :
+      inner{ctrl, slots, items} {}
+};
+} // namespace hash_map
+
+template <class K, class V>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::Iterator<hash_map::Iter<K, V>, Tuple<Ref<K>, Ref<V>>>)) {
+  CRUST_IMPL_USE_SELF(hash_map::Iter<K, V>);
+
+  Option<Tuple<Ref<K>, Ref<V>>> next() {
+    _impl_hash_map::Bucket<K, V> *bucket = self().inner.next();
+    if (bucket == nullptr) {
+      return None{};
+    }
+    return make_some(tuple(ref(bucket->key), ref(bucket->value)));
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    return tuple(self().inner.remain, make_some(self().inner.remain));
+  }
+};
+
+template <class K, class V>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::ExactSizeIterator<
+                           hash_map::Iter<K, V>,
+                           Tuple<Ref<K>, Ref<V>>>)){};
+
+template <class K, class V>
+CRUST_IMPL_FOR(CRUST_MACRO(
+    iter::Iterator<hash_map::IterMut<K, V>, Tuple<Ref<K>, RefMut<V>>>)) {
+  CRUST_IMPL_USE_SELF(hash_map::IterMut<K, V>);
+
+  Option<Tuple<Ref<K>, RefMut<V>>> next() {
+    _impl_hash_map::Bucket<K, V> *bucket = self().inner.next();
+    if (bucket == nullptr) {
+      return None{};
+    }
+    return make_some(tuple(ref(bucket->key), ref_mut(bucket->value)));
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    return tuple(self().inner.remain, make_some(self().inner.remain));
+  }
+};
+
+template <class K, class V>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::ExactSizeIterator<
+                           hash_map::IterMut<K, V>,
+                           Tuple<Ref<K>, RefMut<V>>>)){};
+
+template <class K, class V, class S, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(clone::Clone<collections::HashMap<K, V, S, A>>)) {
+  CRUST_IMPL_USE_SELF(collections::HashMap<K, V, S, A>);
+
+  Self clone() const {
+    Self ret{self().hash_builder, self().table.allocator()};
+    ret.table = self().table.clone();
+    return ret;
+  }
+
+  void clone_from(const Self &other) { self() = other.clone(); }
+};
+
+template <class K, class V, class S, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialEq<collections::HashMap<K, V, S, A>>)) {
+  CRUST_IMPL_USE_SELF(collections::HashMap<K, V, S, A>);
+
+  bool eq(const Self &other) const {
+    if (self().len() != other.len()) {
+      return false;
+    }
+    _impl_hash_map::RawIter<typename Self::Bucket> iter{
+        self().table.ctrl, self().table.slots, self().len()};
+    for (auto *bucket = iter.next(); bucket != nullptr; bucket = iter.next()) {
+      auto *found = other.find(bucket->key);
+      if (found == nullptr || !(found->value == bucket->value)) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+template <class K, class V, class S, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Eq<collections::HashMap<K, V, S, A>>)){};
+
+template <class K, class V, class S, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(
+    iter::FromIterator<collections::HashMap<K, V, S, A>, Tuple<K, V>>)) {
+  CRUST_IMPL_USE_SELF(collections::HashMap<K, V, S, A>);
+
+  template <class I>
+  static Self from_iter(I &&iter) {
+    Self ret;
+    ret.reserve(iter.size_hint().template get<0>());
+    while (true) {
+      auto x = iter.next();
+      if (x.is_none()) {
+        return ret;
+      }
+      Tuple<K, V> pair = move(x).unwrap();
+      ret.insert(move(pair.template get<0>()), move(pair.template get<1>()));
+    }
+  }
+};
+} // namespace crust
+
+
+#endif // CRUST_COLLECTIONS_HASH_MAP_HPP
@@ -0,0 +1,272 @@
+#ifndef CRUST_COLLECTIONS_HASH_SET_HPP
+#define CRUST_COLLECTIONS_HASH_SET_HPP
+
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/collections/hash_map.hpp"
+#include "crust/hash/mod.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/ops/function.hpp"
+#include "crust/option.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace collections {
+template <class K, class S = hash::RandomState, class A = alloc::Global>
+struct HashSet;
+} // namespace collections
+
+namespace hash_set {
+template <class K>
+struct Iter;
+} // namespace hash_set
+
+namespace collections {
+/// hash set on the same table as `HashMap', storing the keys alone.
+template <class K, class S, class A>
+struct crust_ebco HashSet :
+    Impl<
+        HashSet<K, S, A>,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<iter::FromIterator, K>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  S hash_builder;
+  _impl_hash_map::RawTable<K, A> table;
+
+  u64 hash_of(const K &key) const { return hash::hash_one(hash_builder, key); }
+
+  struct Hasher {
+    const S &hash_builder;
+
+    u64 operator()(const K &key) const {
+      return hash::hash_one(hash_builder, key);
+    }
+  };
+
+  struct KeyEq {
+    const K &key;
+
+    bool operator()(const K &other) const { return other == key; }
+  };
+
+  K *find(const K &key) const { return table.find(hash_of(key), KeyEq{key}); }
+
+public:
+  explicit HashSet(S hash_builder = S{}, A alloc = A{}) :
+      hash_builder{move(hash_builder)}, table{alloc} {}
+
+  static HashSet with_capacity(usize cap) {
+    HashSet ret;
+    ret.reserve(cap);
+    return ret;
+  }
+
+  HashSet(HashSet &&) noexcept = default;
+
+  HashSet &operator=(HashSet &&) noexcept = default;
+
+  usize len() const { return table.items; }
+
+  bool is_empty() const { return len() == 0; }
+
+  usize capacity() const { return table.capacity(); }
+
+  const S &hasher() const { return hash_builder; }
+
+  void reserve(usize additional) {
+    table.reserve(additional, Hasher{hash_builder});
+  }
+
+  void shrink_to_fit() { table.shrink_to(0, Hasher{hash_builder}); }
+
+  void clear() { table.clear(); }
+
+  bool contains(const K &key) const { return find(key) != nullptr; }
+
+  Option<Ref<K>> get(const K &key) const {
+    K *found = find(key);
+    if (found == nullptr) {
+      return None{};
+    }
+    return make_some(ref(*found));
+  }
+
+  /// `false' if an equal key was present, which is kept.
+  bool insert(K key) {
+    u64 hash = hash_of(key);
+    if (table.find(hash, KeyEq{key}) != nullptr) {
+      return false;
+    }
+    table.insert(hash, move(key), Hasher{hash_builder});
+    return true;
+  }
+
+  /// adds `key', replacing and returning an equal one.
+  Option<K> replace(K key) {
+    u64 hash = hash_of(key);
+    K *found = table.find(hash, KeyEq{key});
+    if (found != nullptr) {
+      K old{move(*found)};
+      *found = move(key);
+      return make_some(move(old));
+    }
+    table.insert(hash, move(key), Hasher{hash_builder});
+    return None{};
+  }
+
+  bool remove(const K &key) {
+    K *found = find(key);
+    if (found == nullptr) {
+      return false;
+    }
+    table.erase(found);
+    return true;
+  }
+
+  Option<K> take(const K &key) {
+    K *found = find(key);
+    if (found == nullptr) {
+      return None{};
+    }
+    return make_some(table.take(found));
+  }
+
+  template <class F>
+  void retain(ops::FnMut<F, bool(const K &)> f) {
+    _impl_hash_map::RawIter<K> iter{table.ctrl, table.slots, len()};
+    for (K *key = iter.next(); key != nullptr; key = iter.next()) {
+      if (!f(*key)) {
+        table.erase(key);
+      }
+    }
+  }
+
+  /// whether every key is also in `other'.
+  bool is_subset(const HashSet &other) const {
+    if (len() > other.len()) {
+      return false;
+    }
+    _impl_hash_map::RawIter<K> iter{table.ctrl, table.slots, len()};
+    for (K *key = iter.next(); key != nullptr; key = iter.next()) {
+      if (!other.contains(*key)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool is_disjoint(const HashSet &other) const {
+    const HashSet &small = len() <= other.len() ? *this : other;
+    const HashSet &large = len() <= other.len() ? other : *this;
+    _impl_hash_map::RawIter<K> iter{
+        small.table.ctrl, small.table.slots, small.len()};
+    for (K *key = iter.next(); key != nullptr; key = iter.next()) {
+      if (large.contains(*key)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  hash_set::Iter<K> iter() const {
+    return hash_set::Iter<K>{table.ctrl, table.slots, len()};
+  }
+};
+} // namespace collections
+
+namespace hash_set {
+template <class K>
+struct crust_ebco Iter :
+    Impl<
+        Iter<K>,
+        Trait<iter::Iterator, Ref<K>>,
+        Trait<iter::ExactSizeIterator, Ref<K>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  template <class, class, class>
+  friend struct collections::HashSet;
+
+  _impl_hash_map::RawIter<K> inner;
+
+  Iter(const u8 *ctrl, K *slots, usize items) : inner{ctrl, slots, items} {}
+};
+} // namespace hash_set
+
+template <class K>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<hash_set::Iter<K>, Ref<K>>)) {
+  CRUST_IMPL_USE_SELF(hash_set::Iter<K>);
+
+  Option<Ref<K>> next() {
+    K *key = self().inner.next();
+    if (key == nullptr) {
+      return None{};
+    }
+    return make_some(ref(*key));
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    return tuple(self().inner.remain, make_some(self().inner.remain));
+  }
+};
+
+template <class K>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::ExactSizeIterator<hash_set::Iter<K>, Ref<K>>)){};
+
+template <class K, class S, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(clone::Clone<collections::HashSet<K, S, A>>)) {
+  CRUST_IMPL_USE_SELF(collections::HashSet<K, S, A>);
+
+  Self clone() const {
+    Self ret{self().hash_builder, self().table.allocator()};
+    ret.table = self().table.clone();
+    return ret;
+  }
+
+  void clone_from(const Self &other) { self() = other.clone(); }
+};
+
+template <class K, class S, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialEq<collections::HashSet<K, S, A>>)) {
+  CRUST_IMPL_USE_SELF(collections::HashSet<K, S, A>);
+
+  bool eq(const Self &other) const {
+    return self().len() == other.len() && self().is_subset(other);
+  }
+};
+
+template <class K, class S, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Eq<collections::HashSet<K, S, A>>)){};
+
+template <class K, class S, class A>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::FromIterator<collections::HashSet<K, S, A>, K>)) {
+  CRUST_IMPL_USE_SELF(collections::HashSet<K, S, A>);
+
+  template <class I>
+  static Self from_iter(I &&iter) {
+    Self ret;
+    ret.reserve(iter.size_hint().template get<0>());
+    while (true) {
+      auto x = iter.next();
+      if (x.is_none()) {
+        return ret;
+      }
+      ret.insert(move(x).unwrap());
+    }
+  }
+};
+} // namespace crust
+
+
+#endif // CRUST_COLLECTIONS_HASH_SET_HPP
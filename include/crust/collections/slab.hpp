@@ -0,0 +1,334 @@
+#ifndef CRUST_COLLECTIONS_SLAB_HPP
+#define CRUST_COLLECTIONS_SLAB_HPP
+
+
+#include <new>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/cmp.hpp"
+#include "crust/collections/bit_vec.hpp"
+#include "crust/hash/mod.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/option.hpp"
+#include "crust/tuple.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+namespace crust {
+namespace _impl_slab {
+constexpr u32 NONE = 0xFFFFFFFF;
+
+/// slots are grouped into pages of one bitmap word each, pages are never
+/// moved, so references stay valid until their slot is removed.
+template <class T>
+struct Page {
+  static constexpr usize LEN = _impl_bit::WORD_BITS;
+
+  Uninit<T> values[LEN];
+  u32 generations[LEN];
+  /// next vacant slot of the free list, only meaningful while vacant.
+  u32 next_free[LEN];
+
+  static Page *create() {
+    void *raw = alloc::Global{}.allocate(sizeof(Page), alignof(Page));
+    return new (raw) Page{};
+  }
+
+  static void destroy(Page *page) {
+    page->~Page();
+    alloc::Global{}.deallocate(page, sizeof(Page), alignof(Page));
+  }
+};
+} // namespace _impl_slab
+
+namespace collections {
+template <class T>
+struct Slab;
+} // namespace collections
+
+namespace slab {
+/// key of a `Slab' entry. the generation tells a reused slot apart from the
+/// entry the handle was issued for.
+struct Handle;
+
+template <class T>
+struct Iter;
+} // namespace slab
+
+template <class S>
+CRUST_IMPL_FOR(cmp::PartialEq<S>, IsSame<S, slab::Handle>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  bool eq(const Self &other) const {
+    return self().index == other.index &&
+        self().generation == other.generation;
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::Eq<S>, IsSame<S, slab::Handle>){};
+
+template <class S>
+CRUST_IMPL_FOR(hash::Hash<S>, IsSame<S, slab::Handle>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  template <class H>
+  void hash(H &state) const {
+    state.write_u64(u64{self().generation} << 32 | self().index);
+  }
+};
+
+namespace slab {
+struct crust_ebco Handle :
+    Impl<Handle, Trait<cmp::PartialEq>, Trait<cmp::Eq>, Trait<hash::Hash>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  template <class>
+  friend struct collections::Slab;
+
+  template <class>
+  friend struct Iter;
+
+  u32 index;
+  u32 generation;
+
+  constexpr Handle(u32 index, u32 generation) :
+      index{index}, generation{generation} {}
+
+public:
+  constexpr u32 slot() const { return index; }
+};
+} // namespace slab
+
+namespace collections {
+/// entries in stable slots addressed by generational handles. removed slots
+/// go to a free list and are reused first, so insert and remove are O(1) and
+/// only allocate when every page is full. which slots are occupied is
+/// tracked in a bitmap, so iteration skips vacant slots a word at a time.
+template <class T>
+struct Slab {
+private:
+  using Page = _impl_slab::Page<T>;
+
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  friend struct slab::Iter<T>;
+
+  Vec<Page *> pages;
+  BitVec occupied;
+  usize size;
+  u32 free_head;
+
+  crust_always_inline Page &page_of(u32 index) const {
+    return *pages[index / Page::LEN];
+  }
+
+  crust_always_inline T *value_of(u32 index) const {
+    return &page_of(index).values[index % Page::LEN].value;
+  }
+
+  crust_always_inline u32 &generation_of(u32 index) const {
+    return page_of(index).generations[index % Page::LEN];
+  }
+
+  crust_always_inline u32 &next_free_of(u32 index) const {
+    return page_of(index).next_free[index % Page::LEN];
+  }
+
+  bool is_live(const slab::Handle &handle) const {
+    return handle.index < capacity() && occupied.get(handle.index).unwrap() &&
+        generation_of(handle.index) == handle.generation;
+  }
+
+  /// pushes the new page's slots onto the free list, lowest first.
+  void add_page() {
+    if (pages.len() * Page::LEN >= _impl_slab::NONE) {
+      crust_panic("slab is full!");
+    }
+    u32 base = static_cast<u32>(pages.len() * Page::LEN);
+    pages.push(Page::create());
+    for (usize i = 0; i < Page::LEN; ++i) {
+      occupied.push(false);
+      pages[pages.len() - 1]->next_free[i] =
+          i + 1 < Page::LEN ? base + static_cast<u32>(i) + 1 : free_head;
+    }
+    free_head = base;
+  }
+
+  void drop_values() {
+    auto iter = occupied.iter_ones();
+    for (auto index = iter.next(); index.is_some(); index = iter.next()) {
+      value_of(static_cast<u32>(move(index).unwrap()))->~T();
+    }
+  }
+
+  /// chains every slot onto the free list in ascending order, all of them
+  /// must be vacant.
+  void relink() {
+    free_head = _impl_slab::NONE;
+    for (usize i = capacity(); i != 0; --i) {
+      u32 index = static_cast<u32>(i - 1);
+      next_free_of(index) = free_head;
+      free_head = index;
+    }
+  }
+
+  void release() {
+    drop_values();
+    for (usize i = 0; i < pages.len(); ++i) {
+      Page::destroy(pages[i]);
+    }
+    pages.clear();
+    occupied.clear();
+  }
+
+public:
+  Slab() : size{0}, free_head{_impl_slab::NONE} {}
+
+  static Slab with_capacity(usize cap) {
+    Slab ret;
+    while (ret.capacity() < cap) {
+      ret.add_page();
+    }
+    ret.relink();
+    return ret;
+  }
+
+  Slab(Slab &&other) noexcept :
+      pages{move(other.pages)},
+      occupied{move(other.occupied)},
+      size{other.size},
+      free_head{other.free_head} {
+    other.size = 0;
+    other.free_head = _impl_slab::NONE;
+  }
+
+  Slab &operator=(Slab &&other) noexcept {
+    if (this != &other) {
+      release();
+      pages = move(other.pages);
+      occupied = move(other.occupied);
+      size = other.size;
+      free_head = other.free_head;
+      other.size = 0;
+      other.free_head = _impl_slab::NONE;
+    }
+    return *this;
+  }
+
+  usize len() const { return size; }
+
+  bool is_empty() const { return size == 0; }
+
+  usize capacity() const { return pages.len() * Page::LEN; }
+
+  slab::Handle insert(T value) {
+    if (free_head == _impl_slab::NONE) {
+      add_page();
+    }
+    u32 index = free_head;
+    free_head = next_free_of(index);
+    new (value_of(index)) T{move(value)};
+    occupied.set(index, true);
+    ++size;
+    return slab::Handle{index, generation_of(index)};
+  }
+
+  /// the entry, or none if the handle is stale.
+  Option<T> remove(const slab::Handle &handle) {
+    if (!is_live(handle)) {
+      return None{};
+    }
+    u32 index = handle.index;
+    T *ptr = value_of(index);
+    Option<T> ret = make_some(move(*ptr));
+    ptr->~T();
+    occupied.set(index, false);
+    ++generation_of(index);
+    next_free_of(index) = free_head;
+    free_head = index;
+    --size;
+    return ret;
+  }
+
+  bool contains(const slab::Handle &handle) const { return is_live(handle); }
+
+  Option<Ref<T>> get(const slab::Handle &handle) const {
+    if (!is_live(handle)) {
+      return None{};
+    }
+    return make_some(Ref<T>{*value_of(handle.index)});
+  }
+
+  Option<RefMut<T>> get_mut(const slab::Handle &handle) {
+    if (!is_live(handle)) {
+      return None{};
+    }
+    return make_some(RefMut<T>{*value_of(handle.index)});
+  }
+
+  /// drops every entry, the pages are kept. outstanding handles turn stale.
+  void clear() {
+    auto iter = occupied.iter_ones();
+    for (auto index = iter.next(); index.is_some(); index = iter.next()) {
+      u32 slot = static_cast<u32>(move(index).unwrap());
+      value_of(slot)->~T();
+      ++generation_of(slot);
+    }
+    occupied.fill(false);
+    relink();
+    size = 0;
+  }
+
+  /// entries with their handles, in slot order.
+  slab::Iter<T> iter() const { return slab::Iter<T>{*this}; }
+
+  ~Slab() { release(); }
+};
+} // namespace collections
+
+template <class T>
+CRUST_IMPL_FOR(CRUST_MACRO(
+    iter::Iterator<slab::Iter<T>, Tuple<slab::Handle, Ref<T>>>)) {
+  CRUST_IMPL_USE_SELF(slab::Iter<T>);
+
+  Option<Tuple<slab::Handle, Ref<T>>> next() {
+    auto index = self().ones.next();
+    if (index.is_none()) {
+      return None{};
+    }
+    u32 slot = static_cast<u32>(move(index).unwrap());
+    return make_some(tuple(
+        slab::Handle{slot, self().slab->generation_of(slot)},
+        Ref<T>{*self().slab->value_of(slot)}));
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    return self().ones.size_hint();
+  }
+};
+
+namespace slab {
+template <class T>
+struct crust_ebco Iter :
+    Impl<Iter<T>, Trait<iter::Iterator, Tuple<Handle, Ref<T>>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  const collections::Slab<T> *slab;
+  bit_vec::IterOnes ones;
+
+public:
+  explicit Iter(const collections::Slab<T> &slab) :
+      slab{&slab}, ones{slab.occupied.iter_ones()} {}
+};
+} // namespace slab
+} // namespace crust
+
+
+#endif // CRUST_COLLECTIONS_SLAB_HPP
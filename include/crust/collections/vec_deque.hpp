@@ -0,0 +1,417 @@
+#ifndef CRUST_COLLECTIONS_VEC_DEQUE_HPP
+#define CRUST_COLLECTIONS_VEC_DEQUE_HPP
+
+
+#include <new>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/ops/mod.hpp"
+#include "crust/option.hpp"
+#include "crust/slice.hpp"
+#include "crust/tuple.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+namespace crust {
+namespace collections {
+template <class T, class A = alloc::Global>
+struct VecDeque;
+} // namespace collections
+
+namespace vec_deque {
+template <class T>
+struct Iter;
+} // namespace vec_deque
+
+namespace collections {
+/// double-ended queue on a ring buffer. the capacity is a power of two, so
+/// the physical index of an element is `(head + index) & (capacity - 1)'.
+template <class T, class A>
+struct crust_ebco VecDeque :
+    private A,
+    Impl<
+        VecDeque<T, A>,
+        Trait<index::Index, usize, T>,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<iter::FromIterator, T>> {
+private:
+  using Memory = _impl_vec::RawMemory<T>;
+
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  T *ptr;
+  usize head;
+  usize size;
+  usize cap;
+
+  A &allocator() { return *this; }
+
+  usize physical(usize index) const { return (head + index) & (cap - 1); }
+
+  /// elements in `[head, cap)', the rest wraps around to the front.
+  usize head_len() const { return size < cap - head ? size : cap - head; }
+
+  /// moves the elements to the front of a new buffer, in order.
+  void relocate(usize new_cap) {
+    T *next = Memory::allocate(allocator(), new_cap);
+    if (ptr != nullptr) {
+      usize first = head_len();
+      Memory::move_forward(next, ptr + head, first);
+      Memory::move_forward(next + first, ptr, size - first);
+      Memory::deallocate(allocator(), ptr, cap);
+    }
+    ptr = next;
+    head = 0;
+    cap = new_cap;
+  }
+
+public:
+  constexpr VecDeque() : A{}, ptr{nullptr}, head{0}, size{0}, cap{0} {}
+
+  explicit constexpr VecDeque(A alloc) :
+      A{alloc}, ptr{nullptr}, head{0}, size{0}, cap{0} {}
+
+  static VecDeque with_capacity(usize cap, A alloc = A{}) {
+    VecDeque ret{alloc};
+    ret.reserve(cap);
+    return ret;
+  }
+
+  VecDeque(const VecDeque &) = delete;
+
+  VecDeque(VecDeque &&other) noexcept :
+      A{other.allocator()},
+      ptr{other.ptr},
+      head{other.head},
+      size{other.size},
+      cap{other.cap} {
+    other.ptr = nullptr;
+    other.head = 0;
+    other.size = 0;
+    other.cap = 0;
+  }
+
+  VecDeque &operator=(const VecDeque &) = delete;
+
+  VecDeque &operator=(VecDeque &&other) noexcept {
+    if (this != &other) {
+      clear();
+      if (ptr != nullptr) {
+        Memory::deallocate(allocator(), ptr, cap);
+      }
+      allocator() = other.allocator();
+      ptr = other.ptr;
+      head = other.head;
+      size = other.size;
+      cap = other.cap;
+      other.ptr = nullptr;
+      other.head = 0;
+      other.size = 0;
+      other.cap = 0;
+    }
+    return *this;
+  }
+
+  const A &allocator() const { return *this; }
+
+  usize len() const { return size; }
+
+  usize capacity() const { return cap; }
+
+  bool is_empty() const { return size == 0; }
+
+  Option<Ref<T>> get(usize index) const {
+    if (index >= size) {
+      return None{};
+    }
+    return make_some(ref(ptr[physical(index)]));
+  }
+
+  Option<RefMut<T>> get_mut(usize index) {
+    if (index >= size) {
+      return None{};
+    }
+    return make_some(ref_mut(ptr[physical(index)]));
+  }
+
+  Option<Ref<T>> front() const { return get(0); }
+
+  Option<Ref<T>> back() const {
+    return size == 0 ? make_none<Ref<T>>() : get(size - 1);
+  }
+
+  /// reserves room for at least `additional' more elements, the capacity is
+  /// rounded up to a power of two.
+  void reserve(usize additional) {
+    if (cap - size >= additional) {
+      return;
+    }
+    usize new_cap = cap == 0 ? 4 : cap * 2;
+    while (new_cap < size + additional) {
+      new_cap *= 2;
+    }
+    relocate(new_cap);
+  }
+
+  void push_back(T value) {
+    if (size == cap) {
+      reserve(1);
+    }
+    ::new (ptr + physical(size)) T{move(value)};
+    ++size;
+  }
+
+  void push_front(T value) {
+    if (size == cap) {
+      reserve(1);
+    }
+    head = (head - 1) & (cap - 1);
+    ::new (ptr + head) T{move(value)};
+    ++size;
+  }
+
+  Option<T> pop_back() {
+    if (size == 0) {
+      return None{};
+    }
+    --size;
+    T *slot = ptr + physical(size);
+    T value{move(*slot)};
+    slot->~T();
+    return make_some(move(value));
+  }
+
+  Option<T> pop_front() {
+    if (size == 0) {
+      return None{};
+    }
+    T *slot = ptr + head;
+    T value{move(*slot)};
+    slot->~T();
+    head = (head + 1) & (cap - 1);
+    --size;
+    return make_some(move(value));
+  }
+
+  /// drops elements from the back until at most `len' are left.
+  void truncate(usize len) {
+    if (len >= size) {
+      return;
+    }
+    Tuple<Slice<T>, Slice<T>> slices = as_mut_slices();
+    Slice<T> &first = slices.template get<0>();
+    Slice<T> &second = slices.template get<1>();
+    if (len < first.len()) {
+      _impl_vec::drop_in_place(first.as_ptr() + len, first.len() - len);
+      _impl_vec::drop_in_place(second.as_ptr(), second.len());
+    } else {
+      usize kept = len - first.len();
+      _impl_vec::drop_in_place(second.as_ptr() + kept, second.len() - kept);
+    }
+    size = len;
+  }
+
+  void clear() {
+    truncate(0);
+    head = 0;
+  }
+
+  /// the elements in order, split where the buffer wraps around. the second
+  /// slice is empty if the elements are contiguous.
+  Tuple<Slice<const T>, Slice<const T>> as_slices() const {
+    usize first = head_len();
+    return tuple(
+        Slice<const T>::from_raw_parts(ptr + head, first),
+        Slice<const T>::from_raw_parts(ptr, size - first));
+  }
+
+  Tuple<Slice<T>, Slice<T>> as_mut_slices() {
+    usize first = head_len();
+    return tuple(
+        Slice<T>::from_raw_parts(ptr + head, first),
+        Slice<T>::from_raw_parts(ptr, size - first));
+  }
+
+  /// rearranges the elements so they form a single slice, without
+  /// allocating unless the free space is smaller than both wrapped parts.
+  Slice<T> make_contiguous() {
+    usize first = head_len();
+    usize second = size - first;
+    usize free = cap - size;
+    if (second == 0) {
+      return Slice<T>::from_raw_parts(ptr + head, size);
+    }
+    if (free >= first) {
+      Memory::move_backward(ptr + first, ptr, second);
+      Memory::move_forward(ptr, ptr + head, first);
+      head = 0;
+    } else if (free >= second) {
+      Memory::move_forward(ptr + head - second, ptr + head, first);
+      Memory::move_forward(ptr + cap - second, ptr, second);
+      head -= second;
+    } else {
+      relocate(cap);
+    }
+    return Slice<T>::from_raw_parts(ptr + head, size);
+  }
+
+  vec_deque::Iter<T> iter() const {
+    return vec_deque::Iter<T>{ptr, cap - 1, head, size};
+  }
+
+  ~VecDeque() {
+    truncate(0);
+    if (ptr != nullptr) {
+      Memory::deallocate(allocator(), ptr, cap);
+    }
+  }
+};
+} // namespace collections
+
+namespace vec_deque {
+template <class T>
+struct crust_ebco Iter :
+    Impl<
+        Iter<T>,
+        Trait<iter::Iterator, Ref<T>>,
+        Trait<iter::DoubleEndedIterator, Ref<T>>,
+        Trait<iter::ExactSizeIterator, Ref<T>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  template <class, class>
+  friend struct collections::VecDeque;
+
+  const T *ptr;
+  usize mask;
+  usize head;
+  usize remain;
+
+  Iter(const T *ptr, usize mask, usize head, usize remain) :
+      ptr{ptr}, mask{mask}, head{head}, remain{remain} {}
+};
+} // namespace vec_deque
+
+template <class T>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<vec_deque::Iter<T>, Ref<T>>)) {
+  CRUST_IMPL_USE_SELF(vec_deque::Iter<T>);
+
+  Option<Ref<T>> next() {
+    if (self().remain == 0) {
+      return None{};
+    }
+    const T &value = self().ptr[self().head];
+    self().head = (self().head + 1) & self().mask;
+    --self().remain;
+    return make_some(ref(value));
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    return tuple(self().remain, make_some(self().remain));
+  }
+};
+
+template <class T>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::DoubleEndedIterator<vec_deque::Iter<T>, Ref<T>>)) {
+  CRUST_IMPL_USE_SELF(vec_deque::Iter<T>);
+
+  Option<Ref<T>> next_back() {
+    if (self().remain == 0) {
+      return None{};
+    }
+    --self().remain;
+    return make_some(
+        ref(self().ptr[(self().head + self().remain) & self().mask]));
+  }
+};
+
+template <class T>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::ExactSizeIterator<vec_deque::Iter<T>, Ref<T>>)){};
+
+template <class T, class A>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(index::Index<collections::VecDeque<T, A>, usize, T>)) {
+  CRUST_IMPL_USE_SELF(collections::VecDeque<T, A>);
+
+  const T &index(usize index) const {
+    if (index >= self().len()) {
+      crust_panic("index out of boundary!");
+    }
+    return self().ptr[self().physical(index)];
+  }
+
+  T &index_mut(usize index) {
+    if (index >= self().len()) {
+      crust_panic("index_mut out of boundary!");
+    }
+    return self().ptr[self().physical(index)];
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(clone::Clone<collections::VecDeque<T, A>>)) {
+  CRUST_IMPL_USE_SELF(collections::VecDeque<T, A>);
+
+  Self clone() const {
+    Self ret = Self::with_capacity(self().len(), self().allocator());
+    for (usize i = 0; i < self().len(); ++i) {
+      ::new (ret.ptr + i) T{_impl_clone::clone_of(self()[i])};
+    }
+    ret.size = self().len();
+    return ret;
+  }
+
+  void clone_from(const Self &other) { self() = other.clone(); }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialEq<collections::VecDeque<T, A>>)) {
+  CRUST_IMPL_USE_SELF(collections::VecDeque<T, A>);
+
+  bool eq(const Self &other) const {
+    if (self().len() != other.len()) {
+      return false;
+    }
+    for (usize i = 0; i < self().len(); ++i) {
+      if (!(self()[i] == other[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Eq<collections::VecDeque<T, A>>)){};
+
+template <class T, class A>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::FromIterator<collections::VecDeque<T, A>, T>)) {
+  CRUST_IMPL_USE_SELF(collections::VecDeque<T, A>);
+
+  template <class I>
+  static Self from_iter(I &&iter) {
+    Self ret = Self::with_capacity(iter.size_hint().template get<0>());
+    while (true) {
+      auto x = iter.next();
+      if (x.is_none()) {
+        return ret;
+      }
+      ret.push_back(move(x).unwrap());
+    }
+  }
+};
+} // namespace crust
+
+
+#endif // CRUST_COLLECTIONS_VEC_DEQUE_HPP
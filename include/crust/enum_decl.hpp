@@ -163,27 +163,39 @@ struct EnumGetter;
 
 template <isize index, class Field, class... Fields>
 struct EnumGetter<index, Field, Fields...> {
-  using Self = EnumHolder<Field, Fields...>;
   using Result = typename _impl_types::
       TypesIndex<index, _impl_types::Types<Field, Fields...>>::Result;
 
-  static constexpr const Result &inner(const Self &self) {
+  /// the flag is inherited from the outermost holder, so inner holders may
+  /// differ from `EnumHolder<Fields...>'.
+  template <bool trivial>
+  static constexpr const Result &
+  inner(const EnumHolderImpl<trivial, Field, Fields...> &self) {
     return EnumGetter<index - 1, Fields...>::inner(self.remains);
   }
 
-  static constexpr Result &inner(Self &self) {
+  template <bool trivial>
+  static constexpr Result &
+  inner(EnumHolderImpl<trivial, Field, Fields...> &self) {
     return EnumGetter<index - 1, Fields...>::inner(self.remains);
   }
 };
 
 template <class Field, class... Fields>
 struct EnumGetter<0, Field, Fields...> {
-  using Self = EnumHolder<Field, Fields...>;
   using Result = Field;
 
-  static constexpr const Result &inner(const Self &self) { return self.field; }
+  template <bool trivial>
+  static constexpr const Result &
+  inner(const EnumHolderImpl<trivial, Field, Fields...> &self) {
+    return self.field;
+  }
 
-  static constexpr Result &inner(Self &self) { return self.field; }
+  template <bool trivial>
+  static constexpr Result &
+  inner(EnumHolderImpl<trivial, Field, Fields...> &self) {
+    return self.field;
+  }
 };
 
 template <class Self, isize offset, isize size, class... Fields>
@@ -6,19 +6,32 @@
 
 
 namespace crust {
+struct Str;
+
 namespace fmt {
-struct Formatter {};
+/// type erased sink that formatted output is written into.
+struct Formatter {
+private:
+  void *sink;
+  bool (*write)(void *, const u8 *, usize);
+
+public:
+  Formatter(void *sink, bool (*write)(void *, const u8 *, usize)) :
+      sink{sink}, write{write} {}
+
+  bool write_str(Str str);
+};
 
 CRUST_TRAIT(Debug) {
   CRUST_TRAIT_USE_SELF(Debug);
 
-  bool fmt_debug(Formatter & fmt);
+  bool fmt_debug(Formatter & fmt) const;
 };
 
 CRUST_TRAIT(Display) {
   CRUST_TRAIT_USE_SELF(Display);
 
-  bool fmt_display(Formatter & fmt);
+  bool fmt_display(Formatter & fmt) const;
 };
 } // namespace fmt
 } // namespace crust
@@ -0,0 +1,184 @@
+#ifndef CRUST_HASH_MOD_HPP
+#define CRUST_HASH_MOD_HPP
+
+
+#include <cstring>
+
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace hash {
+/// feeds the value into a hasher through `write' and the `write_*' helpers
+/// of `DefaultHasher'. equal values must produce equal hashes.
+CRUST_TRAIT(Hash) {
+  CRUST_TRAIT_USE_SELF(Hash);
+
+  template <class H>
+  void hash(H & state) const;
+};
+} // namespace hash
+
+namespace _impl_hash {
+constexpr u64 MULTIPLE = 0x5851F42D4C957F2Dull;
+constexpr u64 FINISH = 0x9E3779B97F4A7C15ull;
+
+/// high and low half of the full 128 bit product folded together.
+crust_always_inline u64 folded_multiply(u64 a, u64 b) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t full = static_cast<__uint128_t>(a) * b;
+  return static_cast<u64>(full) ^ static_cast<u64>(full >> 64);
+#else
+  u64 a_low = a & 0xFFFFFFFFull;
+  u64 a_high = a >> 32;
+  u64 b_low = b & 0xFFFFFFFFull;
+  u64 b_high = b >> 32;
+  u64 low = a_low * b_low;
+  u64 middle_a = a_high * b_low;
+  u64 middle_b = a_low * b_high;
+  u64 high = a_high * b_high;
+  u64 carry =
+      ((low >> 32) + (middle_a & 0xFFFFFFFFull) + (middle_b & 0xFFFFFFFFull)) >>
+      32;
+  high += (middle_a >> 32) + (middle_b >> 32) + carry;
+  low += (middle_a << 32) + (middle_b << 32);
+  return low ^ high;
+#endif
+}
+
+crust_always_inline u64 read_u64(const u8 *ptr) {
+  u64 value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+} // namespace _impl_hash
+
+namespace hash {
+/// fast non-cryptographic hasher, one folded multiply per word. resistance
+/// against crafted keys comes from the random seed of `RandomState'.
+struct DefaultHasher {
+private:
+  u64 state;
+
+public:
+  explicit constexpr DefaultHasher(u64 seed = 0) : state{seed} {}
+
+  void write_u64(u64 value) {
+    state = _impl_hash::folded_multiply(state ^ value, _impl_hash::MULTIPLE);
+  }
+
+  void write_u8(u8 value) { write_u64(value); }
+
+  void write_u16(u16 value) { write_u64(value); }
+
+  void write_u32(u32 value) { write_u64(value); }
+
+  void write_usize(usize value) { write_u64(value); }
+
+  void write(const u8 *ptr, usize len) {
+    write_u64(len);
+    for (; len >= 8; ptr += 8, len -= 8) {
+      write_u64(_impl_hash::read_u64(ptr));
+    }
+    if (len != 0) {
+      u64 tail = 0;
+      std::memcpy(&tail, ptr, len);
+      write_u64(tail);
+    }
+  }
+
+  u64 finish() const {
+    return _impl_hash::folded_multiply(state, _impl_hash::FINISH);
+  }
+};
+
+/// hasher factory with a seed that differs between instances, so the
+/// iteration order and collisions of one map do not carry over to another.
+struct RandomState {
+private:
+  u64 seed;
+
+  static u64 next_seed() {
+    static thread_local u64 counter = 0;
+    u64 base = static_cast<u64>(reinterpret_cast<usize>(&counter));
+    return _impl_hash::folded_multiply(
+        base ^ ++counter, _impl_hash::MULTIPLE);
+  }
+
+public:
+  RandomState() : seed{next_seed()} {}
+
+  DefaultHasher build_hasher() const { return DefaultHasher{seed}; }
+};
+
+/// hasher factory creating `H{}', for deterministic hashing.
+template <class H>
+struct BuildHasherDefault {
+  H build_hasher() const { return H{}; }
+};
+} // namespace hash
+
+/// like `operator_cmp', dispatches to `Hash::hash' or to the primitive
+/// overloads below.
+template <class T, class H>
+crust_always_inline void operator_hash(const T &value, H &state) {
+  value.hash(state);
+}
+
+#define _IMPL_OPERATOR_HASH(type)                                              \
+  template <class H>                                                           \
+  crust_always_inline void operator_hash(const type &value, H &state) {        \
+    state.write_u64(static_cast<u64>(value));                                  \
+  }
+
+_IMPL_OPERATOR_HASH(bool);
+_IMPL_OPERATOR_HASH(char);
+_IMPL_OPERATOR_HASH(u8);
+_IMPL_OPERATOR_HASH(i8);
+_IMPL_OPERATOR_HASH(u16);
+_IMPL_OPERATOR_HASH(i16);
+_IMPL_OPERATOR_HASH(u32);
+_IMPL_OPERATOR_HASH(i32);
+_IMPL_OPERATOR_HASH(u64);
+_IMPL_OPERATOR_HASH(i64);
+
+#undef _IMPL_OPERATOR_HASH
+
+template <class T, class H>
+crust_always_inline void operator_hash(T *const &value, H &state) {
+  state.write_usize(reinterpret_cast<usize>(value));
+}
+
+#define _DERIVE_PRIMITIVE(PRIMITIVE)                                           \
+  template <>                                                                  \
+  struct Require<PRIMITIVE, hash::Hash> : BoolVal<true> {}
+
+_DERIVE_PRIMITIVE(bool);
+_DERIVE_PRIMITIVE(char);
+_DERIVE_PRIMITIVE(u8);
+_DERIVE_PRIMITIVE(i8);
+_DERIVE_PRIMITIVE(u16);
+_DERIVE_PRIMITIVE(i16);
+_DERIVE_PRIMITIVE(u32);
+_DERIVE_PRIMITIVE(i32);
+_DERIVE_PRIMITIVE(u64);
+_DERIVE_PRIMITIVE(i64);
+
+#undef _DERIVE_PRIMITIVE
+
+template <class T>
+struct Require<T *, hash::Hash> : BoolVal<true> {};
+
+namespace hash {
+/// hashes a single value with a hasher from `builder'.
+template <class S, class T>
+u64 hash_one(const S &builder, const T &value) {
+  auto state = builder.build_hasher();
+  operator_hash(value, state);
+  return state.finish();
+}
+} // namespace hash
+} // namespace crust
+
+
+#endif // CRUST_HASH_MOD_HPP
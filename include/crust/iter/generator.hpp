@@ -0,0 +1,117 @@
+#ifndef CRUST_ITER_GENERATOR_HPP
+#define CRUST_ITER_GENERATOR_HPP
+
+
+#if defined(__cpp_impl_coroutine)
+
+
+#include <coroutine>
+#include <cstddef>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/option.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace iter {
+/// coroutine backed iterator, `co_yield' produces the next element.
+template <class T>
+struct crust_ebco Generator : Impl<Generator<T>, Trait<Iterator, T>> {
+  struct promise_type {
+    Option<T> value;
+
+    promise_type() : value{None{}} {}
+
+    Generator get_return_object() {
+      return Generator{
+          std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    std::suspend_always final_suspend() noexcept { return {}; }
+
+    std::suspend_always yield_value(T value) {
+      this->value = make_some(move(value));
+      return {};
+    }
+
+    void return_void() {}
+
+    void unhandled_exception() { crust_panic("exception in generator!"); }
+
+    /// frames freed by a finished generator are handed to the next one of
+    /// similar size instead of going back to the global allocator.
+    static void *operator new(usize size) {
+      return alloc::ThreadCache{}.allocate(size, alignof(std::max_align_t));
+    }
+
+    static void operator delete(void *ptr, usize size) {
+      alloc::ThreadCache{}.deallocate(ptr, size, alignof(std::max_align_t));
+    }
+  };
+
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  std::coroutine_handle<promise_type> handle;
+
+  explicit Generator(std::coroutine_handle<promise_type> handle) :
+      handle{handle} {}
+
+  void drop() {
+    if (handle) {
+      handle.destroy();
+      handle = nullptr;
+    }
+  }
+
+public:
+  Generator(const Generator &) = delete;
+
+  Generator(Generator &&other) noexcept : handle{other.handle} {
+    other.handle = nullptr;
+  }
+
+  Generator &operator=(const Generator &) = delete;
+
+  Generator &operator=(Generator &&other) noexcept {
+    if (this != &other) {
+      drop();
+      handle = other.handle;
+      other.handle = nullptr;
+    }
+
+    return *this;
+  }
+
+  ~Generator() { drop(); }
+};
+} // namespace iter
+
+template <class T>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<iter::Generator<T>, T>)) {
+  CRUST_IMPL_USE_SELF(iter::Generator<T>);
+
+  Option<T> next() {
+    auto &handle = self().handle;
+    if (!handle || handle.done()) {
+      return None{};
+    }
+    handle.resume();
+    if (handle.done()) {
+      return None{};
+    }
+    return handle.promise().value.take();
+  }
+};
+} // namespace crust
+
+
+#endif
+
+
+#endif // CRUST_ITER_GENERATOR_HPP
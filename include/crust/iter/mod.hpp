@@ -2,14 +2,251 @@
 #define CRUST_ITER_MOD_HPP
 
 
+#include <new>
+
 #include "crust/enum.hpp"
+#include "crust/ops/mod.hpp"
 #include "crust/option.hpp"
+#include "crust/result.hpp"
 #include "crust/tuple.hpp"
 #include "crust/utility.hpp"
 
 
 namespace crust {
 namespace iter {
+CRUST_TRAIT(Iterator, class Item);
+
+CRUST_TRAIT(DoubleEndedIterator, class Item);
+
+CRUST_TRAIT(ExactSizeIterator, class Item);
+
+CRUST_TRAIT(TrustedLen, class Item);
+
+CRUST_TRAIT(FromIterator, class Item);
+
+template <class I>
+struct Rev;
+
+template <class A, class B>
+struct Zip;
+
+template <class I>
+struct Enumerate;
+
+template <class I, usize N>
+struct Chunked;
+
+/// inline buffer of at most `N' elements, produced by `next_chunk'.
+template <class T, usize N>
+struct crust_ebco ArrayChunk :
+    Impl<ArrayChunk<T, N>, Trait<index::Index, usize, T>> {
+private:
+  crust_static_assert(N > 0);
+
+  union {
+    T inner[N];
+  };
+  usize size;
+
+  void drop() {
+    for (usize i = 0; i < size; ++i) {
+      inner[i].~T();
+    }
+    size = 0;
+  }
+
+public:
+  ArrayChunk() : size{0} {}
+
+  ArrayChunk(const ArrayChunk &) = delete;
+
+  ArrayChunk(ArrayChunk &&other) noexcept : size{0} {
+    for (; size < other.size; ++size) {
+      ::new (&inner[size]) T{move(other.inner[size])};
+    }
+    other.drop();
+  }
+
+  ArrayChunk &operator=(const ArrayChunk &) = delete;
+
+  ArrayChunk &operator=(ArrayChunk &&other) noexcept {
+    if (this != &other) {
+      drop();
+      for (; size < other.size; ++size) {
+        ::new (&inner[size]) T{move(other.inner[size])};
+      }
+      other.drop();
+    }
+
+    return *this;
+  }
+
+  ~ArrayChunk() { drop(); }
+
+  /// caller guarantees the chunk is not full.
+  void push_unchecked(T &&value) {
+    crust_debug_assert(size < N);
+    ::new (&inner[size++]) T{move(value)};
+  }
+
+  usize len() const { return size; }
+
+  bool is_empty() const { return size == 0; }
+
+  bool is_full() const { return size == N; }
+
+  const T *as_ptr() const { return inner; }
+
+  T *as_ptr() { return inner; }
+};
+
+namespace _impl_iter {
+template <class Self, class Item>
+TmplType<Item> item_of(const Iterator<Self, Item> *);
+} // namespace _impl_iter
+
+/// `Item' type of an iterator, deduced from its `Iterator' implementation.
+template <class I>
+struct IterItem :
+    decltype(_impl_iter::item_of(static_cast<const I *>(nullptr))) {};
+
+namespace _impl_iter {
+template <class T, class E>
+TmplType<T> ok_of(const Result<T, E> *);
+
+template <class I, usize N>
+using NextChunkResult =
+    decltype(static_cast<I *>(nullptr)->template next_chunk<N>());
+} // namespace _impl_iter
+
+/// block type handed out by `I::next_chunk<N>', `ArrayChunk' unless the
+/// iterator can expose its storage directly.
+template <class I, usize N>
+struct ChunkOf :
+    decltype(_impl_iter::ok_of(
+        static_cast<const _impl_iter::NextChunkResult<I, N> *>(nullptr))) {};
+
+namespace _impl_iter {
+template <class I>
+crust_always_inline usize exact_len(const I &iter) {
+  return iter.size_hint().template get<0>();
+}
+
+template <bool trusted>
+struct Fold;
+
+template <>
+struct Fold<false> {
+  template <class I, class B, class F>
+  static B fold(I &iter, B &&init, const F &f) {
+    B accum = forward<B>(init);
+
+    while (true) {
+      auto x = iter.next();
+      if (x.is_none()) {
+        return accum;
+      }
+      accum = f(move(accum), move(x).unwrap());
+    }
+  }
+
+  template <class I, class B, class F>
+  static B rfold(I &iter, B &&init, const F &f) {
+    B accum = forward<B>(init);
+
+    while (true) {
+      auto x = iter.next_back();
+      if (x.is_none()) {
+        return accum;
+      }
+      accum = f(move(accum), move(x).unwrap());
+    }
+  }
+};
+
+/// length of a `TrustedLen' iterator is known before the loop, so the loop
+/// is counted and no per element `None' check is emitted.
+template <>
+struct Fold<true> {
+  template <class I, class B, class F>
+  static B fold(I &iter, B &&init, const F &f) {
+    B accum = forward<B>(init);
+
+    for (usize n = exact_len(iter); n != 0; --n) {
+      accum = f(move(accum), iter.next_unchecked());
+    }
+
+    return accum;
+  }
+
+  template <class I, class B, class F>
+  static B rfold(I &iter, B &&init, const F &f) {
+    B accum = forward<B>(init);
+
+    for (usize n = exact_len(iter); n != 0; --n) {
+      accum = f(move(accum), iter.next_back_unchecked());
+    }
+
+    return accum;
+  }
+};
+
+template <bool trusted>
+struct NextChunk;
+
+template <>
+struct NextChunk<false> {
+  template <usize N, class I, class Item = typename IterItem<I>::Result>
+  static Result<ArrayChunk<Item, N>, ArrayChunk<Item, N>> next_chunk(I &iter) {
+    ArrayChunk<Item, N> chunk;
+
+    for (usize i = 0; i < N; ++i) {
+      auto x = iter.next();
+      if (x.is_none()) {
+        return Err<ArrayChunk<Item, N>>{move(chunk)};
+      }
+      chunk.push_unchecked(move(x).unwrap());
+    }
+
+    return Ok<ArrayChunk<Item, N>>{move(chunk)};
+  }
+};
+
+/// `TrustedLen' iterators check the remaining length once per chunk.
+template <>
+struct NextChunk<true> {
+  template <usize N, class I, class Item = typename IterItem<I>::Result>
+  static Result<ArrayChunk<Item, N>, ArrayChunk<Item, N>> next_chunk(I &iter) {
+    ArrayChunk<Item, N> chunk;
+    usize len = exact_len(iter);
+
+    for (usize i = 0, n = len < N ? len : N; i < n; ++i) {
+      chunk.push_unchecked(iter.next_unchecked());
+    }
+
+    if (chunk.is_full()) {
+      return Ok<ArrayChunk<Item, N>>{move(chunk)};
+    } else {
+      return Err<ArrayChunk<Item, N>>{move(chunk)};
+    }
+  }
+};
+
+inline Option<usize>
+min_upper(const Option<usize> &a, const Option<usize> &b) {
+  return a.visit<Option<usize>>(
+      [&](const Some<usize> &x) {
+        return b.visit<Option<usize>>(
+            [&](const Some<usize> &y) {
+              return make_some(
+                  x.get<0>() < y.get<0>() ? x.get<0>() : y.get<0>());
+            },
+            [&](const None &) { return a; });
+      },
+      [&](const None &) { return b; });
+}
+} // namespace _impl_iter
+
 CRUST_TRAIT(Iterator, class Item) {
   CRUST_TRAIT_USE_SELF(Iterator);
 
@@ -21,17 +258,497 @@ CRUST_TRAIT(Iterator, class Item) {
 
   template <class B, class F>
   B fold(B && init, ops::Fn<F, B(B &&, Item &&)> f) {
-    B accum = forward(init);
+    return _impl_iter::Fold<Require<Self, TrustedLen, Item>::result>::fold(
+        *static_cast<Self *>(this), forward<B>(init), f);
+  }
 
-    Item x;
-    while ((let<Some<Item>>(x) = self().next())) {
-      accum = f(move(accum), move(x));
-    }
+  Rev<Self> rev() && { return Rev<Self>{move(*static_cast<Self *>(this))}; }
 
-    return accum;
+  template <class U>
+  Zip<Self, typename RemoveConstOrRefType<U>::Result> zip(U && other) && {
+    return Zip<Self, typename RemoveConstOrRefType<U>::Result>{
+        move(*static_cast<Self *>(this)), forward<U>(other)};
+  }
+
+  Enumerate<Self> enumerate() && {
+    return Enumerate<Self>{move(*static_cast<Self *>(this))};
+  }
+
+  /// take the next `N' elements, `Err' holds the partial tail if the
+  /// iterator ran out first. generic iterators fall back to `N' calls of
+  /// `next', contiguous iterators override this to hand out their storage.
+  template <usize N>
+  Result<ArrayChunk<Item, N>, ArrayChunk<Item, N>> next_chunk() {
+    return _impl_iter::NextChunk<Require<Self, TrustedLen, Item>::result>::
+        template next_chunk<N>(*static_cast<Self *>(this));
+  }
+
+  template <usize N>
+  Chunked<Self, N> chunked() && {
+    return Chunked<Self, N>{move(*static_cast<Self *>(this))};
+  }
+
+  template <class B>
+  B collect() && {
+    return ImplFor<FromIterator<B, Item>>::from_iter(
+        move(*static_cast<Self *>(this)));
+  }
+};
+
+CRUST_TRAIT(DoubleEndedIterator, class Item) {
+  CRUST_TRAIT_USE_SELF(DoubleEndedIterator, Require<Self, Iterator, Item>);
+
+  Option<Item> next_back();
+
+  template <class B, class F>
+  B rfold(B && init, ops::Fn<F, B(B &&, Item &&)> f) {
+    return _impl_iter::Fold<Require<Self, TrustedLen, Item>::result>::rfold(
+        *static_cast<Self *>(this), forward<B>(init), f);
   }
 };
+
+CRUST_TRAIT(ExactSizeIterator, class Item) {
+  CRUST_TRAIT_USE_SELF(ExactSizeIterator, Require<Self, Iterator, Item>);
+
+  usize len() const {
+    auto hint = self<Iterator<Self, Item>>().size_hint();
+    crust_debug_assert(
+        hint.template get<1>().contains(hint.template get<0>()));
+    return hint.template get<0>();
+  }
+
+  bool is_empty() const { return self().len() == 0; }
+};
+
+/// marker for iterators whose `size_hint' is exact. `next_unchecked' and
+/// `next_back_unchecked' may be called as many times in total as the lower
+/// bound reports without checking for exhaustion, which lets adapters and
+/// consumers drop their per element bound and capacity checks.
+CRUST_TRAIT(TrustedLen, class Item) {
+  CRUST_TRAIT_USE_SELF(TrustedLen, Require<Self, Iterator, Item>);
+
+  Item next_unchecked();
+
+  Item next_back_unchecked();
+};
+
+CRUST_TRAIT(FromIterator, class Item) {
+  CRUST_TRAIT_USE_SELF(FromIterator);
+
+  template <class I>
+  static Self from_iter(I && iter);
+};
+
+template <class I>
+struct crust_ebco Rev :
+    Impl<
+        Rev<I>,
+        Trait<Iterator, typename IterItem<I>::Result>,
+        Trait<DoubleEndedIterator, typename IterItem<I>::Result>,
+        Trait<ExactSizeIterator, typename IterItem<I>::Result>,
+        Trait<TrustedLen, typename IterItem<I>::Result>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  I iter;
+
+public:
+  explicit Rev(I &&iter) : iter{move(iter)} {}
+};
+
+template <class A, class B>
+struct crust_ebco Zip :
+    Impl<
+        Zip<A, B>,
+        Trait<
+            Iterator,
+            Tuple<
+                typename IterItem<A>::Result,
+                typename IterItem<B>::Result>>,
+        Trait<
+            DoubleEndedIterator,
+            Tuple<
+                typename IterItem<A>::Result,
+                typename IterItem<B>::Result>>,
+        Trait<
+            ExactSizeIterator,
+            Tuple<
+                typename IterItem<A>::Result,
+                typename IterItem<B>::Result>>,
+        Trait<
+            TrustedLen,
+            Tuple<
+                typename IterItem<A>::Result,
+                typename IterItem<B>::Result>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  A a;
+  B b;
+  /// both sides advance together once their lengths match, so they are
+  /// only measured before the first element taken from the back.
+  bool trimmed;
+
+  /// drop elements from the back of the longer side so both sides have the
+  /// same length, required before taking elements from the back.
+  void trim() {
+    if (trimmed) {
+      return;
+    }
+    trimmed = true;
+    usize a_len = _impl_iter::exact_len(a);
+    usize b_len = _impl_iter::exact_len(b);
+    for (; a_len > b_len; --a_len) {
+      a.next_back();
+    }
+    for (; b_len > a_len; --b_len) {
+      b.next_back();
+    }
+  }
+
+public:
+  Zip(A &&a, B &&b) : a{move(a)}, b{move(b)}, trimmed{false} {}
+};
+
+template <class I>
+struct crust_ebco Enumerate :
+    Impl<
+        Enumerate<I>,
+        Trait<Iterator, Tuple<usize, typename IterItem<I>::Result>>,
+        Trait<DoubleEndedIterator, Tuple<usize, typename IterItem<I>::Result>>,
+        Trait<ExactSizeIterator, Tuple<usize, typename IterItem<I>::Result>>,
+        Trait<TrustedLen, Tuple<usize, typename IterItem<I>::Result>>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  I iter;
+  usize count;
+
+public:
+  explicit Enumerate(I &&iter) : iter{move(iter)}, count{0} {}
+};
+
+/// yields whole blocks of `N' elements, the trailing partial block is kept
+/// aside and can be taken with `remainder'.
+template <class I, usize N>
+struct crust_ebco Chunked :
+    Impl<Chunked<I, N>, Trait<Iterator, typename ChunkOf<I, N>::Result>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  using Chunk = typename ChunkOf<I, N>::Result;
+
+  I iter;
+  Option<Chunk> tail;
+
+public:
+  explicit Chunked(I &&iter) : iter{move(iter)}, tail{None{}} {}
+
+  Option<Chunk> remainder() { return tail.take(); }
+};
 } // namespace iter
+
+template <class T, usize N>
+CRUST_IMPL_FOR(CRUST_MACRO(index::Index<iter::ArrayChunk<T, N>, usize, T>)) {
+  CRUST_IMPL_USE_SELF(iter::ArrayChunk<T, N>);
+
+  const T &index(usize index) const {
+    if (index >= self().len()) {
+      crust_panic("index out of boundary!");
+    }
+    return self().as_ptr()[index];
+  }
+
+  T &index_mut(usize index) {
+    if (index >= self().len()) {
+      crust_panic("index_mut out of boundary!");
+    }
+    return self().as_ptr()[index];
+  }
+};
+
+template <class I, usize N>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<
+                           iter::Chunked<I, N>,
+                           typename iter::ChunkOf<I, N>::Result>)) {
+  CRUST_IMPL_USE_SELF(iter::Chunked<I, N>);
+
+  using Item = typename iter::ChunkOf<I, N>::Result;
+
+  Option<Item> next() {
+    auto chunk = self().iter.template next_chunk<N>();
+    if (chunk.is_err()) {
+      if (self().tail.is_none()) {
+        self().tail = move(chunk).err();
+      }
+      return None{};
+    }
+    return move(chunk).ok();
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    auto hint = self().iter.size_hint();
+    return tuple(
+        hint.template get<0>() / N,
+        hint.template get<1>().map(
+            ops::bind([](const usize &upper) { return upper / N; })));
+  }
+
+  template <class B, class F>
+  B fold(B &&init, ops::Fn<F, B(B &&, Item &&)> f) {
+    B accum = forward<B>(init);
+
+    while (true) {
+      auto chunk = self().iter.template next_chunk<N>();
+      if (chunk.is_err()) {
+        if (self().tail.is_none()) {
+          self().tail = move(chunk).err();
+        }
+        return accum;
+      }
+      accum = f(move(accum), move(chunk).unwrap());
+    }
+  }
+};
+
+template <class I>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(
+        iter::Iterator<iter::Rev<I>, typename iter::IterItem<I>::Result>),
+    Require<I, iter::DoubleEndedIterator, typename iter::IterItem<I>::Result>) {
+  CRUST_IMPL_USE_SELF(iter::Rev<I>);
+
+  using Item = typename iter::IterItem<I>::Result;
+
+  Option<Item> next() { return self().iter.next_back(); }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    return self().iter.size_hint();
+  }
+
+  template <class B, class F>
+  B fold(B &&init, ops::Fn<F, B(B &&, Item &&)> f) {
+    return self().iter.rfold(forward<B>(init), f);
+  }
+};
+
+template <class I>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::DoubleEndedIterator<
+                iter::Rev<I>,
+                typename iter::IterItem<I>::Result>),
+    Require<I, iter::DoubleEndedIterator, typename iter::IterItem<I>::Result>) {
+  CRUST_IMPL_USE_SELF(iter::Rev<I>);
+
+  using Item = typename iter::IterItem<I>::Result;
+
+  Option<Item> next_back() { return self().iter.next(); }
+
+  template <class B, class F>
+  B rfold(B &&init, ops::Fn<F, B(B &&, Item &&)> f) {
+    return self().iter.fold(forward<B>(init), f);
+  }
+};
+
+template <class I>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::ExactSizeIterator<
+                iter::Rev<I>,
+                typename iter::IterItem<I>::Result>),
+    Require<I, iter::DoubleEndedIterator, typename iter::IterItem<I>::Result>,
+    Require<I, iter::ExactSizeIterator, typename iter::IterItem<I>::Result>){};
+
+template <class I>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(
+        iter::TrustedLen<iter::Rev<I>, typename iter::IterItem<I>::Result>),
+    Require<I, iter::DoubleEndedIterator, typename iter::IterItem<I>::Result>,
+    Require<I, iter::TrustedLen, typename iter::IterItem<I>::Result>) {
+  CRUST_IMPL_USE_SELF(iter::Rev<I>);
+
+  using Item = typename iter::IterItem<I>::Result;
+
+  Item next_unchecked() { return self().iter.next_back_unchecked(); }
+
+  Item next_back_unchecked() { return self().iter.next_unchecked(); }
+};
+
+template <class A, class B>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<
+                           iter::Zip<A, B>,
+                           Tuple<
+                               typename iter::IterItem<A>::Result,
+                               typename iter::IterItem<B>::Result>>)) {
+  CRUST_IMPL_USE_SELF(iter::Zip<A, B>);
+
+  using Item = Tuple<
+      typename iter::IterItem<A>::Result,
+      typename iter::IterItem<B>::Result>;
+
+  Option<Item> next() {
+    auto a = self().a.next();
+    if (a.is_none()) {
+      return None{};
+    }
+    auto b = self().b.next();
+    if (b.is_none()) {
+      return None{};
+    }
+    return make_some(tuple(move(a).unwrap(), move(b).unwrap()));
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    auto a = self().a.size_hint();
+    auto b = self().b.size_hint();
+    usize lower = a.template get<0>() < b.template get<0>() ?
+        a.template get<0>() :
+        b.template get<0>();
+    return tuple(
+        lower,
+        iter::_impl_iter::min_upper(a.template get<1>(), b.template get<1>()));
+  }
+};
+
+template <class A, class B>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::DoubleEndedIterator<
+                iter::Zip<A, B>,
+                Tuple<
+                    typename iter::IterItem<A>::Result,
+                    typename iter::IterItem<B>::Result>>),
+    Require<A, iter::DoubleEndedIterator, typename iter::IterItem<A>::Result>,
+    Require<A, iter::ExactSizeIterator, typename iter::IterItem<A>::Result>,
+    Require<B, iter::DoubleEndedIterator, typename iter::IterItem<B>::Result>,
+    Require<B, iter::ExactSizeIterator, typename iter::IterItem<B>::Result>) {
+  CRUST_IMPL_USE_SELF(iter::Zip<A, B>);
+
+  using Item = Tuple<
+      typename iter::IterItem<A>::Result,
+      typename iter::IterItem<B>::Result>;
+
+  Option<Item> next_back() {
+    self().trim();
+    auto a = self().a.next_back();
+    if (a.is_none()) {
+      return None{};
+    }
+    auto b = self().b.next_back();
+    if (b.is_none()) {
+      return None{};
+    }
+    return make_some(tuple(move(a).unwrap(), move(b).unwrap()));
+  }
+};
+
+template <class A, class B>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::ExactSizeIterator<
+                iter::Zip<A, B>,
+                Tuple<
+                    typename iter::IterItem<A>::Result,
+                    typename iter::IterItem<B>::Result>>),
+    Require<A, iter::ExactSizeIterator, typename iter::IterItem<A>::Result>,
+    Require<B, iter::ExactSizeIterator, typename iter::IterItem<B>::Result>){};
+
+template <class A, class B>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::TrustedLen<
+                iter::Zip<A, B>,
+                Tuple<
+                    typename iter::IterItem<A>::Result,
+                    typename iter::IterItem<B>::Result>>),
+    Require<A, iter::TrustedLen, typename iter::IterItem<A>::Result>,
+    Require<B, iter::TrustedLen, typename iter::IterItem<B>::Result>) {
+  CRUST_IMPL_USE_SELF(iter::Zip<A, B>);
+
+  using Item = Tuple<
+      typename iter::IterItem<A>::Result,
+      typename iter::IterItem<B>::Result>;
+
+  Item next_unchecked() {
+    auto a = self().a.next_unchecked();
+    return Item{move(a), self().b.next_unchecked()};
+  }
+
+  Item next_back_unchecked() {
+    self().trim();
+    auto a = self().a.next_back_unchecked();
+    return Item{move(a), self().b.next_back_unchecked()};
+  }
+};
+
+template <class I>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<
+                           iter::Enumerate<I>,
+                           Tuple<usize, typename iter::IterItem<I>::Result>>)) {
+  CRUST_IMPL_USE_SELF(iter::Enumerate<I>);
+
+  using Item = Tuple<usize, typename iter::IterItem<I>::Result>;
+
+  Option<Item> next() {
+    auto x = self().iter.next();
+    if (x.is_none()) {
+      return None{};
+    }
+    return make_some(Item{self().count++, move(x).unwrap()});
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    return self().iter.size_hint();
+  }
+};
+
+template <class I>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::DoubleEndedIterator<
+                iter::Enumerate<I>,
+                Tuple<usize, typename iter::IterItem<I>::Result>>),
+    Require<I, iter::DoubleEndedIterator, typename iter::IterItem<I>::Result>,
+    Require<I, iter::ExactSizeIterator, typename iter::IterItem<I>::Result>) {
+  CRUST_IMPL_USE_SELF(iter::Enumerate<I>);
+
+  using Item = Tuple<usize, typename iter::IterItem<I>::Result>;
+
+  Option<Item> next_back() {
+    auto x = self().iter.next_back();
+    if (x.is_none()) {
+      return None{};
+    }
+    return make_some(Item{self().count + self().iter.len(), move(x).unwrap()});
+  }
+};
+
+template <class I>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::ExactSizeIterator<
+                iter::Enumerate<I>,
+                Tuple<usize, typename iter::IterItem<I>::Result>>),
+    Require<I, iter::ExactSizeIterator, typename iter::IterItem<I>::Result>){};
+
+template <class I>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::TrustedLen<
+                iter::Enumerate<I>,
+                Tuple<usize, typename iter::IterItem<I>::Result>>),
+    Require<I, iter::TrustedLen, typename iter::IterItem<I>::Result>) {
+  CRUST_IMPL_USE_SELF(iter::Enumerate<I>);
+
+  using Item = Tuple<usize, typename iter::IterItem<I>::Result>;
+
+  Item next_unchecked() {
+    return Item{self().count++, self().iter.next_unchecked()};
+  }
+
+  Item next_back_unchecked() {
+    auto x = self().iter.next_back_unchecked();
+    usize index = self().count + iter::_impl_iter::exact_len(self().iter);
+    return Item{index, move(x)};
+  }
+};
 } // namespace crust
 
 
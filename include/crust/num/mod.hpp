@@ -46,6 +46,64 @@ struct Int<i64> :
         i64,
         static_cast<i64>(0x8000000000000000ULL),
         0x7FFFFFFFFFFFFFFFLL> {};
+
+/// lowers to `popcnt' where the target has it.
+crust_always_inline u32 count_ones(u64 value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<u32>(__builtin_popcountll(value));
+#else
+  value -= (value >> 1) & 0x5555555555555555ull;
+  value = (value & 0x3333333333333333ull) +
+      ((value >> 2) & 0x3333333333333333ull);
+  value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+  return static_cast<u32>((value * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/// 64 for zero, lowers to `tzcnt' or `bsf'.
+crust_always_inline u32 trailing_zeros(u64 value) {
+  if (value == 0) {
+    return 64;
+  }
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<u32>(__builtin_ctzll(value));
+#else
+  u32 ret = 0;
+  for (; (value & 1) == 0; value >>= 1) {
+    ++ret;
+  }
+  return ret;
+#endif
+}
+
+/// 64 for zero, lowers to `lzcnt' or `bsr'.
+crust_always_inline u32 leading_zeros(u64 value) {
+  if (value == 0) {
+    return 64;
+  }
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<u32>(__builtin_clzll(value));
+#else
+  u32 ret = 0;
+  for (; (value >> 63) == 0; value <<= 1) {
+    ++ret;
+  }
+  return ret;
+#endif
+}
+
+/// reverses the byte order, lowers to `bswap'.
+crust_always_inline u64 swap_bytes(u64 value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap64(value);
+#else
+  value = ((value & 0x00FF00FF00FF00FFull) << 8) |
+      ((value >> 8) & 0x00FF00FF00FF00FFull);
+  value = ((value & 0x0000FFFF0000FFFFull) << 16) |
+      ((value >> 16) & 0x0000FFFF0000FFFFull);
+  return (value << 32) | (value >> 32);
+#endif
+}
 } // namespace num
 
 template <class A, class B>
@@ -2,6 +2,10 @@
 #define CRUST_OPS_FUNCTION_HPP
 
 
+#include <new>
+#include <type_traits>
+
+#include "crust/alloc/mod.hpp"
 #include "crust/tuple_decl.hpp"
 #include "crust/utility.hpp"
 
@@ -147,163 +151,445 @@ crust_always_inline constexpr FnMut<T, F> bind_mut(T &&f) {
   return FnMut<T, F>{forward<T>(f)};
 }
 
+template <class Self, class F = typename _impl_fn::MemFnClosure<Self>::Result>
+struct FnOnce;
+
+template <class Self, class Ret, class... Args>
+struct FnOnce<Self, Ret(Args...)> {
+private:
+  crust_static_assert(!IsConstOrRefVal<Self>::result);
+
+  Self self;
+
+public:
+  constexpr FnOnce(Self &&self) : self{move(self)} {}
+
+  crust_cxx14_constexpr Ret operator()(Args... args) && {
+    return move(self)(forward<Args>(args)...);
+  }
+};
+
+template <class F, F *f>
+crust_always_inline FnOnce<_impl_fn::RawFn<F, f>> bind_once(TmplVal<F *, f>) {
+  return FnOnce<_impl_fn::RawFn<F, f>>{_impl_fn::RawFn<F, f>{}};
+}
+
+template <class T, class F, F *f>
+crust_always_inline FnOnce<_impl_fn::RawFn<F, f>, T>
+bind_once(TmplVal<F *, f>) {
+  return FnOnce<_impl_fn::RawFn<F, f>, T>{_impl_fn::RawFn<F, f>{}};
+}
+
+template <class T>
+crust_always_inline constexpr FnOnce<T> bind_once(T &&f) {
+  return FnOnce<T>{forward<T>(f)};
+}
+
+template <class F, class T>
+crust_always_inline constexpr FnOnce<T, F> bind_once(T &&f) {
+  return FnOnce<T, F>{forward<T>(f)};
+}
+
 namespace _impl_fn {
-template <class Base, class Self>
-struct DestructorStaticWrapper {
-  static crust_cxx14_constexpr void inner(Base *self) {
-    reinterpret_cast<Self *>(self)->~Self();
+/// closures up to this many pointer words are stored inside the `DynFn'
+/// itself, larger ones are placed in memory from the allocator.
+constexpr usize INLINE_WORDS = 3;
+
+/// small buffer shared by the owning type erased wrappers, `DynFn' and its
+/// siblings as well as `boxed::DynBox'. zero words always use the heap.
+template <usize words = INLINE_WORDS>
+union Storage {
+  void *ptr;
+  alignas(void *) u8 buffer[words * sizeof(void *)];
+};
+
+template <>
+union Storage<0> {
+  void *ptr;
+};
+
+/// inline storage requires the object to fit and to be relocatable without
+/// failing, because moving the wrapper is noexcept.
+template <class Self, usize words = INLINE_WORDS>
+struct IsInline :
+    BoolVal<
+        words != 0 && sizeof(Self) <= sizeof(Storage<words>) &&
+        alignof(Self) <= alignof(Storage<words>) &&
+        std::is_nothrow_move_constructible<Self>::value> {};
+
+template <
+    class Self,
+    class A,
+    usize words = INLINE_WORDS,
+    bool is_inline = IsInline<Self, words>::result>
+struct Holder;
+
+template <class Self, class A, usize words>
+struct Holder<Self, A, words, true> {
+  template <class T>
+  static void construct(Storage<words> &storage, A &, T &&self) {
+    ::new (storage.buffer) Self{forward<T>(self)};
+  }
+
+  static crust_always_inline const Self *get(const void *storage) {
+    return reinterpret_cast<const Self *>(
+        static_cast<const Storage<words> *>(storage)->buffer);
+  }
+
+  static crust_always_inline Self *get(void *storage) {
+    return reinterpret_cast<Self *>(
+        static_cast<Storage<words> *>(storage)->buffer);
+  }
+
+  static void drop(void *storage, A &) { get(storage)->~Self(); }
+
+  static void relocate(void *dst, void *src) {
+    ::new (static_cast<Storage<words> *>(dst)->buffer) Self{move(*get(src))};
+    get(src)->~Self();
   }
 };
 
-template <class Ret, class... Args>
-struct FnVTable {
-  void (*drop)(void *);
+template <class Self, class A, usize words>
+struct Holder<Self, A, words, false> {
+  template <class T>
+  static void construct(Storage<words> &storage, A &alloc, T &&self) {
+    void *ptr = alloc.allocate(sizeof(Self), alignof(Self));
+    storage.ptr = ::new (ptr) Self{forward<T>(self)};
+  }
+
+  static crust_always_inline const Self *get(const void *storage) {
+    return static_cast<const Self *>(
+        static_cast<const Storage<words> *>(storage)->ptr);
+  }
+
+  static crust_always_inline Self *get(void *storage) {
+    return static_cast<Self *>(static_cast<Storage<words> *>(storage)->ptr);
+  }
+
+  static void drop(void *storage, A &alloc) {
+    Self *self = get(storage);
+    self->~Self();
+    alloc.deallocate(self, sizeof(Self), alignof(Self));
+  }
+
+  static void relocate(void *dst, void *src) {
+    static_cast<Storage<words> *>(dst)->ptr =
+        static_cast<Storage<words> *>(src)->ptr;
+  }
+};
+
+/// `Call' is the only entry that differs between `Fn', `FnMut' and `FnOnce'.
+template <class A, class Call>
+struct VTable {
+  void (*drop)(void *, A &);
+  void (*relocate)(void *, void *);
   usize size;
   usize align;
-  Ret (*call)(const void *, Args...);
+  Call call;
 };
 
-template <class Self, class Ret, class... Args>
+template <class A, class Ret, class... Args>
+using FnVTable = VTable<A, Ret (*)(const void *, Args...)>;
+
+template <class A, class Ret, class... Args>
+using FnMutVTable = VTable<A, Ret (*)(void *, Args...)>;
+
+template <class A, class Ret, class... Args>
+using FnOnceVTable = VTable<A, Ret (*)(void *, A &, Args...)>;
+
+template <class Self, class A, class Ret, class... Args>
 struct StaticFnVTable {
-  static const FnVTable<Ret, Args...> vtable;
+  static const FnVTable<A, Ret, Args...> vtable;
 
-  static constexpr Ret call(const void *self, Args &&...args) {
-    return (*reinterpret_cast<const Self *>(self))(forward<Args>(args)...);
+  static Ret call(const void *self, Args... args) {
+    return (*Holder<Self, A>::get(self))(forward<Args>(args)...);
   }
 };
 
-template <class Self, class Ret, class... Args>
-const FnVTable<Ret, Args...> StaticFnVTable<Self, Ret, Args...>::vtable{
-    DestructorStaticWrapper<void, Self>::inner,
+template <class Self, class A, class Ret, class... Args>
+const FnVTable<A, Ret, Args...> StaticFnVTable<Self, A, Ret, Args...>::vtable{
+    Holder<Self, A>::drop,
+    Holder<Self, A>::relocate,
     sizeof(Self),
     alignof(Self),
     call,
 };
 
-template <class Ret, class... Args>
-struct FnMutVTable {
-  void (*drop)(void *);
-  usize size;
-  usize align;
-  Ret (*call)(void *, Args...);
+template <class Self, class A, class Ret, class... Args>
+struct StaticFnMutVTable {
+  static const FnMutVTable<A, Ret, Args...> vtable;
+
+  static Ret call(void *self, Args... args) {
+    return (*Holder<Self, A>::get(self))(forward<Args>(args)...);
+  }
 };
 
-template <class Self, class Ret, class... Args>
-struct StaticFnMutVTable {
-  static const FnMutVTable<Ret, Args...> vtable;
+template <class Self, class A, class Ret, class... Args>
+const FnMutVTable<A, Ret, Args...>
+    StaticFnMutVTable<Self, A, Ret, Args...>::vtable{
+        Holder<Self, A>::drop,
+        Holder<Self, A>::relocate,
+        sizeof(Self),
+        alignof(Self),
+        call,
+    };
+
+/// the closure is destroyed on the way out of `call', whether or not `Ret'
+/// is void.
+template <class Self, class A>
+struct DropGuard {
+  void *storage;
+  A &alloc;
+
+  ~DropGuard() { Holder<Self, A>::drop(storage, alloc); }
+};
+
+template <class Self, class A, class Ret, class... Args>
+struct StaticFnOnceVTable {
+  static const FnOnceVTable<A, Ret, Args...> vtable;
 
-  static crust_cxx14_constexpr Ret call(void *self, Args... args) {
-    return (*reinterpret_cast<Self *>(self))(forward<Args>(args)...);
+  static Ret call(void *self, A &alloc, Args... args) {
+    DropGuard<Self, A> guard{self, alloc};
+    return move(*Holder<Self, A>::get(self))(forward<Args>(args)...);
   }
 };
 
-template <class Self, class Ret, class... Args>
-const FnMutVTable<Ret, Args...> StaticFnMutVTable<Self, Ret, Args...>::vtable{
-    DestructorStaticWrapper<void, Self>::inner,
-    sizeof(Self),
-    alignof(Self),
-    call,
+template <class Self, class A, class Ret, class... Args>
+const FnOnceVTable<A, Ret, Args...>
+    StaticFnOnceVTable<Self, A, Ret, Args...>::vtable{
+        Holder<Self, A>::drop,
+        Holder<Self, A>::relocate,
+        sizeof(Self),
+        alignof(Self),
+        call,
+    };
+
+/// storage, vtable and allocator shared by all owning type erased closures.
+/// a null vtable marks an empty or moved from object.
+template <class A, class Call>
+struct crust_ebco Erased : private A {
+  Storage<> storage;
+  const VTable<A, Call> *vtable;
+
+  template <class Self, class T>
+  Erased(TmplType<Self>, const VTable<A, Call> *vtable, T &&self, A alloc) :
+      A{alloc}, vtable{vtable} {
+    Holder<Self, A>::construct(storage, allocator(), forward<T>(self));
+  }
+
+  Erased(Erased &&other) noexcept : A{other.allocator()} { move_from(other); }
+
+  Erased &operator=(Erased &&other) noexcept {
+    if (this != &other) {
+      drop();
+      allocator() = other.allocator();
+      move_from(other);
+    }
+
+    return *this;
+  }
+
+  A &allocator() { return *this; }
+
+  void drop() {
+    if (vtable != nullptr) {
+      vtable->drop(&storage, allocator());
+      vtable = nullptr;
+    }
+  }
+
+  void move_from(Erased &other) {
+    vtable = other.vtable;
+    if (vtable != nullptr) {
+      vtable->relocate(&storage, &other.storage);
+      other.vtable = nullptr;
+    }
+  }
+
+  ~Erased() { drop(); }
 };
+
+template <class T, class Dyn>
+using EnableIfClosure =
+    EnableIf<Not<IsSame<typename RemoveConstOrRefType<T>::Result, Dyn>>>;
 } // namespace _impl_fn
 
-template <class F>
+template <class F, class A = alloc::Global>
 struct DynFn;
 
-template <class F>
+template <class F, class A = alloc::Global>
 struct DynFnMut;
 
-template <class Ret, class... Args>
-struct DynFn<Ret(Args...)> { // TODO: optimize for zero sized type
+template <class F, class A = alloc::Global>
+struct DynFnOnce;
+
+/// type erased closure, captures that do not fit inline are placed in memory
+/// from `A'.
+template <class Ret, class... Args, class A>
+struct DynFn<Ret(Args...), A> {
 private:
-  void *self;
-  const _impl_fn::FnVTable<Ret, Args...> *vtable;
+  template <class T>
+  using Self = typename RemoveConstOrRefType<T>::Result;
 
-  void drop() {
-    if (self != nullptr) {
-      vtable->drop(self);
-      delete reinterpret_cast<char *>(self);
-      self = nullptr;
-    }
-  }
+  _impl_fn::Erased<A, Ret (*)(const void *, Args...)> inner;
 
-  void move_from(DynFn &&other) {
-    self = other.self;
-    vtable = other.vtable;
-    other.self = nullptr;
+public:
+  template <class T, class = _impl_fn::EnableIfClosure<T, DynFn>>
+  DynFn(T &&self, A alloc = A{}) :
+      inner{
+          TmplType<Self<T>>{},
+          &_impl_fn::StaticFnVTable<Self<T>, A, Ret, Args...>::vtable,
+          forward<T>(self),
+          alloc} {}
+
+  template <class F, F *f>
+  DynFn(TmplVal<F *, f>, A alloc = A{}) :
+      DynFn{_impl_fn::RawFn<F, f>{}, alloc} {}
+
+  Ret operator()(Args... args) const {
+    return inner.vtable->call(&inner.storage, forward<Args>(args)...);
   }
+};
+
+/// type erased mutable closure, captures that do not fit inline are placed in
+/// memory from `A'.
+template <class Ret, class... Args, class A>
+struct DynFnMut<Ret(Args...), A> {
+private:
+  template <class T>
+  using Self = typename RemoveConstOrRefType<T>::Result;
+
+  _impl_fn::Erased<A, Ret (*)(void *, Args...)> inner;
 
 public:
-  template <class Self>
-  constexpr DynFn(Self &&self) :
-      self{new Self{forward<Self>(self)}},
-      vtable{&_impl_fn::StaticFnVTable<Self, Ret, Args...>::vtable} {}
+  template <class T, class = _impl_fn::EnableIfClosure<T, DynFnMut>>
+  DynFnMut(T &&self, A alloc = A{}) :
+      inner{
+          TmplType<Self<T>>{},
+          &_impl_fn::StaticFnMutVTable<Self<T>, A, Ret, Args...>::vtable,
+          forward<T>(self),
+          alloc} {}
 
   template <class F, F *f>
-  constexpr DynFn(TmplVal<F *, f>) : DynFn{_impl_fn::RawFn<F, f>{}} {}
+  DynFnMut(TmplVal<F *, f>, A alloc = A{}) :
+      DynFnMut{_impl_fn::RawFn<F, f>{}, alloc} {}
 
-  DynFn(DynFn &&other) noexcept { move_from(move(other)); }
+  Ret operator()(Args... args) {
+    return inner.vtable->call(&inner.storage, forward<Args>(args)...);
+  }
+};
 
-  DynFn &operator=(DynFn &&other) noexcept {
-    if (this != &other) {
-      drop();
-      move_from(move(other));
-    }
+/// type erased closure that can be called only once, the call consumes and
+/// destroys the closure in a single vtable call.
+template <class Ret, class... Args, class A>
+struct DynFnOnce<Ret(Args...), A> {
+private:
+  template <class T>
+  using Self = typename RemoveConstOrRefType<T>::Result;
 
-    return *this;
+  _impl_fn::Erased<A, Ret (*)(void *, A &, Args...)> inner;
+
+public:
+  template <class T, class = _impl_fn::EnableIfClosure<T, DynFnOnce>>
+  DynFnOnce(T &&self, A alloc = A{}) :
+      inner{
+          TmplType<Self<T>>{},
+          &_impl_fn::StaticFnOnceVTable<Self<T>, A, Ret, Args...>::vtable,
+          forward<T>(self),
+          alloc} {}
+
+  template <class F, F *f>
+  DynFnOnce(TmplVal<F *, f>, A alloc = A{}) :
+      DynFnOnce{_impl_fn::RawFn<F, f>{}, alloc} {}
+
+  /// `false' once the closure has been called or moved from.
+  bool is_callable() const { return inner.vtable != nullptr; }
+
+  Ret operator()(Args... args) && {
+    crust_assert(is_callable());
+    auto call = inner.vtable->call;
+    inner.vtable = nullptr;
+    return call(&inner.storage, inner.allocator(), forward<Args>(args)...);
   }
+};
 
-  constexpr Ret operator()(Args &&...args) const {
-    return vtable->call(self, forward<Args>(args)...);
+namespace _impl_fn {
+template <class Self, class Ret, class... Args>
+struct RefThunk {
+  static Ret call(const void *self, Args... args) {
+    return (*static_cast<const Self *>(self))(forward<Args>(args)...);
   }
 
-  ~DynFn() { drop(); }
+  static Ret call_mut(void *self, Args... args) {
+    return (*static_cast<Self *>(self))(forward<Args>(args)...);
+  }
 };
 
-template <class Ret, class... Args>
-struct DynFnMut<Ret(Args...)> {
-private:
-  void *self;
-  const _impl_fn::FnMutVTable<Ret, Args...> *vtable;
-
-  void drop() {
-    if (self != nullptr) {
-      vtable->drop(self);
-      delete reinterpret_cast<char *>(self);
-      self = nullptr;
-    }
+/// plain functions need no object, the pointer is baked into the thunk.
+template <class F, F *f, class Ret, class... Args>
+struct RawFnThunk {
+  static Ret call(const void *, Args... args) {
+    return RawFn<F, f>{}(forward<Args>(args)...);
   }
 
-  void move_from(DynFnMut &&other) {
-    self = other.self;
-    vtable = other.vtable;
-    other.self = nullptr;
+  static Ret call_mut(void *, Args... args) {
+    return RawFn<F, f>{}(forward<Args>(args)...);
   }
+};
+} // namespace _impl_fn
+
+template <class F>
+struct DynFnRef;
+
+template <class F>
+struct DynFnMutRef;
+
+/// borrowed view of a callable, the referred object must outlive the view.
+template <class Ret, class... Args>
+struct DynFnRef<Ret(Args...)> {
+private:
+  const void *self;
+  Ret (*thunk)(const void *, Args...);
 
 public:
-  template <class Self>
-  constexpr DynFnMut(Self &&self) :
-      self{new Self{forward<Self>(self)}},
-      vtable{&_impl_fn::StaticFnMutVTable<Self, Ret, Args...>::vtable} {}
+  template <class T, class = _impl_fn::EnableIfClosure<T, DynFnRef>>
+  DynFnRef(const T &self) :
+      self{&self}, thunk{_impl_fn::RefThunk<T, Ret, Args...>::call} {}
 
   template <class F, F *f>
-  constexpr DynFnMut(TmplVal<F *, f>) : DynFnMut{_impl_fn::RawFn<F, f>{}} {}
+  DynFnRef(TmplVal<F *, f>) :
+      self{nullptr}, thunk{_impl_fn::RawFnThunk<F, f, Ret, Args...>::call} {}
 
-  DynFnMut(DynFnMut &&other) noexcept { move_from(move(other)); }
+  Ret operator()(Args... args) const {
+    return thunk(self, forward<Args>(args)...);
+  }
+};
 
-  DynFnMut &operator=(DynFnMut &&other) noexcept {
-    if (this != &other) {
-      drop();
-      move_from(move(other));
-    }
+/// borrowed view of a mutable callable, the referred object must outlive the
+/// view.
+template <class Ret, class... Args>
+struct DynFnMutRef<Ret(Args...)> {
+private:
+  void *self;
+  Ret (*thunk)(void *, Args...);
 
-    return *this;
-  }
+public:
+  template <class T, class = _impl_fn::EnableIfClosure<T, DynFnMutRef>>
+  DynFnMutRef(T &&self) :
+      self{&self},
+      thunk{_impl_fn::RefThunk<
+          typename RemoveRefType<T>::Result,
+          Ret,
+          Args...>::call_mut} {}
 
-  crust_cxx14_constexpr Ret operator()(Args... args) {
-    return vtable->call(self, forward<Args>(args)...);
-  }
+  template <class F, F *f>
+  DynFnMutRef(TmplVal<F *, f>) :
+      self{nullptr},
+      thunk{_impl_fn::RawFnThunk<F, f, Ret, Args...>::call_mut} {}
 
-  ~DynFnMut() { drop(); }
+  Ret operator()(Args... args) const {
+    return thunk(self, forward<Args>(args)...);
+  }
 };
 } // namespace ops
 } // namespace crust
@@ -3,6 +3,7 @@
 
 
 #include "crust/enum.hpp"
+#include "crust/iter/mod.hpp"
 #include "crust/utility.hpp"
 
 
@@ -10,8 +11,15 @@ namespace crust {
 namespace range {
 struct RangeFull {};
 
+/// integral ranges are also iterators, all other ranges are only bounds.
 template <class T>
-struct Range {
+struct crust_ebco Range :
+    Impl<
+        Range<T>,
+        Trait<iter::Iterator, T>,
+        Trait<iter::DoubleEndedIterator, T>,
+        Trait<iter::ExactSizeIterator, T>,
+        Trait<iter::TrustedLen, T>> {
   T start;
   T end;
 
@@ -34,6 +42,78 @@ struct RangeTo {
   explicit constexpr RangeTo(T end) : end{end} {}
 };
 } // namespace range
+
+template <class T>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::Iterator<range::Range<T>, T>),
+    BoolVal<std::is_integral<T>::value>) {
+  CRUST_IMPL_USE_SELF(range::Range<T>);
+
+  Option<T> next() {
+    if (self().is_empty()) {
+      return None{};
+    }
+    return make_some(self().start++);
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    // in `usize', the difference of two signed ends may not fit `T'.
+    usize len = self().is_empty() ?
+        0 :
+        static_cast<usize>(self().end) - static_cast<usize>(self().start);
+    return tuple(len, make_some(len));
+  }
+
+  /// elements are computed from `start' directly, so filling a block has no
+  /// loop carried dependency.
+  template <usize N>
+  Result<iter::ArrayChunk<T, N>, iter::ArrayChunk<T, N>> next_chunk() {
+    iter::ArrayChunk<T, N> chunk;
+    usize len = self().len();
+    usize n = len < N ? len : N;
+
+    for (usize i = 0; i < n; ++i) {
+      chunk.push_unchecked(static_cast<T>(self().start + i));
+    }
+    self().start = static_cast<T>(self().start + n);
+
+    if (chunk.is_full()) {
+      return Ok<iter::ArrayChunk<T, N>>{move(chunk)};
+    } else {
+      return Err<iter::ArrayChunk<T, N>>{move(chunk)};
+    }
+  }
+};
+
+template <class T>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::DoubleEndedIterator<range::Range<T>, T>),
+    BoolVal<std::is_integral<T>::value>) {
+  CRUST_IMPL_USE_SELF(range::Range<T>);
+
+  Option<T> next_back() {
+    if (self().is_empty()) {
+      return None{};
+    }
+    return make_some(--self().end);
+  }
+};
+
+template <class T>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::ExactSizeIterator<range::Range<T>, T>),
+    BoolVal<std::is_integral<T>::value>){};
+
+template <class T>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::TrustedLen<range::Range<T>, T>),
+    BoolVal<std::is_integral<T>::value>) {
+  CRUST_IMPL_USE_SELF(range::Range<T>);
+
+  T next_unchecked() { return self().start++; }
+
+  T next_back_unchecked() { return --self().end; }
+};
 } // namespace crust
 
 
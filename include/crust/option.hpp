@@ -58,7 +58,7 @@ constexpr Option<U> Option<T>::map(ops::Fn<F, U(const T &)> f) const {
 
 template <class T>
 crust_cxx14_constexpr Option<T> Option<T>::take() {
-  auto tmp = this->template move_variant<Option<T>>();
+  Option<T> tmp{move(*this)};
   *this = None{};
   return tmp;
 }
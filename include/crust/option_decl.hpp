@@ -50,7 +50,9 @@ struct crust_ebco Option :
   constexpr bool is_none() const { return this->template is_variant<None>(); }
 
   constexpr bool contains(const T &other) const {
-    return this->template eq_variant<Some<T>>(other);
+    return this->template visit<bool>(
+        [&](const Some<T> &value) { return value.template get<0>() == other; },
+        [](const None &) { return false; });
   }
 
   constexpr Option<const T *> as_ptr() const {
@@ -64,7 +66,7 @@ struct crust_ebco Option :
   crust_cxx14_constexpr T unwrap() && {
     return this->template visit<T>(
         [](Some<T> &value) { return move(value.template get<0>()); },
-        [](None &) {
+        [](None &) -> T {
           crust_panic("called `Option::unwrap()` on a `None` value");
         });
   }
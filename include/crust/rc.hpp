@@ -0,0 +1,380 @@
+#ifndef CRUST_RC_HPP
+#define CRUST_RC_HPP
+
+
+#include <new>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/fmt/mod.hpp"
+#include "crust/option.hpp"
+#include "crust/result.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace _impl_rc {
+/// reference count for single threaded sharing, `sync::Arc' swaps in an
+/// atomic one with the same interface.
+struct Count {
+private:
+  usize value;
+
+public:
+  explicit Count(usize value) : value{value} {}
+
+  usize load() const { return value; }
+
+  void increment() { ++value; }
+
+  /// `increment' for the weak count, which `lock' may hold.
+  void increment_unlocked() { ++value; }
+
+  /// returns whether the count dropped to zero.
+  bool decrement() { return --value == 0; }
+
+  bool increment_if_nonzero() {
+    if (value == 0) {
+      return false;
+    }
+    ++value;
+    return true;
+  }
+
+  /// drops the count from one to zero, claiming the last reference.
+  bool claim_last() {
+    if (value != 1) {
+      return false;
+    }
+    value = 0;
+    return true;
+  }
+
+  /// succeeds when no `Weak' exists, keeping new ones from being created
+  /// until `unlock'.
+  bool lock() { return value == 1; }
+
+  void unlock() {}
+};
+
+/// counters and value share one allocation. the value is destroyed with the
+/// last strong reference, the memory is freed with the last weak one, all
+/// strong references together hold a single weak reference.
+template <class T, class C>
+struct Inner {
+  C strong;
+  C weak;
+  union {
+    T value;
+  };
+
+  template <class U>
+  explicit Inner(U &&value) : strong{1}, weak{1}, value{forward<U>(value)} {}
+
+  ~Inner() {}
+};
+
+template <class T, class C, class A>
+struct Strong;
+
+template <class T, class C, class A>
+struct Weak;
+
+template <class T, class C, class A>
+void release_weak(Inner<T, C> *inner, A &alloc) {
+  if (inner->weak.decrement()) {
+    inner->~Inner();
+    alloc.deallocate(inner, sizeof(Inner<T, C>), alignof(Inner<T, C>));
+  }
+}
+
+/// shared owning pointer, see `rc::Rc' and `sync::Arc'.
+template <class T, class C, class A>
+struct crust_ebco Strong :
+    private A,
+    Impl<
+        Strong<T, C, A>,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<cmp::PartialOrd>,
+        Trait<cmp::Ord>,
+        Trait<fmt::Debug>,
+        Trait<fmt::Display>> {
+private:
+  crust_static_assert(!IsConstOrRefVal<T>::result);
+
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  friend struct Weak<T, C, A>;
+
+  Inner<T, C> *inner;
+
+  struct Raw {};
+
+  Strong(Raw, Inner<T, C> *inner, A alloc) : A{alloc}, inner{inner} {}
+
+  A &allocator() { return *this; }
+
+  void drop() {
+    if (inner != nullptr) {
+      if (inner->strong.decrement()) {
+        inner->value.~T();
+        release_weak(inner, allocator());
+      }
+      inner = nullptr;
+    }
+  }
+
+  bool is_unique() {
+    if (!inner->weak.lock()) {
+      return false;
+    }
+    bool unique = inner->strong.load() == 1;
+    inner->weak.unlock();
+    return unique;
+  }
+
+  /// called after `claim_last', moves the value out and lets the remaining
+  /// `Weak's fail to upgrade.
+  T take_claimed() {
+    T value{move(inner->value)};
+    inner->value.~T();
+    release_weak(inner, allocator());
+    inner = nullptr;
+    return value;
+  }
+
+public:
+  explicit Strong(T value, A alloc = A{}) : A{alloc}, inner{nullptr} {
+    void *raw = allocator().allocate(sizeof(Inner<T, C>), alignof(Inner<T, C>));
+    inner = ::new (raw) Inner<T, C>{move(value)};
+  }
+
+  Strong(const Strong &) = delete;
+
+  Strong(Strong &&other) noexcept : A{other.allocator()}, inner{other.inner} {
+    other.inner = nullptr;
+  }
+
+  Strong &operator=(const Strong &) = delete;
+
+  Strong &operator=(Strong &&other) noexcept {
+    if (this != &other) {
+      drop();
+      allocator() = other.allocator();
+      inner = other.inner;
+      other.inner = nullptr;
+    }
+
+    return *this;
+  }
+
+  const A &allocator() const { return *this; }
+
+  const T *as_ptr() const { return &inner->value; }
+
+  const T &operator*() const {
+    crust_debug_assert(inner != nullptr);
+    return inner->value;
+  }
+
+  const T *operator->() const { return &**this; }
+
+  usize strong_count() const { return inner->strong.load(); }
+
+  usize weak_count() const { return inner->weak.load() - 1; }
+
+  /// whether both point to the same allocation.
+  bool ptr_eq(const Strong &other) const { return inner == other.inner; }
+
+  Weak<T, C, A> downgrade() const {
+    inner->weak.increment_unlocked();
+    return Weak<T, C, A>{inner, allocator()};
+  }
+
+  /// mutable access when no other `Strong' or `Weak' points to the value.
+  Option<RefMut<T>> get_mut() {
+    if (!is_unique()) {
+      return None{};
+    }
+    return make_some(ref_mut(inner->value));
+  }
+
+  /// copy on write access. a shared value is cloned into a new allocation,
+  /// one that is only observed by `Weak's is moved there instead.
+  T &make_mut() {
+    if (!is_unique()) {
+      A alloc = allocator();
+      if (inner->strong.claim_last()) {
+        *this = Strong{take_claimed(), alloc};
+      } else {
+        *this = Strong{_impl_clone::clone_of(inner->value), alloc};
+      }
+    }
+    return inner->value;
+  }
+
+  /// the value when this is the only `Strong', otherwise itself back.
+  Result<T, Strong> try_unwrap() {
+    if (!inner->strong.claim_last()) {
+      return Err<Strong>{move(*this)};
+    }
+    return Ok<T>{take_claimed()};
+  }
+
+  ~Strong() { drop(); }
+};
+
+/// non-owning companion of `Strong', it keeps the allocation but not the
+/// value alive.
+template <class T, class C, class A>
+struct crust_ebco Weak :
+    private A,
+    Impl<Weak<T, C, A>, Trait<clone::Clone>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  friend struct Strong<T, C, A>;
+
+  Inner<T, C> *inner;
+
+  Weak(Inner<T, C> *inner, A alloc) : A{alloc}, inner{inner} {}
+
+  A &allocator() { return *this; }
+
+  void drop() {
+    if (inner != nullptr) {
+      release_weak(inner, allocator());
+      inner = nullptr;
+    }
+  }
+
+public:
+  /// a `Weak' that never upgrades, without allocating.
+  explicit Weak(A alloc = A{}) : A{alloc}, inner{nullptr} {}
+
+  Weak(const Weak &) = delete;
+
+  Weak(Weak &&other) noexcept : A{other.allocator()}, inner{other.inner} {
+    other.inner = nullptr;
+  }
+
+  Weak &operator=(const Weak &) = delete;
+
+  Weak &operator=(Weak &&other) noexcept {
+    if (this != &other) {
+      drop();
+      allocator() = other.allocator();
+      inner = other.inner;
+      other.inner = nullptr;
+    }
+
+    return *this;
+  }
+
+  const A &allocator() const { return *this; }
+
+  Option<Strong<T, C, A>> upgrade() const {
+    if (inner == nullptr || !inner->strong.increment_if_nonzero()) {
+      return None{};
+    }
+    using S = Strong<T, C, A>;
+    return make_some(S{typename S::Raw{}, inner, allocator()});
+  }
+
+  usize strong_count() const {
+    return inner == nullptr ? 0 : inner->strong.load();
+  }
+
+  bool ptr_eq(const Weak &other) const { return inner == other.inner; }
+
+  ~Weak() { drop(); }
+};
+} // namespace _impl_rc
+
+namespace rc {
+/// single threaded reference counted pointer.
+template <class T, class A = alloc::Global>
+using Rc = _impl_rc::Strong<T, _impl_rc::Count, A>;
+
+template <class T, class A = alloc::Global>
+using Weak = _impl_rc::Weak<T, _impl_rc::Count, A>;
+} // namespace rc
+
+template <class T, class C, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(clone::Clone<_impl_rc::Strong<T, C, A>>)) {
+  CRUST_IMPL_USE_SELF(_impl_rc::Strong<T, C, A>);
+
+  Self clone() const {
+    self().inner->strong.increment();
+    return Self{typename Self::Raw{}, self().inner, self().allocator()};
+  }
+
+  void clone_from(const Self &other) { self() = other.clone(); }
+};
+
+template <class T, class C, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(clone::Clone<_impl_rc::Weak<T, C, A>>)) {
+  CRUST_IMPL_USE_SELF(_impl_rc::Weak<T, C, A>);
+
+  Self clone() const {
+    if (self().inner != nullptr) {
+      self().inner->weak.increment_unlocked();
+    }
+    return Self{self().inner, self().allocator()};
+  }
+
+  void clone_from(const Self &other) { self() = other.clone(); }
+};
+
+template <class T, class C, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialEq<_impl_rc::Strong<T, C, A>>)) {
+  CRUST_IMPL_USE_SELF(_impl_rc::Strong<T, C, A>);
+
+  bool eq(const Self &other) const { return *self() == *other; }
+};
+
+template <class T, class C, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Eq<_impl_rc::Strong<T, C, A>>)){};
+
+template <class T, class C, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialOrd<_impl_rc::Strong<T, C, A>>)) {
+  CRUST_IMPL_USE_SELF(_impl_rc::Strong<T, C, A>);
+
+  Option<cmp::Ordering> partial_cmp(const Self &other) const {
+    return operator_partial_cmp(*self(), *other);
+  }
+};
+
+template <class T, class C, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Ord<_impl_rc::Strong<T, C, A>>)) {
+  CRUST_IMPL_USE_SELF(_impl_rc::Strong<T, C, A>);
+
+  cmp::Ordering cmp(const Self &other) const {
+    return operator_cmp(*self(), *other);
+  }
+};
+
+template <class T, class C, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(fmt::Debug<_impl_rc::Strong<T, C, A>>)) {
+  CRUST_IMPL_USE_SELF(_impl_rc::Strong<T, C, A>);
+
+  bool fmt_debug(fmt::Formatter &fmt) const { return self()->fmt_debug(fmt); }
+};
+
+template <class T, class C, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(fmt::Display<_impl_rc::Strong<T, C, A>>)) {
+  CRUST_IMPL_USE_SELF(_impl_rc::Strong<T, C, A>);
+
+  bool fmt_display(fmt::Formatter &fmt) const {
+    return self()->fmt_display(fmt);
+  }
+};
+} // namespace crust
+
+
+#endif // CRUST_RC_HPP
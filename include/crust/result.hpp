@@ -66,12 +66,32 @@ struct crust_ebco Result :
         [&](const Err<E> &value) { return value.template get<0>() == other; });
   }
 
-  crust_cxx14_constexpr Option<T> ok() {
-    return this->template move_variant<Option<T>>();
+  crust_cxx14_constexpr Option<T> ok() && {
+    return this->template visit<Option<T>>(
+        [](Ok<T> &value) { return make_some(move(value.template get<0>())); },
+        [](Err<E> &) { return make_none<T>(); });
   }
 
-  crust_cxx14_constexpr Option<E> err() {
-    return this->template move_variant<Option<E>>();
+  crust_cxx14_constexpr Option<E> err() && {
+    return this->template visit<Option<E>>(
+        [](Ok<T> &) { return make_none<E>(); },
+        [](Err<E> &value) { return make_some(move(value.template get<0>())); });
+  }
+
+  crust_cxx14_constexpr T unwrap() && {
+    return this->template visit<T>(
+        [](Ok<T> &value) { return move(value.template get<0>()); },
+        [](Err<E> &) -> T {
+          crust_panic("called `Result::unwrap()` on an `Err` value");
+        });
+  }
+
+  crust_cxx14_constexpr E unwrap_err() && {
+    return this->template visit<E>(
+        [](Ok<T> &) -> E {
+          crust_panic("called `Result::unwrap_err()` on an `Ok` value");
+        },
+        [](Err<E> &value) { return move(value.template get<0>()); });
   }
 };
 } // namespace result
@@ -2,11 +2,25 @@
 #define CRUST_SLICE_HPP
 
 
+#include "crust/iter/mod.hpp"
 #include "crust/ops/mod.hpp"
 #include "crust/utility.hpp"
 
 
 namespace crust {
+namespace _impl_slice {
+template <class T, class Item>
+struct RawIter;
+} // namespace _impl_slice
+
+namespace slice {
+template <class T>
+using Iter = _impl_slice::RawIter<const T, Ref<T>>;
+
+template <class T>
+using IterMut = _impl_slice::RawIter<T, RefMut<T>>;
+} // namespace slice
+
 template <class T>
 struct crust_ebco Slice : Impl<Slice<T>, Trait<index::Index, usize, T>> {
 private:
@@ -31,6 +45,14 @@ public:
   const T *as_ptr() const { return inner; }
 
   T *as_ptr() { return inner; }
+
+  slice::Iter<T> iter() const {
+    return slice::Iter<T>{as_ptr(), as_ptr() + len()};
+  }
+
+  slice::IterMut<T> iter_mut() {
+    return slice::IterMut<T>{as_ptr(), as_ptr() + len()};
+  }
 };
 
 template <class T>
@@ -51,6 +73,90 @@ CRUST_IMPL_FOR(CRUST_MACRO(index::Index<Slice<T>, usize, T>)) {
     return self().as_ptr()[index];
   }
 };
+
+namespace _impl_slice {
+/// `T' is the pointee type, `Item' is `Ref<T>' or `RefMut<T>'.
+template <class T, class Item>
+struct crust_ebco RawIter :
+    Impl<
+        RawIter<T, Item>,
+        Trait<iter::Iterator, Item>,
+        Trait<iter::DoubleEndedIterator, Item>,
+        Trait<iter::ExactSizeIterator, Item>,
+        Trait<iter::TrustedLen, Item>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  T *ptr;
+  T *end;
+
+public:
+  RawIter(T *ptr, T *end) : ptr{ptr}, end{end} {}
+};
+} // namespace _impl_slice
+
+template <class T, class Item>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::Iterator<_impl_slice::RawIter<T, Item>, Item>)) {
+  CRUST_IMPL_USE_SELF(_impl_slice::RawIter<T, Item>);
+
+  Option<Item> next() {
+    if (self().ptr == self().end) {
+      return None{};
+    }
+    return make_some(Item{*self().ptr++});
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    usize len = static_cast<usize>(self().end - self().ptr);
+    return tuple(len, make_some(len));
+  }
+
+  /// blocks are views into the underlying storage, nothing is copied.
+  template <usize N>
+  Result<Slice<T>, Slice<T>> next_chunk() {
+    T *ptr = self().ptr;
+    usize len = static_cast<usize>(self().end - ptr);
+    if (len < N) {
+      self().ptr = self().end;
+      return Err<Slice<T>>{Slice<T>::from_raw_parts(ptr, len)};
+    }
+    self().ptr += N;
+    return Ok<Slice<T>>{Slice<T>::from_raw_parts(ptr, N)};
+  }
+};
+
+template <class T, class Item>
+CRUST_IMPL_FOR(CRUST_MACRO(
+    iter::DoubleEndedIterator<_impl_slice::RawIter<T, Item>, Item>)) {
+  CRUST_IMPL_USE_SELF(_impl_slice::RawIter<T, Item>);
+
+  Option<Item> next_back() {
+    if (self().ptr == self().end) {
+      return None{};
+    }
+    return make_some(Item{*--self().end});
+  }
+};
+
+template <class T, class Item>
+CRUST_IMPL_FOR(CRUST_MACRO(
+    iter::ExactSizeIterator<_impl_slice::RawIter<T, Item>, Item>)) {
+  CRUST_IMPL_USE_SELF(_impl_slice::RawIter<T, Item>);
+
+  usize len() const { return static_cast<usize>(self().end - self().ptr); }
+};
+
+template <class T, class Item>
+CRUST_IMPL_FOR(
+    CRUST_MACRO(iter::TrustedLen<_impl_slice::RawIter<T, Item>, Item>)) {
+  CRUST_IMPL_USE_SELF(_impl_slice::RawIter<T, Item>);
+
+  Item next_unchecked() { return Item{*self().ptr++}; }
+
+  Item next_back_unchecked() { return Item{*--self().end}; }
+};
 } // namespace crust
 
 
@@ -0,0 +1,414 @@
+#ifndef CRUST_SMALL_VEC_HPP
+#define CRUST_SMALL_VEC_HPP
+
+
+#include <new>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/ops/function.hpp"
+#include "crust/ops/mod.hpp"
+#include "crust/option.hpp"
+#include "crust/slice.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+namespace crust {
+template <class T, usize N, class A = alloc::Global>
+struct SmallVec;
+
+/// vector storing up to `N' elements inline and spilling to memory from `A'
+/// beyond that. like `smallvec', one word is either the inline length or the
+/// heap capacity, a value greater than `N' marks the spilled state.
+template <class T, usize N, class A>
+struct crust_ebco SmallVec :
+    private A,
+    Impl<
+        SmallVec<T, N, A>,
+        Trait<index::Index, usize, T>,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<cmp::PartialOrd>,
+        Trait<cmp::Ord>,
+        Trait<iter::FromIterator, T>> {
+private:
+  crust_static_assert(N > 0);
+
+  using Memory = _impl_vec::RawMemory<T>;
+
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  struct Heap {
+    T *ptr;
+    usize len;
+  };
+
+  union Data {
+    alignas(T) u8 buffer[N * sizeof(T)];
+    Heap heap;
+
+    Data() {}
+  };
+
+  Data data;
+  usize tag;
+
+  A &allocator() { return *this; }
+
+  bool is_inline() const { return tag <= N; }
+
+  T *inline_ptr() { return reinterpret_cast<T *>(data.buffer); }
+
+  const T *inline_ptr() const {
+    return reinterpret_cast<const T *>(data.buffer);
+  }
+
+  void set_len(usize len) {
+    if (is_inline()) {
+      tag = len;
+    } else {
+      data.heap.len = len;
+    }
+  }
+
+  /// `new_cap' must be able to hold the current elements.
+  void set_capacity(usize new_cap) {
+    usize size = len();
+    if (new_cap <= N) {
+      if (!is_inline()) {
+        T *ptr = data.heap.ptr;
+        usize cap = tag;
+        Memory::move_forward(inline_ptr(), ptr, size);
+        Memory::deallocate(allocator(), ptr, cap);
+        tag = size;
+      }
+    } else if (is_inline()) {
+      T *ptr = Memory::allocate(allocator(), new_cap);
+      Memory::move_forward(ptr, inline_ptr(), size);
+      data.heap.ptr = ptr;
+      data.heap.len = size;
+      tag = new_cap;
+    } else if (new_cap != tag) {
+      data.heap.ptr =
+          Memory::reallocate(allocator(), data.heap.ptr, size, tag, new_cap);
+      tag = new_cap;
+    }
+  }
+
+  void take_from(SmallVec &other) {
+    if (other.is_inline()) {
+      Memory::move_forward(inline_ptr(), other.inline_ptr(), other.tag);
+      tag = other.tag;
+    } else {
+      data.heap = other.data.heap;
+      tag = other.tag;
+    }
+    other.tag = 0;
+  }
+
+  /// `other' may point into this vector, then it is rebased after the
+  /// elements move.
+  template <class U>
+  void extend_from_raw(const U *other, usize len) {
+    const T *begin = as_ptr();
+    bool inside = other >= begin && other < begin + this->len();
+    usize offset = inside ? static_cast<usize>(other - begin) : 0;
+    reserve(len);
+    if (inside) {
+      other = as_ptr() + offset;
+    }
+    T *ptr = as_mut_ptr() + this->len();
+    for (usize i = 0; i < len; ++i) {
+      ::new (ptr + i) T{_impl_clone::clone_of(other[i])};
+    }
+    set_len(this->len() + len);
+  }
+
+public:
+  SmallVec() : A{}, tag{0} {}
+
+  explicit SmallVec(A alloc) : A{alloc}, tag{0} {}
+
+  SmallVec(const SmallVec &) = delete;
+
+  SmallVec(SmallVec &&other) noexcept : A{other.allocator()}, tag{0} {
+    take_from(other);
+  }
+
+  SmallVec &operator=(const SmallVec &) = delete;
+
+  SmallVec &operator=(SmallVec &&other) noexcept {
+    if (this != &other) {
+      clear();
+      set_capacity(0);
+      allocator() = other.allocator();
+      take_from(other);
+    }
+
+    return *this;
+  }
+
+  const A &allocator() const { return *this; }
+
+  usize len() const { return is_inline() ? tag : data.heap.len; }
+
+  usize capacity() const { return is_inline() ? N : tag; }
+
+  bool is_empty() const { return len() == 0; }
+
+  /// whether elements have been moved to the heap.
+  bool spilled() const { return !is_inline(); }
+
+  const T *as_ptr() const { return is_inline() ? inline_ptr() : data.heap.ptr; }
+
+  T *as_mut_ptr() { return is_inline() ? inline_ptr() : data.heap.ptr; }
+
+  Slice<const T> as_slice() const {
+    return Slice<const T>::from_raw_parts(as_ptr(), len());
+  }
+
+  Slice<T> as_mut_slice() {
+    return Slice<T>::from_raw_parts(as_mut_ptr(), len());
+  }
+
+  slice::Iter<T> iter() const {
+    return slice::Iter<T>{as_ptr(), as_ptr() + len()};
+  }
+
+  slice::IterMut<T> iter_mut() {
+    return slice::IterMut<T>{as_mut_ptr(), as_mut_ptr() + len()};
+  }
+
+  Option<Ref<T>> get(usize index) const {
+    if (index >= len()) {
+      return None{};
+    }
+    return make_some(ref(as_ptr()[index]));
+  }
+
+  Option<RefMut<T>> get_mut(usize index) {
+    if (index >= len()) {
+      return None{};
+    }
+    return make_some(ref_mut(as_mut_ptr()[index]));
+  }
+
+  Option<Ref<T>> first() const { return get(0); }
+
+  Option<Ref<T>> last() const {
+    return is_empty() ? make_none<Ref<T>>() : get(len() - 1);
+  }
+
+  void reserve(usize additional) {
+    usize size = len();
+    usize cap = capacity();
+    if (cap - size >= additional) {
+      return;
+    }
+    usize new_cap = cap * 2;
+    if (new_cap < size + additional) {
+      new_cap = size + additional;
+    }
+    set_capacity(new_cap);
+  }
+
+  void reserve_exact(usize additional) {
+    if (capacity() - len() < additional) {
+      set_capacity(len() + additional);
+    }
+  }
+
+  /// moves the elements back inline when they fit.
+  void shrink_to_fit() {
+    if (!is_inline()) {
+      set_capacity(len());
+    }
+  }
+
+  void push(T value) {
+    if (len() == capacity()) {
+      reserve(1);
+    }
+    ::new (as_mut_ptr() + len()) T{move(value)};
+    set_len(len() + 1);
+  }
+
+  Option<T> pop() {
+    usize size = len();
+    if (size == 0) {
+      return None{};
+    }
+    T *slot = as_mut_ptr() + size - 1;
+    T value{move(*slot)};
+    slot->~T();
+    set_len(size - 1);
+    return make_some(move(value));
+  }
+
+  void insert(usize index, T value) {
+    usize size = len();
+    if (index > size) {
+      crust_panic("insertion index out of boundary!");
+    }
+    if (size == capacity()) {
+      reserve(1);
+    }
+    T *ptr = as_mut_ptr();
+    Memory::move_backward(ptr + index + 1, ptr + index, size - index);
+    ::new (ptr + index) T{move(value)};
+    set_len(size + 1);
+  }
+
+  T remove(usize index) {
+    usize size = len();
+    if (index >= size) {
+      crust_panic("removal index out of boundary!");
+    }
+    T *ptr = as_mut_ptr();
+    T value{move(ptr[index])};
+    ptr[index].~T();
+    Memory::move_forward(ptr + index, ptr + index + 1, size - index - 1);
+    set_len(size - 1);
+    return value;
+  }
+
+  T swap_remove(usize index) {
+    usize size = len();
+    if (index >= size) {
+      crust_panic("removal index out of boundary!");
+    }
+    T *ptr = as_mut_ptr();
+    T value{move(ptr[index])};
+    ptr[index].~T();
+    if (index != size - 1) {
+      Memory::move_forward(ptr + index, ptr + size - 1, 1);
+    }
+    set_len(size - 1);
+    return value;
+  }
+
+  void truncate(usize len) {
+    usize size = this->len();
+    if (len < size) {
+      _impl_vec::drop_in_place(as_mut_ptr() + len, size - len);
+      set_len(len);
+    }
+  }
+
+  void clear() { truncate(0); }
+
+  void extend_from_slice(Slice<const T> other) {
+    extend_from_raw(other.as_ptr(), other.len());
+  }
+
+  void extend_from_slice(Slice<T> other) {
+    extend_from_raw(other.as_ptr(), other.len());
+  }
+
+  template <class F>
+  void retain(ops::FnMut<F, bool(const T &)> f) {
+    set_len(_impl_vec::retain(as_mut_ptr(), len(), f));
+  }
+
+  void dedup() { set_len(_impl_vec::dedup(as_mut_ptr(), len())); }
+
+  ~SmallVec() {
+    clear();
+    set_capacity(0);
+  }
+};
+
+template <class T, usize N, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(index::Index<SmallVec<T, N, A>, usize, T>)) {
+  CRUST_IMPL_USE_SELF(SmallVec<T, N, A>);
+
+  const T &index(usize index) const {
+    if (index >= self().len()) {
+      crust_panic("index out of boundary!");
+    }
+    return self().as_ptr()[index];
+  }
+
+  T &index_mut(usize index) {
+    if (index >= self().len()) {
+      crust_panic("index_mut out of boundary!");
+    }
+    return self().as_mut_ptr()[index];
+  }
+};
+
+template <class T, usize N, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(clone::Clone<SmallVec<T, N, A>>)) {
+  CRUST_IMPL_USE_SELF(SmallVec<T, N, A>);
+
+  Self clone() const {
+    Self ret{self().allocator()};
+    ret.extend_from_slice(self().as_slice());
+    return ret;
+  }
+
+  void clone_from(const Self &other) {
+    self().clear();
+    self().extend_from_slice(other.as_slice());
+  }
+};
+
+template <class T, usize N, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialEq<SmallVec<T, N, A>>)) {
+  CRUST_IMPL_USE_SELF(SmallVec<T, N, A>);
+
+  bool eq(const Self &other) const {
+    return _impl_vec::eq(
+        self().as_ptr(), self().len(), other.as_ptr(), other.len());
+  }
+};
+
+template <class T, usize N, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Eq<SmallVec<T, N, A>>)){};
+
+template <class T, usize N, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialOrd<SmallVec<T, N, A>>)) {
+  CRUST_IMPL_USE_SELF(SmallVec<T, N, A>);
+
+  Option<cmp::Ordering> partial_cmp(const Self &other) const {
+    return _impl_vec::partial_cmp(
+        self().as_ptr(), self().len(), other.as_ptr(), other.len());
+  }
+};
+
+template <class T, usize N, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Ord<SmallVec<T, N, A>>)) {
+  CRUST_IMPL_USE_SELF(SmallVec<T, N, A>);
+
+  cmp::Ordering cmp(const Self &other) const {
+    return _impl_vec::cmp(
+        self().as_ptr(), self().len(), other.as_ptr(), other.len());
+  }
+};
+
+template <class T, usize N, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::FromIterator<SmallVec<T, N, A>, T>)) {
+  CRUST_IMPL_USE_SELF(SmallVec<T, N, A>);
+
+  template <class I>
+  static Self from_iter(I &&iter) {
+    Self ret;
+    ret.reserve_exact(iter.size_hint().template get<0>());
+    while (true) {
+      auto x = iter.next();
+      if (x.is_none()) {
+        return ret;
+      }
+      ret.push(move(x).unwrap());
+    }
+  }
+};
+} // namespace crust
+
+
+#endif // CRUST_SMALL_VEC_HPP
@@ -0,0 +1,499 @@
+#ifndef CRUST_STR_HPP
+#define CRUST_STR_HPP
+
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "crust/cmp.hpp"
+#include "crust/fmt/mod.hpp"
+#include "crust/hash/mod.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/num/mod.hpp"
+#include "crust/option.hpp"
+#include "crust/result.hpp"
+#include "crust/slice.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+struct Str;
+
+namespace str {
+struct Utf8Error;
+
+struct Split;
+
+struct Lines;
+} // namespace str
+
+namespace _impl_str {
+/// number of leading ascii bytes in `[ptr, ptr + len)'. whole blocks are
+/// tested with one vector compare, the tail falls back to bytes.
+inline usize ascii_prefix(const u8 *ptr, usize len) {
+  usize i = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  for (; i + 16 <= len; i += 16) {
+    __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr + i));
+    u32 mask = static_cast<u32>(_mm_movemask_epi8(block));
+    if (mask != 0) {
+      return i + num::trailing_zeros(mask);
+    }
+  }
+#else
+  for (; i + 8 <= len; i += 8) {
+    u64 block;
+    std::memcpy(&block, ptr + i, sizeof(block));
+    if ((block & 0x8080808080808080ull) != 0) {
+      break;
+    }
+  }
+#endif
+
+  while (i < len && ptr[i] < 0x80) {
+    ++i;
+  }
+  return i;
+}
+
+crust_always_inline bool is_continuation(u8 byte) {
+  return (byte & 0xC0) == 0x80;
+}
+
+/// validates one multi byte sequence starting at `ptr[0]'. on success the
+/// width is returned, otherwise zero and `error_len' is set to the length of
+/// the invalid prefix, or zero if the input ends in the middle of it.
+inline usize
+validate_char(const u8 *ptr, usize remain, usize &error_len) {
+  u8 first = ptr[0];
+  u8 low = 0x80;
+  u8 high = 0xBF;
+  usize width;
+
+  if (first >= 0xC2 && first <= 0xDF) {
+    width = 2;
+  } else if (first >= 0xE0 && first <= 0xEF) {
+    width = 3;
+    if (first == 0xE0) {
+      low = 0xA0;
+    } else if (first == 0xED) {
+      high = 0x9F;
+    }
+  } else if (first >= 0xF0 && first <= 0xF4) {
+    width = 4;
+    if (first == 0xF0) {
+      low = 0x90;
+    } else if (first == 0xF4) {
+      high = 0x8F;
+    }
+  } else {
+    error_len = 1;
+    return 0;
+  }
+
+  for (usize i = 1; i < width; ++i) {
+    if (i >= remain) {
+      error_len = 0;
+      return 0;
+    }
+    u8 byte = ptr[i];
+    bool valid = i == 1 ? byte >= low && byte <= high : is_continuation(byte);
+    if (!valid) {
+      error_len = i;
+      return 0;
+    }
+  }
+
+  return width;
+}
+
+/// index of the first occurrence of `needle', or `len' if there is none.
+/// candidates are located with `memchr', which is vectorized by the libc.
+inline usize
+find(const u8 *ptr, usize len, const u8 *needle, usize needle_len) {
+  if (needle_len == 0) {
+    return 0;
+  }
+  if (needle_len > len) {
+    return len;
+  }
+
+  const u8 *last = ptr + (len - needle_len);
+  const u8 *cursor = ptr;
+  while (cursor <= last) {
+    const void *hit =
+        std::memchr(cursor, needle[0], static_cast<usize>(last - cursor) + 1);
+    if (hit == nullptr) {
+      return len;
+    }
+    cursor = static_cast<const u8 *>(hit);
+    if (std::memcmp(cursor + 1, needle + 1, needle_len - 1) == 0) {
+      return static_cast<usize>(cursor - ptr);
+    }
+    ++cursor;
+  }
+  return len;
+}
+
+crust_always_inline bool is_whitespace(u8 byte) {
+  return byte == ' ' || (byte >= '\t' && byte <= '\r');
+}
+} // namespace _impl_str
+
+/// a non template type instantiates its trait bases at its definition, so
+/// the impls have to be declared first. they are templates over `S' only to
+/// defer their bodies until the types are complete.
+template <class S>
+CRUST_IMPL_FOR(cmp::PartialEq<S>, IsSame<S, Str>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  bool eq(const Self &other) const {
+    return self().len() == other.len() &&
+        std::memcmp(self().as_ptr(), other.as_ptr(), self().len()) == 0;
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::Eq<S>, IsSame<S, Str>){};
+
+/// strings are ordered by their bytes, which matches code point order.
+template <class S>
+CRUST_IMPL_FOR(cmp::PartialOrd<S>, IsSame<S, Str>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  Option<cmp::Ordering> partial_cmp(const Self &other) const {
+    return make_some(self().cmp(other));
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::Ord<S>, IsSame<S, Str>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  cmp::Ordering cmp(const Self &other) const {
+    usize len = self().len() < other.len() ? self().len() : other.len();
+    int ret = std::memcmp(self().as_ptr(), other.as_ptr(), len);
+    if (ret != 0) {
+      return ret < 0 ? cmp::make_less() : cmp::make_greater();
+    }
+    return operator_cmp(self().len(), other.len());
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(hash::Hash<S>, IsSame<S, Str>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  template <class H>
+  void hash(H &state) const { state.write(self().as_ptr(), self().len()); }
+};
+
+template <class S>
+CRUST_IMPL_FOR(fmt::Display<S>, IsSame<S, Str>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  bool fmt_display(fmt::Formatter &fmt) const { return fmt.write_str(self()); }
+};
+
+/// quoted, with quotes, backslashes and control characters escaped.
+template <class S>
+CRUST_IMPL_FOR(fmt::Debug<S>, IsSame<S, Str>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  bool fmt_debug(fmt::Formatter &fmt) const {
+    static const char HEX[] = "0123456789abcdef";
+
+    const u8 *ptr = self().as_ptr();
+    usize len = self().len();
+    usize start = 0;
+    bool ok = fmt.write_str(Self::from_static("\""));
+
+    for (usize i = 0; i < len && ok; ++i) {
+      u8 byte = ptr[i];
+      u8 escape[4] = {'\\', 0, 0, 0};
+      usize escape_len = 2;
+      switch (byte) {
+      case '"': escape[1] = '"'; break;
+      case '\\': escape[1] = '\\'; break;
+      case '\n': escape[1] = 'n'; break;
+      case '\r': escape[1] = 'r'; break;
+      case '\t': escape[1] = 't'; break;
+      default:
+        if (byte >= 0x20 && byte != 0x7F) {
+          continue;
+        }
+        escape[1] = 'x';
+        escape[2] = static_cast<u8>(HEX[byte >> 4]);
+        escape[3] = static_cast<u8>(HEX[byte & 0xF]);
+        escape_len = 4;
+      }
+      ok = fmt.write_str(self().get(start, i).unwrap()) &&
+          fmt.write_str(Self::from_utf8_unchecked(
+              Slice<const u8>::from_raw_parts(escape, escape_len)));
+      start = i + 1;
+    }
+
+    return ok && fmt.write_str(self().get(start, len).unwrap()) &&
+        fmt.write_str(Self::from_static("\""));
+  }
+};
+
+/// borrowed utf-8 string.
+struct crust_ebco Str :
+    Impl<
+        Str,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<cmp::PartialOrd>,
+        Trait<cmp::Ord>,
+        Trait<hash::Hash>,
+        Trait<fmt::Debug>,
+        Trait<fmt::Display>> {
+private:
+  Slice<const u8> bytes;
+
+  Str(const u8 *ptr, usize len) :
+      bytes{Slice<const u8>::from_raw_parts(ptr, len)} {}
+
+  Str sub(usize start, usize end) const {
+    return Str{as_ptr() + start, end - start};
+  }
+
+public:
+  Str() : Str{reinterpret_cast<const u8 *>(""), 0} {}
+
+  /// string literals are assumed to be utf-8.
+  template <usize N>
+  static Str from_static(const char (&literal)[N]) {
+    return Str{reinterpret_cast<const u8 *>(literal), N - 1};
+  }
+
+  static Str from_utf8_unchecked(Slice<const u8> bytes) {
+    return Str{bytes.as_ptr(), bytes.len()};
+  }
+
+  static Result<Str, str::Utf8Error> from_utf8(Slice<const u8> bytes);
+
+  usize len() const { return bytes.len(); }
+
+  bool is_empty() const { return len() == 0; }
+
+  const u8 *as_ptr() const { return bytes.as_ptr(); }
+
+  Slice<const u8> as_bytes() const { return bytes; }
+
+  bool is_char_boundary(usize index) const {
+    return index == len() ||
+        (index < len() && !_impl_str::is_continuation(as_ptr()[index]));
+  }
+
+  /// sub string `[start, end)', `None' if either end is not on a character
+  /// boundary.
+  Option<Str> get(usize start, usize end) const {
+    if (start > end || !is_char_boundary(start) || !is_char_boundary(end)) {
+      return None{};
+    }
+    return make_some(sub(start, end));
+  }
+
+  Option<usize> find(Str needle) const {
+    usize index =
+        _impl_str::find(as_ptr(), len(), needle.as_ptr(), needle.len());
+    if (index == len() && !needle.is_empty()) {
+      return None{};
+    }
+    return make_some(index);
+  }
+
+  Option<usize> find_byte(u8 byte) const {
+    const void *hit = std::memchr(as_ptr(), byte, len());
+    if (hit == nullptr) {
+      return None{};
+    }
+    return make_some(
+        static_cast<usize>(static_cast<const u8 *>(hit) - as_ptr()));
+  }
+
+  bool contains(Str needle) const { return find(needle).is_some(); }
+
+  bool starts_with(Str prefix) const {
+    return prefix.len() <= len() &&
+        std::memcmp(as_ptr(), prefix.as_ptr(), prefix.len()) == 0;
+  }
+
+  bool ends_with(Str suffix) const {
+    return suffix.len() <= len() &&
+        std::memcmp(
+            as_ptr() + len() - suffix.len(), suffix.as_ptr(), suffix.len()) ==
+        0;
+  }
+
+  /// only ascii whitespace is trimmed.
+  Str trim_start() const {
+    usize start = 0;
+    while (start < len() && _impl_str::is_whitespace(as_ptr()[start])) {
+      ++start;
+    }
+    return sub(start, len());
+  }
+
+  Str trim_end() const {
+    usize end = len();
+    while (end > 0 && _impl_str::is_whitespace(as_ptr()[end - 1])) {
+      --end;
+    }
+    return sub(0, end);
+  }
+
+  Str trim() const { return trim_start().trim_end(); }
+
+  /// sub strings separated by `separator', an empty string yields one empty
+  /// item and an empty separator yields the whole string.
+  str::Split split(Str separator) const;
+
+  /// lines separated by `\n' or `\r\n', a final line ending does not start
+  /// a new line.
+  str::Lines lines() const;
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::PartialEq<S>, IsSame<S, str::Utf8Error>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  bool eq(const Self &other) const {
+    return self().valid_up_to() == other.valid_up_to() &&
+        self().error_len() == other.error_len();
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::Eq<S>, IsSame<S, str::Utf8Error>){};
+
+template <class S>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<S, Str>), IsSame<S, str::Split>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  Option<Str> next() {
+    if (self().finished) {
+      return None{};
+    }
+    Str &remain = self().remain;
+    const Str &separator = self().separator;
+    usize index = _impl_str::find(
+        remain.as_ptr(), remain.len(), separator.as_ptr(), separator.len());
+    if (index == remain.len() || separator.is_empty()) {
+      self().finished = true;
+      return make_some(remain);
+    }
+    Str item = remain.get(0, index).unwrap();
+    remain = remain.get(index + separator.len(), remain.len()).unwrap();
+    return make_some(item);
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<S, Str>), IsSame<S, str::Lines>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  Option<Str> next() {
+    Str &remain = self().remain;
+    if (remain.is_empty()) {
+      return None{};
+    }
+    usize index = remain.find_byte('\n').unwrap_or(remain.len());
+    Str line = remain.get(0, index).unwrap();
+    usize next = index < remain.len() ? index + 1 : index;
+    remain = remain.get(next, remain.len()).unwrap();
+    if (line.ends_with(Str::from_static("\r"))) {
+      line = line.get(0, line.len() - 1).unwrap();
+    }
+    return make_some(line);
+  }
+};
+
+namespace str {
+struct crust_ebco Utf8Error :
+    Impl<Utf8Error, Trait<cmp::PartialEq>, Trait<cmp::Eq>> {
+private:
+  usize valid_len;
+  usize invalid_len;
+
+public:
+  Utf8Error(usize valid_up_to, usize error_len) :
+      valid_len{valid_up_to}, invalid_len{error_len} {}
+
+  /// length of the longest valid prefix.
+  usize valid_up_to() const { return valid_len; }
+
+  /// length of the invalid sequence, `None' if the input ended in the middle
+  /// of a character.
+  Option<usize> error_len() const {
+    return invalid_len == 0 ? make_none<usize>() : make_some(invalid_len);
+  }
+};
+
+struct crust_ebco Split : Impl<Split, Trait<iter::Iterator, Str>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  Str remain;
+  Str separator;
+  bool finished;
+
+public:
+  Split(Str remain, Str separator) :
+      remain{remain}, separator{separator}, finished{false} {}
+};
+
+struct crust_ebco Lines : Impl<Lines, Trait<iter::Iterator, Str>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  Str remain;
+
+public:
+  explicit Lines(Str remain) : remain{remain} {}
+};
+} // namespace str
+
+inline Result<Str, str::Utf8Error> Str::from_utf8(Slice<const u8> bytes) {
+  const u8 *ptr = bytes.as_ptr();
+  usize len = bytes.len();
+  usize i = 0;
+
+  while (true) {
+    i += _impl_str::ascii_prefix(ptr + i, len - i);
+    if (i == len) {
+      return Ok<Str>{Str{ptr, len}};
+    }
+    usize error_len = 0;
+    usize width = _impl_str::validate_char(ptr + i, len - i, error_len);
+    if (width == 0) {
+      return Err<str::Utf8Error>{str::Utf8Error{i, error_len}};
+    }
+    i += width;
+  }
+}
+
+inline str::Split Str::split(Str separator) const {
+  return str::Split{*this, separator};
+}
+
+inline str::Lines Str::lines() const { return str::Lines{*this}; }
+
+namespace fmt {
+inline bool Formatter::write_str(Str str) {
+  return write(sink, str.as_ptr(), str.len());
+}
+} // namespace fmt
+} // namespace crust
+
+
+#endif // CRUST_STR_HPP
@@ -0,0 +1,347 @@
+#ifndef CRUST_STRING_HPP
+#define CRUST_STRING_HPP
+
+
+#include <cstring>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/fmt/mod.hpp"
+#include "crust/hash/mod.hpp"
+#include "crust/option.hpp"
+#include "crust/result.hpp"
+#include "crust/slice.hpp"
+#include "crust/str.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+struct String;
+
+template <class S>
+CRUST_IMPL_FOR(clone::Clone<S>, IsSame<S, String>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  Self clone() const { return Self::from(self().as_str()); }
+
+  void clone_from(const Self &other) {
+    self().clear();
+    self().push_str(other.as_str());
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::PartialEq<S>, IsSame<S, String>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  bool eq(const Self &other) const { return self().as_str() == other.as_str(); }
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::Eq<S>, IsSame<S, String>){};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::PartialOrd<S>, IsSame<S, String>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  Option<cmp::Ordering> partial_cmp(const Self &other) const {
+    return make_some(self().as_str().cmp(other.as_str()));
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::Ord<S>, IsSame<S, String>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  cmp::Ordering cmp(const Self &other) const {
+    return self().as_str().cmp(other.as_str());
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(hash::Hash<S>, IsSame<S, String>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  template <class H>
+  void hash(H &state) const { self().as_str().hash(state); }
+};
+
+template <class S>
+CRUST_IMPL_FOR(fmt::Display<S>, IsSame<S, String>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  bool fmt_display(fmt::Formatter &fmt) const {
+    return fmt.write_str(self().as_str());
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(fmt::Debug<S>, IsSame<S, String>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  bool fmt_debug(fmt::Formatter &fmt) const {
+    return self().as_str().fmt_debug(fmt);
+  }
+};
+
+/// owned utf-8 string. strings of up to 23 bytes (on 64 bit targets) are
+/// stored inline, the last byte of the object tells the two layouts apart.
+struct crust_ebco String :
+    Impl<
+        String,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<cmp::PartialOrd>,
+        Trait<cmp::Ord>,
+        Trait<hash::Hash>,
+        Trait<fmt::Debug>,
+        Trait<fmt::Display>> {
+private:
+  struct Heap {
+    u8 *ptr;
+    usize len;
+    usize cap;
+  };
+
+  static constexpr usize INLINE_CAP = sizeof(Heap) - 1;
+
+  struct Small {
+    u8 data[INLINE_CAP];
+    u8 len;
+  };
+
+  union Repr {
+    Heap heap;
+    Small small;
+  };
+
+  /// set in the last byte for heap strings, inline lengths never reach it.
+  static constexpr u8 HEAP_TAG = 0x80;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  static usize encode_cap(usize cap) { return (cap << 8) | HEAP_TAG; }
+
+  static usize decode_cap(usize cap) { return cap >> 8; }
+#else
+  static constexpr usize CAP_FLAG = static_cast<usize>(HEAP_TAG)
+      << (8 * (sizeof(usize) - 1));
+
+  static usize encode_cap(usize cap) { return cap | CAP_FLAG; }
+
+  static usize decode_cap(usize cap) { return cap & ~CAP_FLAG; }
+#endif
+
+  Repr repr;
+
+  u8 tag() const {
+    return reinterpret_cast<const u8 *>(&repr)[sizeof(Repr) - 1];
+  }
+
+  bool is_inline() const { return (tag() & HEAP_TAG) == 0; }
+
+  u8 *as_mut_ptr() { return is_inline() ? repr.small.data : repr.heap.ptr; }
+
+  void set_len(usize len) {
+    if (is_inline()) {
+      repr.small.len = static_cast<u8>(len);
+    } else {
+      repr.heap.len = len;
+    }
+  }
+
+  void set_capacity(usize new_cap) {
+    usize size = len();
+    if (is_inline()) {
+      u8 *ptr = static_cast<u8 *>(alloc::Global{}.allocate(new_cap, 1));
+      std::memcpy(ptr, repr.small.data, size);
+      repr.heap.ptr = ptr;
+      repr.heap.len = size;
+    } else {
+      repr.heap.ptr = static_cast<u8 *>(
+          alloc::Global{}.grow(repr.heap.ptr, capacity(), new_cap, 1));
+    }
+    repr.heap.cap = encode_cap(new_cap);
+  }
+
+  void drop() {
+    if (!is_inline()) {
+      alloc::Global{}.deallocate(repr.heap.ptr, capacity(), 1);
+    }
+  }
+
+  static bool write(void *self, const u8 *ptr, usize len) {
+    static_cast<String *>(self)->push_str(
+        Str::from_utf8_unchecked(Slice<const u8>::from_raw_parts(ptr, len)));
+    return true;
+  }
+
+  void take_from(String &other) {
+    repr = other.repr;
+    other.repr.small.len = 0;
+  }
+
+public:
+  String() { repr.small.len = 0; }
+
+  static String from(Str str) {
+    String ret;
+    ret.push_str(str);
+    return ret;
+  }
+
+  static String with_capacity(usize cap) {
+    String ret;
+    ret.reserve(cap);
+    return ret;
+  }
+
+  static Result<String, str::Utf8Error> from_utf8(Slice<const u8> bytes) {
+    return Str::from_utf8(bytes).visit<Result<String, str::Utf8Error>>(
+        [](const Ok<Str> &str) { return Ok<String>{from(str.get<0>())}; },
+        [](const Err<str::Utf8Error> &err) { return err; });
+  }
+
+  String(const String &) = delete;
+
+  String(String &&other) noexcept { take_from(other); }
+
+  String &operator=(const String &) = delete;
+
+  String &operator=(String &&other) noexcept {
+    if (this != &other) {
+      drop();
+      take_from(other);
+    }
+
+    return *this;
+  }
+
+  usize len() const { return is_inline() ? repr.small.len : repr.heap.len; }
+
+  usize capacity() const {
+    return is_inline() ? INLINE_CAP : decode_cap(repr.heap.cap);
+  }
+
+  bool is_empty() const { return len() == 0; }
+
+  const u8 *as_ptr() const {
+    return is_inline() ? repr.small.data : repr.heap.ptr;
+  }
+
+  Str as_str() const { return Str::from_utf8_unchecked(as_bytes()); }
+
+  Slice<const u8> as_bytes() const {
+    return Slice<const u8>::from_raw_parts(as_ptr(), len());
+  }
+
+  void reserve(usize additional) {
+    usize size = len();
+    usize cap = capacity();
+    if (cap - size >= additional) {
+      return;
+    }
+    usize new_cap = cap * 2;
+    if (new_cap < size + additional) {
+      new_cap = size + additional;
+    }
+    set_capacity(new_cap);
+  }
+
+  /// `str' may borrow from this string, then it is rebased after the bytes
+  /// move.
+  void push_str(Str str) {
+    usize size = len();
+    const u8 *src = str.as_ptr();
+    const u8 *begin = as_ptr();
+    bool inside = src >= begin && src < begin + size;
+    usize offset = inside ? static_cast<usize>(src - begin) : 0;
+    reserve(str.len());
+    if (inside) {
+      src = as_ptr() + offset;
+    }
+    std::memcpy(as_mut_ptr() + size, src, str.len());
+    set_len(size + str.len());
+  }
+
+  /// appends the utf-8 encoding of code point `ch'.
+  void push(u32 ch) {
+    crust_debug_assert(ch < 0xD800 || (ch > 0xDFFF && ch <= 0x10FFFF));
+
+    u8 buffer[4];
+    usize width;
+    if (ch < 0x80) {
+      buffer[0] = static_cast<u8>(ch);
+      width = 1;
+    } else if (ch < 0x800) {
+      buffer[0] = static_cast<u8>(0xC0 | (ch >> 6));
+      buffer[1] = static_cast<u8>(0x80 | (ch & 0x3F));
+      width = 2;
+    } else if (ch < 0x10000) {
+      buffer[0] = static_cast<u8>(0xE0 | (ch >> 12));
+      buffer[1] = static_cast<u8>(0x80 | ((ch >> 6) & 0x3F));
+      buffer[2] = static_cast<u8>(0x80 | (ch & 0x3F));
+      width = 3;
+    } else {
+      buffer[0] = static_cast<u8>(0xF0 | (ch >> 18));
+      buffer[1] = static_cast<u8>(0x80 | ((ch >> 12) & 0x3F));
+      buffer[2] = static_cast<u8>(0x80 | ((ch >> 6) & 0x3F));
+      buffer[3] = static_cast<u8>(0x80 | (ch & 0x3F));
+      width = 4;
+    }
+
+    push_str(Str::from_utf8_unchecked(
+        Slice<const u8>::from_raw_parts(buffer, width)));
+  }
+
+  /// removes and returns the last code point.
+  Option<u32> pop() {
+    usize size = len();
+    if (size == 0) {
+      return None{};
+    }
+    const u8 *ptr = as_ptr();
+    usize start = size - 1;
+    while (_impl_str::is_continuation(ptr[start])) {
+      --start;
+    }
+    u32 ch = ptr[start];
+    if (size - start > 1) {
+      ch &= 0x7F >> (size - start);
+      for (usize i = start + 1; i < size; ++i) {
+        ch = (ch << 6) | (ptr[i] & 0x3F);
+      }
+    }
+    set_len(start);
+    return make_some(ch);
+  }
+
+  void truncate(usize new_len) {
+    if (new_len < len()) {
+      if (!as_str().is_char_boundary(new_len)) {
+        crust_panic("truncate not on a char boundary!");
+      }
+      set_len(new_len);
+    }
+  }
+
+  void clear() { set_len(0); }
+
+  /// formatter appending to this string.
+  fmt::Formatter formatter() { return fmt::Formatter{this, write}; }
+
+  ~String() { drop(); }
+};
+
+template <class T>
+String to_string(const T &value) {
+  String ret;
+  fmt::Formatter fmt = ret.formatter();
+  value.fmt_display(fmt);
+  return ret;
+}
+} // namespace crust
+
+
+#endif // CRUST_STRING_HPP
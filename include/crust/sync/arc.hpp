@@ -0,0 +1,96 @@
+#ifndef CRUST_SYNC_ARC_HPP
+#define CRUST_SYNC_ARC_HPP
+
+
+#include <atomic>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/rc.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace _impl_rc {
+/// thread safe `Count'. increments are relaxed since a new reference can only
+/// be made from an existing one, the final decrement synchronizes with every
+/// earlier one before the value is destroyed.
+struct AtomicCount {
+private:
+  static constexpr usize LOCKED = ~static_cast<usize>(0);
+
+  std::atomic<usize> value;
+
+public:
+  explicit AtomicCount(usize value) : value{value} {}
+
+  usize load() const { return value.load(std::memory_order_acquire); }
+
+  void increment() { value.fetch_add(1, std::memory_order_relaxed); }
+
+  void increment_unlocked() {
+    usize current = value.load(std::memory_order_relaxed);
+    while (true) {
+      if (current == LOCKED) {
+        current = value.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (value.compare_exchange_weak(
+              current,
+              current + 1,
+              std::memory_order_acquire,
+              std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  bool decrement() {
+    if (value.fetch_sub(1, std::memory_order_release) != 1) {
+      return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+  }
+
+  bool increment_if_nonzero() {
+    usize current = value.load(std::memory_order_relaxed);
+    while (current != 0) {
+      if (value.compare_exchange_weak(
+              current,
+              current + 1,
+              std::memory_order_acquire,
+              std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool claim_last() {
+    usize expected = 1;
+    return value.compare_exchange_strong(
+        expected, 0, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  bool lock() {
+    usize expected = 1;
+    return value.compare_exchange_strong(
+        expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  void unlock() { value.store(1, std::memory_order_release); }
+};
+} // namespace _impl_rc
+
+namespace sync {
+/// atomically reference counted pointer, shareable across threads.
+template <class T, class A = alloc::Global>
+using Arc = _impl_rc::Strong<T, _impl_rc::AtomicCount, A>;
+
+template <class T, class A = alloc::Global>
+using Weak = _impl_rc::Weak<T, _impl_rc::AtomicCount, A>;
+} // namespace sync
+} // namespace crust
+
+
+#endif // CRUST_SYNC_ARC_HPP
@@ -0,0 +1,365 @@
+#ifndef CRUST_SYNC_INTERNER_HPP
+#define CRUST_SYNC_INTERNER_HPP
+
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#include "crust/alloc/arena.hpp"
+#include "crust/alloc/mod.hpp"
+#include "crust/cmp.hpp"
+#include "crust/hash/mod.hpp"
+#include "crust/num/mod.hpp"
+#include "crust/option.hpp"
+#include "crust/str.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace sync {
+/// interned string, compared, ordered and hashed by its id alone. the order
+/// is the order of interning, not the order of the strings.
+struct Symbol;
+
+struct Interner;
+} // namespace sync
+
+template <class S>
+CRUST_IMPL_FOR(cmp::PartialEq<S>, IsSame<S, sync::Symbol>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  bool eq(const Self &other) const { return self().id == other.id; }
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::Eq<S>, IsSame<S, sync::Symbol>){};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::PartialOrd<S>, IsSame<S, sync::Symbol>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  Option<cmp::Ordering> partial_cmp(const Self &other) const {
+    return make_some(self().cmp(other));
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(cmp::Ord<S>, IsSame<S, sync::Symbol>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  cmp::Ordering cmp(const Self &other) const {
+    return operator_cmp(self().id, other.id);
+  }
+};
+
+template <class S>
+CRUST_IMPL_FOR(hash::Hash<S>, IsSame<S, sync::Symbol>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  template <class H>
+  void hash(H &state) const {
+    state.write_u32(self().id);
+  }
+};
+
+namespace sync {
+struct crust_ebco Symbol :
+    Impl<
+        Symbol,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<cmp::PartialOrd>,
+        Trait<cmp::Ord>,
+        Trait<hash::Hash>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  friend struct Interner;
+
+  u32 id;
+
+  explicit constexpr Symbol(u32 id) : id{id} {}
+
+public:
+  constexpr u32 as_u32() const { return id; }
+};
+} // namespace sync
+
+namespace _impl_interner {
+constexpr usize SHARDS = 16;
+constexpr usize MIN_SLOTS = 64;
+constexpr usize MIN_ENTRIES = 64;
+/// enough doubling segments to address every `u32' id.
+constexpr usize SEGMENTS = 27;
+constexpr u64 MAX_IDS = 0xFFFFFFFF;
+
+struct Entry {
+  const u8 *ptr;
+  usize len;
+};
+
+/// open addressing table of one shard. a slot holds the upper half of the
+/// string's hash next to its id plus one, zero is vacant. slots are only
+/// written under the shard's lock and published with release stores, so
+/// readers probe without locking.
+struct Table {
+  usize mask;
+  /// the table this one replaced. readers may still be probing it, so
+  /// replaced tables are kept until the interner is dropped, which costs at
+  /// most as much as the live table.
+  Table *prev;
+
+  std::atomic<u64> *slots() {
+    return reinterpret_cast<std::atomic<u64> *>(this + 1);
+  }
+
+  const std::atomic<u64> *slots() const {
+    return reinterpret_cast<const std::atomic<u64> *>(this + 1);
+  }
+
+  static usize size_of(usize len) {
+    return sizeof(Table) + len * sizeof(std::atomic<u64>);
+  }
+
+  static Table *create(usize len, Table *prev) {
+    void *raw = alloc::Global{}.allocate(size_of(len), alignof(Table));
+    Table *table = new (raw) Table{len - 1, prev};
+    for (usize i = 0; i < len; ++i) {
+      new (table->slots() + i) std::atomic<u64>{0};
+    }
+    return table;
+  }
+
+  static void destroy(Table *table) {
+    while (table != nullptr) {
+      Table *prev = table->prev;
+      alloc::Global{}.deallocate(
+          table, size_of(table->mask + 1), alignof(Table));
+      table = prev;
+    }
+  }
+};
+
+/// a cache line of its own, so threads busy on neighbouring shards do not
+/// invalidate each other's `lock' and `table'.
+struct alignas(CACHE_LINE) Shard {
+  std::mutex lock;
+  std::atomic<Table *> table;
+  /// guarded by `lock' from here on.
+  usize items;
+  alloc::Arena bytes;
+
+  Shard() : table{nullptr}, items{0} {}
+
+  ~Shard() { Table::destroy(table.load(std::memory_order_relaxed)); }
+};
+
+/// segment `k' holds `MIN_ENTRIES << k' entries, so the ids of an index
+/// never move once written.
+crust_always_inline usize segment_of(u32 id) {
+  return 63 - num::leading_zeros(id / MIN_ENTRIES + 1);
+}
+
+crust_always_inline usize segment_start(usize segment) {
+  return MIN_ENTRIES * ((usize{1} << segment) - 1);
+}
+} // namespace _impl_interner
+
+namespace sync {
+/// thread safe string interner mapping strings to dense `Symbol' ids. the
+/// bytes of every string are copied once into an append-only arena and stay
+/// put for the life of the interner. lookups are split over shards by hash
+/// and never lock, only the first `intern' of a string takes its shard's
+/// lock.
+struct Interner {
+private:
+  using Entry = _impl_interner::Entry;
+  using Shard = _impl_interner::Shard;
+  using Table = _impl_interner::Table;
+
+  hash::RandomState hash_builder;
+  std::atomic<u64> next_id;
+  std::atomic<Entry *> segments[_impl_interner::SEGMENTS];
+  Shard shards[_impl_interner::SHARDS];
+
+  static usize shard_of(u64 hash) {
+    return static_cast<usize>(hash >> 60) & (_impl_interner::SHARDS - 1);
+  }
+
+  const Entry &entry_of(u32 id) const {
+    usize segment = _impl_interner::segment_of(id);
+    const Entry *entries = segments[segment].load(std::memory_order_acquire);
+    return entries[id - _impl_interner::segment_start(segment)];
+  }
+
+  static Str str_of(const Entry &entry) {
+    return Str::from_utf8_unchecked(
+        Slice<const u8>::from_raw_parts(entry.ptr, entry.len));
+  }
+
+  Option<Symbol> find(const Table *table, u64 hash, Str str) const {
+    if (table == nullptr) {
+      return None{};
+    }
+    u64 tag = hash >> 32;
+    for (usize i = hash & table->mask;; i = (i + 1) & table->mask) {
+      u64 slot = table->slots()[i].load(std::memory_order_acquire);
+      if (slot == 0) {
+        return None{};
+      }
+      u32 id = static_cast<u32>(slot) - 1;
+      if (slot >> 32 == tag && str_of(entry_of(id)) == str) {
+        return make_some(Symbol{id});
+      }
+    }
+  }
+
+  /// segments are created by whichever thread needs one first.
+  Entry *segment_for(usize segment) {
+    Entry *entries = segments[segment].load(std::memory_order_acquire);
+    if (entries != nullptr) {
+      return entries;
+    }
+    usize size = sizeof(Entry) * (_impl_interner::MIN_ENTRIES << segment);
+    Entry *fresh =
+        static_cast<Entry *>(alloc::Global{}.allocate(size, alignof(Entry)));
+    if (segments[segment].compare_exchange_strong(
+            entries,
+            fresh,
+            std::memory_order_acq_rel,
+            std::memory_order_acquire)) {
+      return fresh;
+    }
+    alloc::Global{}.deallocate(fresh, size, alignof(Entry));
+    return entries;
+  }
+
+  static void insert_slot(Table *table, u64 hash, u64 slot) {
+    usize i = hash & table->mask;
+    while (table->slots()[i].load(std::memory_order_relaxed) != 0) {
+      i = (i + 1) & table->mask;
+    }
+    table->slots()[i].store(slot, std::memory_order_release);
+  }
+
+  /// keeps the load below three quarters, so probes stay short and always
+  /// end at a vacant slot.
+  void reserve_slot(Shard &shard) {
+    Table *table = shard.table.load(std::memory_order_relaxed);
+    usize len = table == nullptr ? 0 : table->mask + 1;
+    if ((shard.items + 1) * 4 <= len * 3) {
+      return;
+    }
+    usize new_len = len == 0 ? _impl_interner::MIN_SLOTS : len * 2;
+    Table *fresh = Table::create(new_len, table);
+    for (usize i = 0; i < len; ++i) {
+      u64 slot = table->slots()[i].load(std::memory_order_relaxed);
+      if (slot != 0) {
+        u32 id = static_cast<u32>(slot) - 1;
+        u64 hash = hash::hash_one(hash_builder, str_of(entry_of(id)));
+        insert_slot(fresh, hash, slot);
+      }
+    }
+    shard.table.store(fresh, std::memory_order_release);
+  }
+
+public:
+  Interner() : next_id{0} {
+    for (usize i = 0; i < _impl_interner::SEGMENTS; ++i) {
+      segments[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  Interner(const Interner &) = delete;
+
+  Interner &operator=(const Interner &) = delete;
+
+  /// shared by the whole process.
+  static Interner &global() {
+    static Interner interner;
+    return interner;
+  }
+
+  /// the symbol of `str', interning a copy of it on first sight.
+  Symbol intern(Str str) {
+    u64 hash = hash::hash_one(hash_builder, str);
+    Shard &shard = shards[shard_of(hash)];
+    Option<Symbol> found =
+        find(shard.table.load(std::memory_order_acquire), hash, str);
+    if (found.is_some()) {
+      return move(found).unwrap();
+    }
+
+    std::lock_guard<std::mutex> guard{shard.lock};
+    found = find(shard.table.load(std::memory_order_relaxed), hash, str);
+    if (found.is_some()) {
+      return move(found).unwrap();
+    }
+    u64 id = next_id.fetch_add(1, std::memory_order_relaxed);
+    if (id >= _impl_interner::MAX_IDS) {
+      crust_panic("interner is full!");
+    }
+    u32 index = static_cast<u32>(id);
+
+    Entry entry{reinterpret_cast<const u8 *>(""), str.len()};
+    if (!str.is_empty()) {
+      void *bytes = shard.bytes.allocate(str.len(), 1);
+      std::memcpy(bytes, str.as_ptr(), str.len());
+      entry.ptr = static_cast<const u8 *>(bytes);
+    }
+    usize segment = _impl_interner::segment_of(index);
+    segment_for(segment)[index - _impl_interner::segment_start(segment)] =
+        entry;
+
+    reserve_slot(shard);
+    insert_slot(
+        shard.table.load(std::memory_order_relaxed),
+        hash,
+        (hash >> 32) << 32 | (id + 1));
+    ++shard.items;
+    return Symbol{index};
+  }
+
+  /// the symbol of `str' if it was interned already, never locks.
+  Option<Symbol> get(Str str) const {
+    u64 hash = hash::hash_one(hash_builder, str);
+    const Shard &shard = shards[shard_of(hash)];
+    return find(shard.table.load(std::memory_order_acquire), hash, str);
+  }
+
+  /// the interned string, valid as long as the interner. `symbol' must come
+  /// from this interner.
+  Str resolve(Symbol symbol) const {
+    if (symbol.id >= len()) {
+      crust_panic("symbol out of boundary!");
+    }
+    return str_of(entry_of(symbol.id));
+  }
+
+  /// symbols handed out so far.
+  usize len() const {
+    return static_cast<usize>(next_id.load(std::memory_order_acquire));
+  }
+
+  bool is_empty() const { return len() == 0; }
+
+  ~Interner() {
+    for (usize i = 0; i < _impl_interner::SEGMENTS; ++i) {
+      Entry *entries = segments[i].load(std::memory_order_relaxed);
+      if (entries != nullptr) {
+        alloc::Global{}.deallocate(
+            entries,
+            sizeof(Entry) * (_impl_interner::MIN_ENTRIES << i),
+            alignof(Entry));
+      }
+    }
+  }
+};
+} // namespace sync
+} // namespace crust
+
+
+#endif // CRUST_SYNC_INTERNER_HPP
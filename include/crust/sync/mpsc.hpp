@@ -0,0 +1,753 @@
+#ifndef CRUST_SYNC_MPSC_HPP
+#define CRUST_SYNC_MPSC_HPP
+
+
+#include <atomic>
+#include <new>
+#include <thread>
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/option.hpp"
+#include "crust/result.hpp"
+#include "crust/tuple.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace sync {
+namespace mpsc {
+/// returned by `send' once every receiver is gone, with the value that could
+/// not be sent.
+template <class T>
+struct SendError;
+
+/// returned by `recv' once every sender is gone and the channel is drained.
+struct RecvError;
+} // namespace mpsc
+} // namespace sync
+
+template <class T>
+struct BluePrint<sync::mpsc::SendError<T>> : TmplType<TupleStruct<T>> {};
+
+template <>
+struct BluePrint<sync::mpsc::RecvError> : TmplType<TupleStruct<>> {};
+
+namespace sync {
+namespace mpsc {
+template <class T>
+struct crust_ebco SendError :
+    TupleStruct<T>,
+    Derive<SendError<T>, Trait<cmp::PartialEq>, Trait<cmp::Eq>> {
+  CRUST_USE_BASE_CONSTRUCTORS(SendError, TupleStruct<T>);
+
+  T into_inner() && { return move(this->template get<0>()); }
+};
+
+struct crust_ebco RecvError :
+    TupleStruct<>,
+    Derive<RecvError, Trait<cmp::PartialEq>, Trait<cmp::Eq>> {
+  CRUST_USE_BASE_CONSTRUCTORS(RecvError, TupleStruct<>);
+};
+} // namespace mpsc
+} // namespace sync
+
+namespace _impl_mpsc {
+/// failed attempts before a blocking call parks its thread.
+constexpr usize SPIN_ROUNDS = 32;
+
+#if defined(__linux__)
+inline void futex_wait(std::atomic<u32> &word, u32 expected) {
+  syscall(
+      SYS_futex,
+      reinterpret_cast<u32 *>(&word),
+      FUTEX_WAIT_PRIVATE,
+      expected,
+      nullptr,
+      nullptr,
+      0);
+}
+
+inline void futex_wake(std::atomic<u32> &word, int count) {
+  syscall(
+      SYS_futex,
+      reinterpret_cast<u32 *>(&word),
+      FUTEX_WAKE_PRIVATE,
+      count,
+      nullptr,
+      nullptr,
+      0);
+}
+#endif
+
+/// event count threads park on until the other side makes progress. a
+/// waiter registers itself before its last look at the queue and the
+/// notifier checks for waiters only after publishing, so with the fences in
+/// between one of them always sees the other. notifying costs a single load
+/// while nobody waits.
+struct Waker {
+private:
+  std::atomic<u32> seq;
+  std::atomic<u32> waiters;
+#if !defined(__linux__)
+  std::mutex lock;
+  std::condition_variable cond;
+#endif
+
+  void notify(bool all) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+    seq.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+    futex_wake(seq, all ? INT_MAX : 1);
+#else
+    static_cast<void>(all);
+    { std::lock_guard<std::mutex> guard{lock}; }
+    cond.notify_all();
+#endif
+  }
+
+public:
+  Waker() : seq{0}, waiters{0} {}
+
+  /// to be followed by one more look at the queue, then `wait' or `cancel'.
+  u32 prepare() {
+    waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return seq.load(std::memory_order_relaxed);
+  }
+
+  void cancel() { waiters.fetch_sub(1, std::memory_order_relaxed); }
+
+  /// returns once notified after `prepare', or spuriously.
+  void wait(u32 seen) {
+#if defined(__linux__)
+    futex_wait(seq, seen);
+#else
+    std::unique_lock<std::mutex> guard{lock};
+    while (seq.load(std::memory_order_relaxed) == seen) {
+      cond.wait(guard);
+    }
+#endif
+    waiters.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void notify_one() { notify(false); }
+
+  void notify_all() { notify(true); }
+};
+
+template <class T>
+Result<Tuple<>, sync::mpsc::SendError<T>> send_error(T &&value) {
+  return Err<sync::mpsc::SendError<T>>{
+      sync::mpsc::SendError<T>{move(value)}};
+}
+
+/// unbounded queue of linked blocks. senders claim a position with one
+/// atomic increment and write their slot, the single receiver reads slots
+/// in order without any read-modify-write and frees blocks behind it.
+template <class T>
+struct List {
+  using Item = T;
+
+  static constexpr bool MULTI_CONSUMER = false;
+
+private:
+  /// positions per block, the last one of each lap only marks the move to
+  /// the next block.
+  static constexpr usize LAP = 32;
+  static constexpr usize BLOCK = LAP - 1;
+
+  struct Slot {
+    std::atomic<u32> ready;
+    Uninit<T> value;
+
+    Slot() : ready{0} {}
+  };
+
+  struct Block {
+    std::atomic<Block *> next;
+    Slot slots[BLOCK];
+
+    Block() : next{nullptr} {}
+
+    static Block *create() {
+      void *raw = alloc::Global{}.allocate(sizeof(Block), alignof(Block));
+      return new (raw) Block{};
+    }
+
+    static void destroy(Block *block) {
+      block->~Block();
+      alloc::Global{}.deallocate(block, sizeof(Block), alignof(Block));
+    }
+  };
+
+  struct alignas(CACHE_LINE) Tail {
+    std::atomic<usize> index;
+    std::atomic<Block *> block;
+  };
+
+  struct alignas(CACHE_LINE) Head {
+    usize index;
+    Block *block;
+  };
+
+  Tail tail;
+  Head head;
+  std::atomic<bool> senders_gone;
+  std::atomic<bool> receivers_gone;
+
+  /// the sender taking the last slot of a block installs the next one,
+  /// which it allocates before claiming so the others wait only briefly.
+  void push(T &&value) {
+    usize t = tail.index.load(std::memory_order_acquire);
+    Block *block = tail.block.load(std::memory_order_acquire);
+    Block *next = nullptr;
+    while (true) {
+      usize offset = t % LAP;
+      if (offset == BLOCK) {
+        std::this_thread::yield();
+        t = tail.index.load(std::memory_order_acquire);
+        block = tail.block.load(std::memory_order_acquire);
+        continue;
+      }
+      if (offset + 1 == BLOCK && next == nullptr) {
+        next = Block::create();
+      }
+      if (tail.index.compare_exchange_weak(
+              t, t + 1, std::memory_order_seq_cst, std::memory_order_acquire)) {
+        if (offset + 1 == BLOCK) {
+          tail.block.store(next, std::memory_order_release);
+          tail.index.fetch_add(1, std::memory_order_release);
+          block->next.store(next, std::memory_order_release);
+          next = nullptr;
+        }
+        Slot &slot = block->slots[offset];
+        new (&slot.value.value) T{move(value)};
+        slot.ready.store(1, std::memory_order_release);
+        break;
+      }
+      block = tail.block.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+      Block::destroy(next);
+    }
+  }
+
+public:
+  List() :
+      tail{{0}, {nullptr}},
+      head{0, nullptr},
+      senders_gone{false},
+      receivers_gone{false} {
+    Block *block = Block::create();
+    tail.block.store(block, std::memory_order_relaxed);
+    head.block = block;
+  }
+
+  Waker not_empty;
+
+  Result<Tuple<>, sync::mpsc::SendError<T>> send(T &&value) {
+    if (receivers_gone.load(std::memory_order_acquire)) {
+      return send_error(move(value));
+    }
+    push(move(value));
+    not_empty.notify_one();
+    return Ok<Tuple<>>{Tuple<>{}};
+  }
+
+  /// receiver only. a sender that claimed the next slot but has not
+  /// written it yet is waited for, it is never blocked in between.
+  Option<T> pop() {
+    usize h = head.index;
+    if (h == tail.index.load(std::memory_order_acquire)) {
+      return None{};
+    }
+    usize offset = h % LAP;
+    Slot &slot = head.block->slots[offset];
+    while (slot.ready.load(std::memory_order_acquire) == 0) {
+      std::this_thread::yield();
+    }
+    Option<T> ret = make_some(move(slot.value.value));
+    slot.value.value.~T();
+    if (offset + 1 == BLOCK) {
+      Block *next = head.block->next.load(std::memory_order_acquire);
+      while (next == nullptr) {
+        std::this_thread::yield();
+        next = head.block->next.load(std::memory_order_acquire);
+      }
+      Block::destroy(head.block);
+      head.block = next;
+      h += 2;
+    } else {
+      h += 1;
+    }
+    head.index = h;
+    return ret;
+  }
+
+  bool is_disconnected() const {
+    return senders_gone.load(std::memory_order_acquire);
+  }
+
+  void disconnect_senders() {
+    senders_gone.store(true, std::memory_order_release);
+    not_empty.notify_all();
+  }
+
+  void disconnect_receivers() {
+    receivers_gone.store(true, std::memory_order_release);
+  }
+
+  /// every handle is gone, so are all concurrent writers.
+  ~List() {
+    usize h = head.index;
+    usize t = tail.index.load(std::memory_order_relaxed);
+    Block *block = head.block;
+    for (; h != t; ++h) {
+      if (h % LAP == BLOCK) {
+        Block *next = block->next.load(std::memory_order_relaxed);
+        Block::destroy(block);
+        block = next;
+      } else {
+        block->slots[h % LAP].value.value.~T();
+      }
+    }
+    Block::destroy(block);
+  }
+};
+
+/// bounded queue over a ring of stamped slots. a slot's stamp says which
+/// lap may write or read it next, so senders and receivers each claim a
+/// position with one compare and swap and never touch the same slot at
+/// once.
+template <class T>
+struct Array {
+  using Item = T;
+
+  static constexpr bool MULTI_CONSUMER = true;
+
+private:
+  struct Slot {
+    std::atomic<usize> stamp;
+    Uninit<T> value;
+  };
+
+  struct alignas(CACHE_LINE) Index {
+    std::atomic<usize> value;
+  };
+
+  Index head;
+  Index tail;
+  Slot *buffer;
+  usize cap;
+  /// positions are a lap count above the slot index, one lap is the power
+  /// of two above the capacity.
+  usize one_lap;
+  std::atomic<bool> senders_gone;
+  std::atomic<bool> receivers_gone;
+
+  static usize lap_of(usize cap) {
+    usize ret = 1;
+    while (ret <= cap) {
+      ret *= 2;
+    }
+    return ret;
+  }
+
+  usize next_position(usize position) const {
+    usize index = position & (one_lap - 1);
+    usize lap = position & ~(one_lap - 1);
+    return index + 1 < cap ? position + 1 : lap + one_lap;
+  }
+
+  /// moves out of `value' only on success.
+  bool push(T &value) {
+    usize t = tail.value.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = buffer[t & (one_lap - 1)];
+      usize stamp = slot.stamp.load(std::memory_order_acquire);
+      if (stamp == t) {
+        if (tail.value.compare_exchange_weak(
+                t,
+                next_position(t),
+                std::memory_order_seq_cst,
+                std::memory_order_relaxed)) {
+          new (&slot.value.value) T{move(value)};
+          slot.stamp.store(t + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (stamp + one_lap == t + 1) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (head.value.load(std::memory_order_relaxed) + one_lap == t) {
+          return false;
+        }
+        t = tail.value.load(std::memory_order_relaxed);
+      } else {
+        std::this_thread::yield();
+        t = tail.value.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+public:
+  explicit Array(usize cap) :
+      head{{0}},
+      tail{{0}},
+      cap{cap},
+      one_lap{lap_of(cap)},
+      senders_gone{false},
+      receivers_gone{false} {
+    if (cap == 0) {
+      crust_panic("channel capacity must be positive!");
+    }
+    void *raw = alloc::Global{}.allocate(sizeof(Slot) * cap, alignof(Slot));
+    buffer = static_cast<Slot *>(raw);
+    for (usize i = 0; i < cap; ++i) {
+      new (&buffer[i].stamp) std::atomic<usize>{i};
+    }
+  }
+
+  Waker not_empty;
+  Waker not_full;
+
+  /// blocks while the channel is full.
+  Result<Tuple<>, sync::mpsc::SendError<T>> send(T &&value) {
+    usize spins = 0;
+    while (true) {
+      if (receivers_gone.load(std::memory_order_acquire)) {
+        return send_error(move(value));
+      }
+      if (push(value)) {
+        not_empty.notify_one();
+        return Ok<Tuple<>>{Tuple<>{}};
+      }
+      if (spins < SPIN_ROUNDS) {
+        ++spins;
+        std::this_thread::yield();
+        continue;
+      }
+      u32 seen = not_full.prepare();
+      if (push(value)) {
+        not_full.cancel();
+        not_empty.notify_one();
+        return Ok<Tuple<>>{Tuple<>{}};
+      }
+      if (receivers_gone.load(std::memory_order_acquire)) {
+        not_full.cancel();
+        continue;
+      }
+      not_full.wait(seen);
+    }
+  }
+
+  Option<T> pop() {
+    usize h = head.value.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = buffer[h & (one_lap - 1)];
+      usize stamp = slot.stamp.load(std::memory_order_acquire);
+      if (stamp == h + 1) {
+        if (head.value.compare_exchange_weak(
+                h,
+                next_position(h),
+                std::memory_order_seq_cst,
+                std::memory_order_relaxed)) {
+          Option<T> ret = make_some(move(slot.value.value));
+          slot.value.value.~T();
+          slot.stamp.store(h + one_lap, std::memory_order_release);
+          not_full.notify_one();
+          return ret;
+        }
+      } else if (stamp == h) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (tail.value.load(std::memory_order_relaxed) == h) {
+          return None{};
+        }
+        h = head.value.load(std::memory_order_relaxed);
+      } else {
+        std::this_thread::yield();
+        h = head.value.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool is_disconnected() const {
+    return senders_gone.load(std::memory_order_acquire);
+  }
+
+  void disconnect_senders() {
+    senders_gone.store(true, std::memory_order_release);
+    not_empty.notify_all();
+  }
+
+  void disconnect_receivers() {
+    receivers_gone.store(true, std::memory_order_release);
+    not_full.notify_all();
+  }
+
+  ~Array() {
+    usize h = head.value.load(std::memory_order_relaxed);
+    usize t = tail.value.load(std::memory_order_relaxed);
+    for (; h != t; h = next_position(h)) {
+      buffer[h & (one_lap - 1)].value.value.~T();
+    }
+    alloc::Global{}.deallocate(buffer, sizeof(Slot) * cap, alignof(Slot));
+  }
+};
+
+/// channel shared by its handles. whichever side lets go last frees it.
+template <class C>
+struct Counter {
+  std::atomic<usize> senders;
+  std::atomic<usize> receivers;
+  std::atomic<bool> destroy;
+  C chan;
+
+  template <class... Args>
+  static Counter *create(Args &&...args) {
+    void *raw = alloc::Global{}.allocate(sizeof(Counter), alignof(Counter));
+    return new (raw) Counter{forward<Args>(args)...};
+  }
+
+  static void release(Counter *counter) {
+    if (counter->destroy.exchange(true, std::memory_order_acq_rel)) {
+      counter->~Counter();
+      alloc::Global{}.deallocate(counter, sizeof(Counter), alignof(Counter));
+    }
+  }
+
+private:
+  template <class... Args>
+  explicit Counter(Args &&...args) :
+      senders{1}, receivers{1}, destroy{false}, chan{forward<Args>(args)...} {}
+};
+
+template <class C>
+struct Tx;
+
+template <class C>
+struct Rx;
+
+struct Open;
+} // namespace _impl_mpsc
+
+template <class C>
+CRUST_IMPL_FOR(clone::Clone<_impl_mpsc::Tx<C>>) {
+  CRUST_IMPL_USE_SELF(_impl_mpsc::Tx<C>);
+
+  Self clone() const {
+    self().counter->senders.fetch_add(1, std::memory_order_relaxed);
+    return Self{self().counter};
+  }
+};
+
+template <class C>
+CRUST_IMPL_FOR(clone::Clone<_impl_mpsc::Rx<C>>, BoolVal<C::MULTI_CONSUMER>) {
+  CRUST_IMPL_USE_SELF(_impl_mpsc::Rx<C>);
+
+  Self clone() const {
+    self().counter->receivers.fetch_add(1, std::memory_order_relaxed);
+    return Self{self().counter};
+  }
+};
+
+namespace _impl_mpsc {
+template <class C>
+struct crust_ebco Tx : Impl<Tx<C>, Trait<clone::Clone>> {
+private:
+  using T = typename C::Item;
+
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  friend struct Open;
+
+  Counter<C> *counter;
+
+  explicit Tx(Counter<C> *counter) : counter{counter} {}
+
+  void drop() {
+    if (counter == nullptr) {
+      return;
+    }
+    if (counter->senders.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      counter->chan.disconnect_senders();
+      Counter<C>::release(counter);
+    }
+    counter = nullptr;
+  }
+
+public:
+  Tx(Tx &&other) noexcept : counter{other.counter} { other.counter = nullptr; }
+
+  Tx &operator=(Tx &&other) noexcept {
+    if (this != &other) {
+      drop();
+      counter = other.counter;
+      other.counter = nullptr;
+    }
+    return *this;
+  }
+
+  /// fails, handing `value' back, once every receiver is gone.
+  Result<Tuple<>, sync::mpsc::SendError<T>> send(T value) const {
+    crust_debug_assert(counter != nullptr);
+    return counter->chan.send(move(value));
+  }
+
+  ~Tx() { drop(); }
+};
+
+template <class C>
+struct crust_ebco Rx : Impl<Rx<C>, Trait<clone::Clone>> {
+private:
+  using T = typename C::Item;
+
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  friend struct Open;
+
+  Counter<C> *counter;
+
+  explicit Rx(Counter<C> *counter) : counter{counter} {}
+
+  C &chan() const { return counter->chan; }
+
+  void drop() {
+    if (counter == nullptr) {
+      return;
+    }
+    if (counter->receivers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      counter->chan.disconnect_receivers();
+      Counter<C>::release(counter);
+    }
+    counter = nullptr;
+  }
+
+  /// the senders may have left right after sending, so the queue is looked
+  /// at once more before reporting the disconnect.
+  Option<T> pop_or_disconnected(bool &disconnected) const {
+    Option<T> ret = chan().pop();
+    if (ret.is_none() && chan().is_disconnected()) {
+      ret = chan().pop();
+      disconnected = ret.is_none();
+    }
+    return ret;
+  }
+
+public:
+  Rx(Rx &&other) noexcept : counter{other.counter} { other.counter = nullptr; }
+
+  Rx &operator=(Rx &&other) noexcept {
+    if (this != &other) {
+      drop();
+      counter = other.counter;
+      other.counter = nullptr;
+    }
+    return *this;
+  }
+
+  /// `None' while the channel is empty, an error once it is also
+  /// disconnected.
+  Result<Option<T>, sync::mpsc::RecvError> try_recv() const {
+    crust_debug_assert(counter != nullptr);
+    bool disconnected = false;
+    Option<T> ret = pop_or_disconnected(disconnected);
+    if (disconnected) {
+      return Err<sync::mpsc::RecvError>{sync::mpsc::RecvError{}};
+    }
+    return Ok<Option<T>>{move(ret)};
+  }
+
+  /// waits for a value, spinning briefly before parking the thread.
+  Result<T, sync::mpsc::RecvError> recv() const {
+    crust_debug_assert(counter != nullptr);
+    usize spins = 0;
+    while (true) {
+      bool disconnected = false;
+      Option<T> ret = pop_or_disconnected(disconnected);
+      if (ret.is_some()) {
+        return Ok<T>{move(ret).unwrap()};
+      }
+      if (disconnected) {
+        return Err<sync::mpsc::RecvError>{sync::mpsc::RecvError{}};
+      }
+      if (spins < SPIN_ROUNDS) {
+        ++spins;
+        std::this_thread::yield();
+        continue;
+      }
+      u32 seen = chan().not_empty.prepare();
+      ret = chan().pop();
+      if (ret.is_some()) {
+        chan().not_empty.cancel();
+        return Ok<T>{move(ret).unwrap()};
+      }
+      if (chan().is_disconnected()) {
+        chan().not_empty.cancel();
+        continue;
+      }
+      chan().not_empty.wait(seen);
+    }
+  }
+
+  ~Rx() { drop(); }
+};
+
+struct Open {
+  template <class C, class... Args>
+  static Tuple<Tx<C>, Rx<C>> channel(Args &&...args) {
+    Counter<C> *counter = Counter<C>::create(forward<Args>(args)...);
+    return tuple(Tx<C>{counter}, Rx<C>{counter});
+  }
+};
+} // namespace _impl_mpsc
+
+namespace sync {
+namespace mpsc {
+template <class T>
+using Sender = _impl_mpsc::Tx<_impl_mpsc::List<T>>;
+
+/// receiving half of `channel', there is only one.
+template <class T>
+using Receiver = _impl_mpsc::Rx<_impl_mpsc::List<T>>;
+
+template <class T>
+using SyncSender = _impl_mpsc::Tx<_impl_mpsc::Array<T>>;
+
+/// receiving half of `sync_channel', clones share the values between them.
+template <class T>
+using SyncReceiver = _impl_mpsc::Rx<_impl_mpsc::Array<T>>;
+
+/// unbounded channel with any number of senders and a single receiver.
+/// sending never blocks and allocates once per block of slots.
+template <class T>
+Tuple<Sender<T>, Receiver<T>> channel() {
+  return _impl_mpsc::Open::channel<_impl_mpsc::List<T>>();
+}
+
+/// channel holding at most `cap' values, sending blocks while it is full.
+/// both halves may be cloned.
+template <class T>
+Tuple<SyncSender<T>, SyncReceiver<T>> sync_channel(usize cap) {
+  return _impl_mpsc::Open::channel<_impl_mpsc::Array<T>>(cap);
+}
+} // namespace mpsc
+} // namespace sync
+} // namespace crust
+
+
+#endif // CRUST_SYNC_MPSC_HPP
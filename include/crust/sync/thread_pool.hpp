@@ -0,0 +1,633 @@
+#ifndef CRUST_SYNC_THREAD_POOL_HPP
+#define CRUST_SYNC_THREAD_POOL_HPP
+
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/ops/function.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace _impl_pool {
+/// unit of work in a deque. `execute' runs the job, after which the job may
+/// no longer be touched since its owner is free to release it.
+struct Job {
+  void (*execute)(Job *);
+  /// link in the injector queue.
+  Job *next;
+};
+
+/// job owning a spawned closure, released right before the closure runs.
+struct HeapJob : Job {
+  ops::DynFnOnce<void()> task;
+
+  explicit HeapJob(ops::DynFnOnce<void()> &&task) :
+      Job{run, nullptr}, task{move(task)} {}
+
+  static Job *create(ops::DynFnOnce<void()> &&task) {
+    void *raw = alloc::Global{}.allocate(sizeof(HeapJob), alignof(HeapJob));
+    return new (raw) HeapJob{move(task)};
+  }
+
+  static void run(Job *job) {
+    HeapJob *self = static_cast<HeapJob *>(job);
+    ops::DynFnOnce<void()> task{move(self->task)};
+    self->~HeapJob();
+    alloc::Global{}.deallocate(self, sizeof(HeapJob), alignof(HeapJob));
+    move(task)();
+  }
+};
+
+struct Latch {
+  std::atomic<bool> done;
+
+  Latch() : done{false} {}
+
+  bool probe() const { return done.load(std::memory_order_acquire); }
+
+  void set() { done.store(true, std::memory_order_release); }
+};
+
+/// latch for threads outside the pool, which block instead of helping.
+struct LockLatch {
+  std::mutex lock;
+  std::condition_variable cond;
+  bool done;
+
+  LockLatch() : done{false} {}
+
+  /// notifies under the lock, the waiter may drop the latch as soon as it
+  /// sees `done'.
+  void set() {
+    std::lock_guard<std::mutex> guard{lock};
+    done = true;
+    cond.notify_all();
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> guard{lock};
+    while (!done) {
+      cond.wait(guard);
+    }
+  }
+};
+
+/// the second half of a `join', living in the joining frame.
+template <class F>
+struct StackJob : Job {
+  F *f;
+  Latch latch;
+
+  explicit StackJob(F &f) : Job{run, nullptr}, f{&f} {}
+
+  static void run(Job *job) {
+    StackJob *self = static_cast<StackJob *>(job);
+    (*self->f)();
+    self->latch.set();
+  }
+};
+
+/// growable ring of a `Deque'. replaced buffers are kept until the deque is
+/// dropped, a thief may still be reading a slot from one.
+struct Buffer {
+  usize mask;
+  Buffer *prev;
+
+  std::atomic<Job *> *slots() {
+    return reinterpret_cast<std::atomic<Job *> *>(this + 1);
+  }
+
+  static usize size_of(usize len) {
+    return sizeof(Buffer) + len * sizeof(std::atomic<Job *>);
+  }
+
+  static Buffer *create(usize len, Buffer *prev) {
+    void *raw = alloc::Global{}.allocate(size_of(len), alignof(Buffer));
+    Buffer *buffer = new (raw) Buffer{len - 1, prev};
+    for (usize i = 0; i < len; ++i) {
+      new (buffer->slots() + i) std::atomic<Job *>{nullptr};
+    }
+    return buffer;
+  }
+
+  static void destroy(Buffer *buffer) {
+    while (buffer != nullptr) {
+      Buffer *prev = buffer->prev;
+      alloc::Global{}.deallocate(
+          buffer, size_of(buffer->mask + 1), alignof(Buffer));
+      buffer = prev;
+    }
+  }
+
+  Job *get(isize index) {
+    return slots()[static_cast<usize>(index) & mask].load(
+        std::memory_order_relaxed);
+  }
+
+  void put(isize index, Job *job) {
+    slots()[static_cast<usize>(index) & mask].store(
+        job, std::memory_order_relaxed);
+  }
+};
+
+/// Chase-Lev work stealing deque. the owning worker pushes and pops at the
+/// bottom without contention, thieves take from the top and only race with
+/// the owner for the last job. the indices use sequentially consistent
+/// operations in place of the fences of the original algorithm.
+struct Deque {
+private:
+  static constexpr usize MIN_LEN = 256;
+
+  std::atomic<isize> top;
+  std::atomic<isize> bottom;
+  std::atomic<Buffer *> buffer;
+
+  Buffer *grow(Buffer *old, isize t, isize b) {
+    Buffer *fresh = Buffer::create((old->mask + 1) * 2, old);
+    for (isize i = t; i < b; ++i) {
+      fresh->put(i, old->get(i));
+    }
+    buffer.store(fresh, std::memory_order_release);
+    return fresh;
+  }
+
+public:
+  Deque() :
+      top{0}, bottom{0}, buffer{Buffer::create(MIN_LEN, nullptr)} {}
+
+  Deque(const Deque &) = delete;
+
+  Deque &operator=(const Deque &) = delete;
+
+  /// owner only.
+  void push(Job *job) {
+    isize b = bottom.load(std::memory_order_relaxed);
+    isize t = top.load(std::memory_order_acquire);
+    Buffer *a = buffer.load(std::memory_order_relaxed);
+    if (static_cast<usize>(b - t) > a->mask) {
+      a = grow(a, t, b);
+    }
+    a->put(b, job);
+    bottom.store(b + 1, std::memory_order_seq_cst);
+  }
+
+  /// owner only, the most recently pushed job.
+  Job *pop() {
+    isize b = bottom.load(std::memory_order_relaxed) - 1;
+    Buffer *a = buffer.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_seq_cst);
+    isize t = top.load(std::memory_order_seq_cst);
+    if (t > b) {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    Job *job = a->get(b);
+    if (t == b) {
+      if (!top.compare_exchange_strong(
+              t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        job = nullptr;
+      }
+      bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+  }
+
+  /// the oldest job, or null when empty or when another thread won the race
+  /// for it.
+  Job *steal() {
+    isize t = top.load(std::memory_order_seq_cst);
+    isize b = bottom.load(std::memory_order_seq_cst);
+    if (t >= b) {
+      return nullptr;
+    }
+    Job *job = buffer.load(std::memory_order_acquire)->get(t);
+    if (!top.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return job;
+  }
+
+  ~Deque() { Buffer::destroy(buffer.load(std::memory_order_relaxed)); }
+};
+
+struct Registry;
+
+struct Worker {
+  Deque deque;
+  Registry *registry;
+  usize index;
+  u64 rng;
+
+  Worker(Registry *registry, usize index) :
+      registry{registry},
+      index{index},
+      rng{index * 0x9E3779B97F4A7C15ull + 1} {}
+
+  /// xorshift, only picks where to start looking for a victim.
+  usize next_random() {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return static_cast<usize>(rng);
+  }
+};
+
+inline Worker *&current_worker() {
+  static thread_local Worker *worker = nullptr;
+  return worker;
+}
+
+/// state shared by the workers of a pool.
+struct Registry {
+  /// idle rounds spent yielding before a worker parks.
+  static constexpr usize SPIN_ROUNDS = 64;
+
+  Worker *workers;
+  usize len;
+
+  /// jobs from threads outside the pool, oldest first.
+  std::mutex inject_lock;
+  Job *inject_head;
+  Job *inject_tail;
+  std::atomic<usize> injected;
+
+  std::mutex sleep_lock;
+  std::condition_variable sleep_cond;
+  std::atomic<usize> sleepers;
+  /// bumped under `sleep_lock' to wake parked workers.
+  std::atomic<u64> events;
+  std::atomic<bool> terminate;
+
+  explicit Registry(usize len) :
+      len{len},
+      inject_head{nullptr},
+      inject_tail{nullptr},
+      injected{0},
+      sleepers{0},
+      events{0},
+      terminate{false} {
+    void *raw = alloc::Global{}.allocate(sizeof(Worker) * len, alignof(Worker));
+    workers = static_cast<Worker *>(raw);
+    for (usize i = 0; i < len; ++i) {
+      new (workers + i) Worker{this, i};
+    }
+  }
+
+  Registry(const Registry &) = delete;
+
+  Registry &operator=(const Registry &) = delete;
+
+  /// wakes one parked worker, if any. a worker counts itself as a sleeper
+  /// before its last look for work, so either it sees the new job or the
+  /// pusher sees it.
+  void notify() {
+    if (sleepers.load(std::memory_order_seq_cst) == 0) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> guard{sleep_lock};
+      events.fetch_add(1, std::memory_order_relaxed);
+    }
+    sleep_cond.notify_one();
+  }
+
+  void inject(Job *job) {
+    {
+      std::lock_guard<std::mutex> guard{inject_lock};
+      job->next = nullptr;
+      if (inject_tail == nullptr) {
+        inject_head = job;
+      } else {
+        inject_tail->next = job;
+      }
+      inject_tail = job;
+      injected.fetch_add(1, std::memory_order_seq_cst);
+    }
+    notify();
+  }
+
+  Job *take_injected() {
+    if (injected.load(std::memory_order_seq_cst) == 0) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> guard{inject_lock};
+    Job *job = inject_head;
+    if (job != nullptr) {
+      inject_head = job->next;
+      if (inject_head == nullptr) {
+        inject_tail = nullptr;
+      }
+      injected.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return job;
+  }
+
+  void push(Worker &worker, Job *job) {
+    worker.deque.push(job);
+    notify();
+  }
+
+  /// onto the current worker's deque when called from this pool, otherwise
+  /// into the injector.
+  void push_or_inject(Job *job) {
+    Worker *worker = current_worker();
+    if (worker != nullptr && worker->registry == this) {
+      push(*worker, job);
+    } else {
+      inject(job);
+    }
+  }
+
+  Job *steal(Worker &worker) {
+    usize start = worker.next_random() % len;
+    for (usize i = 0; i < len; ++i) {
+      usize victim = (start + i) % len;
+      if (victim == worker.index) {
+        continue;
+      }
+      Job *job = workers[victim].deque.steal();
+      if (job != nullptr) {
+        return job;
+      }
+    }
+    return nullptr;
+  }
+
+  Job *find_work(Worker &worker) {
+    Job *job = worker.deque.pop();
+    if (job == nullptr) {
+      job = steal(worker);
+    }
+    if (job == nullptr) {
+      job = take_injected();
+    }
+    return job;
+  }
+
+  /// runs other jobs until `done' holds, instead of blocking the worker.
+  template <class F>
+  void wait_until(Worker &worker, F &&done) {
+    while (!done()) {
+      Job *job = find_work(worker);
+      if (job != nullptr) {
+        job->execute(job);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void sleep(Worker &worker) {
+    sleepers.fetch_add(1, std::memory_order_seq_cst);
+    u64 seen = events.load(std::memory_order_seq_cst);
+    Job *job = find_work(worker);
+    if (job != nullptr) {
+      sleepers.fetch_sub(1, std::memory_order_relaxed);
+      job->execute(job);
+      return;
+    }
+    {
+      std::unique_lock<std::mutex> guard{sleep_lock};
+      while (events.load(std::memory_order_relaxed) == seen &&
+             !terminate.load(std::memory_order_relaxed)) {
+        sleep_cond.wait(guard);
+      }
+    }
+    sleepers.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /// a worker only leaves once the pool is dropped and no work is left, so
+  /// every spawned job runs.
+  void main_loop(Worker &worker) {
+    current_worker() = &worker;
+    usize idle = 0;
+    while (true) {
+      Job *job = find_work(worker);
+      if (job != nullptr) {
+        idle = 0;
+        job->execute(job);
+        continue;
+      }
+      if (terminate.load(std::memory_order_acquire)) {
+        break;
+      }
+      if (++idle < SPIN_ROUNDS) {
+        std::this_thread::yield();
+        continue;
+      }
+      idle = 0;
+      sleep(worker);
+    }
+    current_worker() = nullptr;
+  }
+
+  void shutdown() {
+    {
+      std::lock_guard<std::mutex> guard{sleep_lock};
+      terminate.store(true, std::memory_order_release);
+      events.fetch_add(1, std::memory_order_relaxed);
+    }
+    sleep_cond.notify_all();
+  }
+
+  ~Registry() {
+    for (usize i = 0; i < len; ++i) {
+      workers[i].~Worker();
+    }
+    alloc::Global{}.deallocate(
+        workers, sizeof(Worker) * len, alignof(Worker));
+  }
+};
+
+/// runs `op' on a worker of `registry' and blocks until it returns.
+template <class F>
+struct InjectedJob : Job {
+  F *op;
+  LockLatch latch;
+
+  explicit InjectedJob(F &op) : Job{run, nullptr}, op{&op} {}
+
+  static void run(Job *job) {
+    InjectedJob *self = static_cast<InjectedJob *>(job);
+    (*self->op)(*current_worker());
+    self->latch.set();
+  }
+};
+
+template <class F>
+void in_worker(Registry &registry, F &&op) {
+  Worker *worker = current_worker();
+  if (worker != nullptr && worker->registry == &registry) {
+    op(*worker);
+    return;
+  }
+  InjectedJob<typename RemoveRefType<F>::Result> job{op};
+  registry.inject(&job);
+  job.latch.wait();
+}
+
+template <class A, class B>
+struct JoinOp {
+  A &a;
+  B &b;
+
+  /// `b' is offered to thieves while `a' runs. if nobody took it, it runs
+  /// right here, otherwise the worker helps out until the thief is done.
+  void operator()(Worker &worker) {
+    StackJob<B> job_b{b};
+    worker.registry->push(worker, &job_b);
+    a();
+    while (!job_b.latch.probe()) {
+      Job *job = worker.deque.pop();
+      if (job == &job_b) {
+        b();
+        return;
+      }
+      if (job == nullptr) {
+        worker.registry->wait_until(
+            worker, [&job_b]() { return job_b.latch.probe(); });
+        return;
+      }
+      job->execute(job);
+    }
+  }
+};
+} // namespace _impl_pool
+
+namespace sync {
+struct ThreadPool;
+
+/// spawns tasks that may borrow from the enclosing frame, `ThreadPool::scope'
+/// returns only after all of them are done.
+struct Scope {
+private:
+  friend struct ThreadPool;
+
+  template <class F>
+  struct Task {
+    Scope *scope;
+    F f;
+
+    /// the closure is gone before the count drops, the scope may end right
+    /// after.
+    void operator()() {
+      {
+        F local{move(f)};
+        local();
+      }
+      scope->pending.fetch_sub(1, std::memory_order_release);
+    }
+  };
+
+  _impl_pool::Registry *registry;
+  std::atomic<usize> pending;
+
+  explicit Scope(_impl_pool::Registry *registry) :
+      registry{registry}, pending{0} {}
+
+  bool is_done() const {
+    return pending.load(std::memory_order_acquire) == 0;
+  }
+
+public:
+  Scope(const Scope &) = delete;
+
+  Scope &operator=(const Scope &) = delete;
+
+  template <class F>
+  void spawn(F &&f) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    registry->push_or_inject(_impl_pool::HeapJob::create(
+        ops::DynFnOnce<void()>{Task<typename RemoveConstOrRefType<F>::Result>{
+            this, forward<F>(f)}}));
+  }
+};
+
+/// work stealing thread pool. every worker owns a Chase-Lev deque of jobs,
+/// pushes and pops its own jobs at one end and steals from the other end of
+/// a randomly chosen victim when it runs dry. idle workers yield for a while
+/// and then park until new work shows up. dropping the pool waits for every
+/// spawned task.
+struct ThreadPool {
+private:
+  _impl_pool::Registry registry;
+  std::thread *threads;
+
+  static usize default_threads() {
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores == 0 ? 1 : static_cast<usize>(cores);
+  }
+
+public:
+  explicit ThreadPool(usize len) : registry{len} {
+    crust_assert(len > 0);
+    void *raw = alloc::Global{}.allocate(
+        sizeof(std::thread) * len, alignof(std::thread));
+    threads = static_cast<std::thread *>(raw);
+    for (usize i = 0; i < len; ++i) {
+      _impl_pool::Registry *shared = &registry;
+      new (threads + i) std::thread{
+          [shared, i]() { shared->main_loop(shared->workers[i]); }};
+    }
+  }
+
+  /// one worker per hardware thread.
+  ThreadPool() : ThreadPool{default_threads()} {}
+
+  ThreadPool(const ThreadPool &) = delete;
+
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  usize num_threads() const { return registry.len; }
+
+  /// runs `task' on the pool some time later.
+  void spawn(ops::DynFnOnce<void()> task) {
+    registry.push_or_inject(_impl_pool::HeapJob::create(move(task)));
+  }
+
+  /// calls `f' with a `Scope' and waits for every task spawned through it,
+  /// which may borrow anything that outlives the call. runs on a worker,
+  /// blocking the caller if it is outside the pool.
+  template <class F>
+  void scope(F &&f) {
+    _impl_pool::in_worker(registry, [&f](_impl_pool::Worker &worker) {
+      Scope scope{worker.registry};
+      f(scope);
+      worker.registry->wait_until(
+          worker, [&scope]() { return scope.is_done(); });
+    });
+  }
+
+  /// runs `a' and `b', potentially in parallel, and returns once both are
+  /// done. results are passed back through their captures.
+  template <class A, class B>
+  void join(A &&a, B &&b) {
+    _impl_pool::in_worker(
+        registry,
+        _impl_pool::JoinOp<
+            typename RemoveRefType<A>::Result,
+            typename RemoveRefType<B>::Result>{a, b});
+  }
+
+  ~ThreadPool() {
+    registry.shutdown();
+    for (usize i = 0; i < registry.len; ++i) {
+      threads[i].join();
+      threads[i].~thread();
+    }
+    alloc::Global{}.deallocate(
+        threads, sizeof(std::thread) * registry.len, alignof(std::thread));
+  }
+};
+} // namespace sync
+} // namespace crust
+
+
+#endif // CRUST_SYNC_THREAD_POOL_HPP
@@ -55,8 +55,9 @@ struct TupleSizedHolderImpl<false, true, _impl_types::Types<Field, Fields...>> {
 
   constexpr TupleSizedHolderImpl() : field{} {}
 
-  explicit constexpr TupleSizedHolderImpl(Field &&field, Fields &&...) :
-      field{forward<Field>(field)} {}
+  template <class T, class... Ts>
+  explicit constexpr TupleSizedHolderImpl(T &&field, Ts &&...) :
+      field{forward<T>(field)} {}
 };
 
 template <class Field, class... Fields>
@@ -65,8 +66,9 @@ struct TupleSizedHolderImpl<true, false, _impl_types::Types<Field, Fields...>> {
 
   constexpr TupleSizedHolderImpl() : remains{} {}
 
-  explicit constexpr TupleSizedHolderImpl(Field &&, Fields &&...fields) :
-      remains{forward<Fields>(fields)...} {}
+  template <class T, class... Ts>
+  explicit constexpr TupleSizedHolderImpl(T &&, Ts &&...fields) :
+      remains{forward<Ts>(fields)...} {}
 };
 
 template <class... Fields>
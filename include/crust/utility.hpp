@@ -250,6 +250,20 @@ constexpr T &&forward(typename RemoveRefType<T>::Result &&t) {
   return static_cast<T &&>(t);
 }
 
+/// assumed size of a cache line, what data written by different threads is
+/// aligned to.
+constexpr usize CACHE_LINE = 64;
+
+/// storage for a `T' constructed and destroyed by hand.
+template <class T>
+union Uninit {
+  T value;
+
+  Uninit() {}
+
+  ~Uninit() {}
+};
+
 #define CRUST_USE_BASE_CONSTRUCTORS(NAME, ...)                                 \
   template <class... Args>                                                     \
   explicit constexpr NAME(Args &&...args) :                                    \
@@ -0,0 +1,695 @@
+#ifndef CRUST_VEC_HPP
+#define CRUST_VEC_HPP
+
+
+#include <cstring>
+#include <new>
+
+#include "crust/alloc/mod.hpp"
+#include "crust/clone.hpp"
+#include "crust/cmp.hpp"
+#include "crust/iter/mod.hpp"
+#include "crust/ops/function.hpp"
+#include "crust/ops/mod.hpp"
+#include "crust/ops/range.hpp"
+#include "crust/option.hpp"
+#include "crust/slice.hpp"
+#include "crust/utility.hpp"
+
+
+namespace crust {
+namespace _impl_vec {
+/// types that can be moved with a plain `memcpy', the old copy is simply
+/// forgotten afterwards.
+template <class T>
+struct IsRelocatable : IsTriviallyCopyable<T> {};
+
+/// relocatable types are moved with `memmove', so their buffers are resized
+/// by `Allocator::grow' and `shrink', which may do so in place. everything
+/// else is moved element by element into a new buffer.
+template <class T, bool = IsRelocatable<T>::result>
+struct RawMemory;
+
+template <class T>
+struct RawMemory<T, true> {
+  template <class A>
+  static T *allocate(const A &alloc, usize cap) {
+    return static_cast<T *>(alloc.allocate(cap * sizeof(T), alignof(T)));
+  }
+
+  template <class A>
+  static T *
+  reallocate(const A &alloc, T *ptr, usize, usize old_cap, usize cap) {
+    void *ret = cap > old_cap ?
+        alloc.grow(ptr, old_cap * sizeof(T), cap * sizeof(T), alignof(T)) :
+        alloc.shrink(ptr, old_cap * sizeof(T), cap * sizeof(T), alignof(T));
+    return static_cast<T *>(ret);
+  }
+
+  template <class A>
+  static void deallocate(const A &alloc, T *ptr, usize cap) {
+    alloc.deallocate(ptr, cap * sizeof(T), alignof(T));
+  }
+
+  static void move_forward(T *dst, T *src, usize len) {
+    std::memmove(dst, src, len * sizeof(T));
+  }
+
+  static void move_backward(T *dst, T *src, usize len) {
+    std::memmove(dst, src, len * sizeof(T));
+  }
+};
+
+template <class T>
+struct RawMemory<T, false> {
+  template <class A>
+  static T *allocate(const A &alloc, usize cap) {
+    return static_cast<T *>(alloc.allocate(cap * sizeof(T), alignof(T)));
+  }
+
+  template <class A>
+  static T *
+  reallocate(const A &alloc, T *ptr, usize len, usize old_cap, usize cap) {
+    T *ret = allocate(alloc, cap);
+    move_forward(ret, ptr, len);
+    deallocate(alloc, ptr, old_cap);
+    return ret;
+  }
+
+  template <class A>
+  static void deallocate(const A &alloc, T *ptr, usize cap) {
+    alloc.deallocate(ptr, cap * sizeof(T), alignof(T));
+  }
+
+  /// moves `[src, src + len)' to a lower or disjoint `dst', the source is
+  /// left uninitialized.
+  static void move_forward(T *dst, T *src, usize len) {
+    for (usize i = 0; i < len; ++i) {
+      ::new (dst + i) T{move(src[i])};
+      src[i].~T();
+    }
+  }
+
+  /// moves `[src, src + len)' to a higher or disjoint `dst', the source is
+  /// left uninitialized.
+  static void move_backward(T *dst, T *src, usize len) {
+    for (usize i = len; i != 0; --i) {
+      ::new (dst + i - 1) T{move(src[i - 1])};
+      src[i - 1].~T();
+    }
+  }
+};
+
+template <class T>
+void drop_in_place(T *ptr, usize len) {
+  if (!std::is_trivially_destructible<T>::value) {
+    for (usize i = 0; i < len; ++i) {
+      ptr[i].~T();
+    }
+  }
+}
+
+/// following helpers work on a raw `[ptr, ptr + len)' buffer so that every
+/// contiguous container shares them, the new length is returned.
+template <class T, class F>
+usize retain(T *ptr, usize len, F &f) {
+  usize kept = 0;
+  for (usize i = 0; i < len; ++i) {
+    if (f(static_cast<const T &>(ptr[i]))) {
+      if (kept != i) {
+        RawMemory<T>::move_forward(ptr + kept, ptr + i, 1);
+      }
+      ++kept;
+    } else {
+      ptr[i].~T();
+    }
+  }
+  return kept;
+}
+
+template <class T>
+usize dedup(T *ptr, usize len) {
+  if (len <= 1) {
+    return len;
+  }
+  usize kept = 1;
+  for (usize i = 1; i < len; ++i) {
+    if (ptr[i] == ptr[kept - 1]) {
+      ptr[i].~T();
+    } else {
+      if (kept != i) {
+        RawMemory<T>::move_forward(ptr + kept, ptr + i, 1);
+      }
+      ++kept;
+    }
+  }
+  return kept;
+}
+
+template <class T>
+bool eq(const T *a, usize a_len, const T *b, usize b_len) {
+  if (a_len != b_len) {
+    return false;
+  }
+  for (usize i = 0; i < a_len; ++i) {
+    if (!(a[i] == b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// buffers are ordered lexicographically.
+template <class T>
+Option<cmp::Ordering>
+partial_cmp(const T *a, usize a_len, const T *b, usize b_len) {
+  usize len = a_len < b_len ? a_len : b_len;
+  for (usize i = 0; i < len; ++i) {
+    Option<cmp::Ordering> ordering = operator_partial_cmp(a[i], b[i]);
+    if (ordering != make_some(cmp::make_equal())) {
+      return ordering;
+    }
+  }
+  return make_some(operator_cmp(a_len, b_len));
+}
+
+template <class T>
+cmp::Ordering cmp(const T *a, usize a_len, const T *b, usize b_len) {
+  usize len = a_len < b_len ? a_len : b_len;
+  for (usize i = 0; i < len; ++i) {
+    cmp::Ordering ordering = operator_cmp(a[i], b[i]);
+    if (ordering != cmp::make_equal()) {
+      return ordering;
+    }
+  }
+  return operator_cmp(a_len, b_len);
+}
+
+/// most elements a buffer of `T' can hold, its size in bytes has to fit in
+/// an `isize' so it never wraps around.
+template <class T>
+constexpr usize max_capacity() {
+  return static_cast<usize>(-1) / 2 / sizeof(T);
+}
+} // namespace _impl_vec
+
+template <class T, class A = alloc::Global>
+struct Vec;
+
+namespace vec {
+template <class T, class A>
+struct Drain;
+} // namespace vec
+
+/// contiguous growable array in memory from `A'.
+template <class T, class A>
+struct crust_ebco Vec :
+    private A,
+    Impl<
+        Vec<T, A>,
+        Trait<index::Index, usize, T>,
+        Trait<clone::Clone>,
+        Trait<cmp::PartialEq>,
+        Trait<cmp::Eq>,
+        Trait<cmp::PartialOrd>,
+        Trait<cmp::Ord>,
+        Trait<iter::FromIterator, T>> {
+private:
+  using Memory = _impl_vec::RawMemory<T>;
+
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  friend struct vec::Drain<T, A>;
+
+  T *ptr;
+  usize size;
+  usize cap;
+
+  A &allocator() { return *this; }
+
+  /// `size + additional', panicking where it would not fit in a buffer.
+  usize required_capacity(usize additional) const {
+    if (additional > _impl_vec::max_capacity<T>() - size) {
+      crust_panic("capacity overflow!");
+    }
+    return size + additional;
+  }
+
+  void set_capacity(usize new_cap) {
+    if (new_cap > _impl_vec::max_capacity<T>()) {
+      crust_panic("capacity overflow!");
+    }
+    if (new_cap == 0) {
+      if (ptr != nullptr) {
+        Memory::deallocate(allocator(), ptr, cap);
+        ptr = nullptr;
+      }
+    } else if (ptr == nullptr) {
+      ptr = Memory::allocate(allocator(), new_cap);
+    } else {
+      ptr = Memory::reallocate(allocator(), ptr, size, cap, new_cap);
+    }
+    cap = new_cap;
+  }
+
+  /// `other' may point into this vector, then it is rebased after the
+  /// buffer moves.
+  template <class U>
+  void extend_from_raw(const U *other, usize len) {
+    if (len == 0) {
+      return;
+    }
+    bool inside = ptr != nullptr && other >= ptr && other < ptr + size;
+    usize offset = inside ? static_cast<usize>(other - ptr) : 0;
+    reserve(len);
+    if (inside) {
+      other = ptr + offset;
+    }
+    if (IsTriviallyCopyable<T>::result) {
+      std::memcpy(static_cast<void *>(ptr + size), other, len * sizeof(T));
+    } else {
+      for (usize i = 0; i < len; ++i) {
+        ::new (ptr + size + i) T{_impl_clone::clone_of(other[i])};
+      }
+    }
+    size += len;
+  }
+
+public:
+  constexpr Vec() : A{}, ptr{nullptr}, size{0}, cap{0} {}
+
+  explicit constexpr Vec(A alloc) : A{alloc}, ptr{nullptr}, size{0}, cap{0} {}
+
+  static Vec with_capacity(usize cap, A alloc = A{}) {
+    Vec ret{alloc};
+    ret.reserve_exact(cap);
+    return ret;
+  }
+
+  Vec(const Vec &) = delete;
+
+  Vec(Vec &&other) noexcept :
+      A{other.allocator()},
+      ptr{other.ptr},
+      size{other.size},
+      cap{other.cap} {
+    other.ptr = nullptr;
+    other.size = 0;
+    other.cap = 0;
+  }
+
+  Vec &operator=(const Vec &) = delete;
+
+  Vec &operator=(Vec &&other) noexcept {
+    if (this != &other) {
+      clear();
+      set_capacity(0);
+      allocator() = other.allocator();
+      ptr = other.ptr;
+      size = other.size;
+      cap = other.cap;
+      other.ptr = nullptr;
+      other.size = 0;
+      other.cap = 0;
+    }
+
+    return *this;
+  }
+
+  const A &allocator() const { return *this; }
+
+  usize len() const { return size; }
+
+  usize capacity() const { return cap; }
+
+  bool is_empty() const { return size == 0; }
+
+  const T *as_ptr() const { return ptr; }
+
+  T *as_mut_ptr() { return ptr; }
+
+  Slice<const T> as_slice() const {
+    return Slice<const T>::from_raw_parts(ptr, size);
+  }
+
+  Slice<T> as_mut_slice() { return Slice<T>::from_raw_parts(ptr, size); }
+
+  slice::Iter<T> iter() const { return slice::Iter<T>{ptr, ptr + size}; }
+
+  slice::IterMut<T> iter_mut() { return slice::IterMut<T>{ptr, ptr + size}; }
+
+  Option<Ref<T>> get(usize index) const {
+    if (index >= size) {
+      return None{};
+    }
+    return make_some(ref(ptr[index]));
+  }
+
+  Option<RefMut<T>> get_mut(usize index) {
+    if (index >= size) {
+      return None{};
+    }
+    return make_some(ref_mut(ptr[index]));
+  }
+
+  Option<Ref<T>> first() const { return get(0); }
+
+  Option<Ref<T>> last() const {
+    return size == 0 ? make_none<Ref<T>>() : get(size - 1);
+  }
+
+  /// reserves room for at least `additional' more elements, growing
+  /// geometrically.
+  void reserve(usize additional) {
+    if (cap - size >= additional) {
+      return;
+    }
+    usize required = required_capacity(additional);
+    usize new_cap = cap > _impl_vec::max_capacity<T>() / 2 ?
+        _impl_vec::max_capacity<T>() :
+        cap * 2;
+    if (new_cap < required) {
+      new_cap = required;
+    }
+    if (new_cap < 4) {
+      new_cap = 4;
+    }
+    set_capacity(new_cap);
+  }
+
+  /// reserves room for exactly `additional' more elements.
+  void reserve_exact(usize additional) {
+    if (cap - size < additional) {
+      set_capacity(required_capacity(additional));
+    }
+  }
+
+  void shrink_to_fit() {
+    if (cap != size) {
+      set_capacity(size);
+    }
+  }
+
+  void push(T value) {
+    if (size == cap) {
+      reserve(1);
+    }
+    ::new (ptr + size) T{move(value)};
+    ++size;
+  }
+
+  Option<T> pop() {
+    if (size == 0) {
+      return None{};
+    }
+    --size;
+    T value{move(ptr[size])};
+    ptr[size].~T();
+    return make_some(move(value));
+  }
+
+  void insert(usize index, T value) {
+    if (index > size) {
+      crust_panic("insertion index out of boundary!");
+    }
+    if (size == cap) {
+      reserve(1);
+    }
+    Memory::move_backward(ptr + index + 1, ptr + index, size - index);
+    ::new (ptr + index) T{move(value)};
+    ++size;
+  }
+
+  T remove(usize index) {
+    if (index >= size) {
+      crust_panic("removal index out of boundary!");
+    }
+    T value{move(ptr[index])};
+    ptr[index].~T();
+    Memory::move_forward(ptr + index, ptr + index + 1, size - index - 1);
+    --size;
+    return value;
+  }
+
+  /// removes an element in O(1) by moving the last element into its place.
+  T swap_remove(usize index) {
+    if (index >= size) {
+      crust_panic("removal index out of boundary!");
+    }
+    T value{move(ptr[index])};
+    ptr[index].~T();
+    --size;
+    if (index != size) {
+      Memory::move_forward(ptr + index, ptr + size, 1);
+    }
+    return value;
+  }
+
+  void truncate(usize len) {
+    if (len < size) {
+      _impl_vec::drop_in_place(ptr + len, size - len);
+      size = len;
+    }
+  }
+
+  void clear() { truncate(0); }
+
+  void extend_from_slice(Slice<const T> other) {
+    extend_from_raw(other.as_ptr(), other.len());
+  }
+
+  void extend_from_slice(Slice<T> other) {
+    extend_from_raw(other.as_ptr(), other.len());
+  }
+
+  /// keeps only elements for which `f' returns true, preserving order.
+  template <class F>
+  void retain(ops::FnMut<F, bool(const T &)> f) {
+    size = _impl_vec::retain(ptr, size, f);
+  }
+
+  /// removes consecutive repeated elements.
+  void dedup() { size = _impl_vec::dedup(ptr, size); }
+
+  /// removes `range' from the vector and yields the removed elements, the
+  /// tail is shifted down when the returned iterator is dropped.
+  vec::Drain<T, A> drain(range::Range<usize> range) {
+    if (range.start > range.end || range.end > size) {
+      crust_panic("drain range out of boundary!");
+    }
+    return vec::Drain<T, A>{*this, range.start, range.end};
+  }
+
+  ~Vec() {
+    clear();
+    set_capacity(0);
+  }
+};
+
+namespace vec {
+/// draining iterator returned by `Vec::drain'.
+template <class T, class A>
+struct crust_ebco Drain :
+    Impl<
+        Drain<T, A>,
+        Trait<iter::Iterator, T>,
+        Trait<iter::DoubleEndedIterator, T>,
+        Trait<iter::ExactSizeIterator, T>> {
+private:
+  template <class, class>
+  friend struct ::crust::ImplFor;
+
+  friend struct Vec<T, A>;
+
+  Vec<T, A> *vec;
+  T *ptr;
+  T *end;
+  usize tail_start;
+  usize tail_len;
+
+  Drain(Vec<T, A> &vec, usize start, usize end) :
+      vec{&vec},
+      ptr{vec.ptr + start},
+      end{vec.ptr + end},
+      tail_start{end},
+      tail_len{vec.size - end} {
+    vec.size = start;
+  }
+
+  static T take(T *slot) {
+    T value{move(*slot)};
+    slot->~T();
+    return value;
+  }
+
+public:
+  Drain(const Drain &) = delete;
+
+  Drain(Drain &&other) noexcept :
+      vec{other.vec},
+      ptr{other.ptr},
+      end{other.end},
+      tail_start{other.tail_start},
+      tail_len{other.tail_len} {
+    other.vec = nullptr;
+  }
+
+  Drain &operator=(const Drain &) = delete;
+
+  Drain &operator=(Drain &&) = delete;
+
+  ~Drain() {
+    if (vec == nullptr) {
+      return;
+    }
+    _impl_vec::drop_in_place(ptr, static_cast<usize>(end - ptr));
+    if (tail_len != 0 && vec->size != tail_start) {
+      _impl_vec::RawMemory<T>::move_forward(
+          vec->ptr + vec->size, vec->ptr + tail_start, tail_len);
+    }
+    vec->size += tail_len;
+  }
+};
+} // namespace vec
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::Iterator<vec::Drain<T, A>, T>)) {
+  CRUST_IMPL_USE_SELF(vec::Drain<T, A>);
+
+  Option<T> next() {
+    if (self().ptr == self().end) {
+      return None{};
+    }
+    return make_some(Self::take(self().ptr++));
+  }
+
+  Tuple<usize, Option<usize>> size_hint() const {
+    usize len = static_cast<usize>(self().end - self().ptr);
+    return tuple(len, make_some(len));
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::DoubleEndedIterator<vec::Drain<T, A>, T>)) {
+  CRUST_IMPL_USE_SELF(vec::Drain<T, A>);
+
+  Option<T> next_back() {
+    if (self().ptr == self().end) {
+      return None{};
+    }
+    return make_some(Self::take(--self().end));
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::ExactSizeIterator<vec::Drain<T, A>, T>)){};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(index::Index<Vec<T, A>, usize, T>)) {
+  CRUST_IMPL_USE_SELF(Vec<T, A>);
+
+  const T &index(usize index) const {
+    if (index >= self().len()) {
+      crust_panic("index out of boundary!");
+    }
+    return self().as_ptr()[index];
+  }
+
+  T &index_mut(usize index) {
+    if (index >= self().len()) {
+      crust_panic("index_mut out of boundary!");
+    }
+    return self().as_mut_ptr()[index];
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(clone::Clone<Vec<T, A>>)) {
+  CRUST_IMPL_USE_SELF(Vec<T, A>);
+
+  Self clone() const {
+    Self ret = Self::with_capacity(self().len(), self().allocator());
+    ret.extend_from_slice(self().as_slice());
+    return ret;
+  }
+
+  void clone_from(const Self &other) {
+    self().clear();
+    self().extend_from_slice(other.as_slice());
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialEq<Vec<T, A>>)) {
+  CRUST_IMPL_USE_SELF(Vec<T, A>);
+
+  bool eq(const Self &other) const {
+    return _impl_vec::eq(
+        self().as_ptr(), self().len(), other.as_ptr(), other.len());
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Eq<Vec<T, A>>)){};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::PartialOrd<Vec<T, A>>)) {
+  CRUST_IMPL_USE_SELF(Vec<T, A>);
+
+  Option<cmp::Ordering> partial_cmp(const Self &other) const {
+    return _impl_vec::partial_cmp(
+        self().as_ptr(), self().len(), other.as_ptr(), other.len());
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(cmp::Ord<Vec<T, A>>)) {
+  CRUST_IMPL_USE_SELF(Vec<T, A>);
+
+  cmp::Ordering cmp(const Self &other) const {
+    return _impl_vec::cmp(
+        self().as_ptr(), self().len(), other.as_ptr(), other.len());
+  }
+};
+
+template <class T, class A>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::FromIterator<Vec<T, A>, T>)) {
+  CRUST_IMPL_USE_SELF(Vec<T, A>);
+
+  template <class I>
+  static Self from_iter(I &&iter) {
+    return from_iter_impl(
+        iter, BoolVal<Require<I, iter::TrustedLen, T>::result>{});
+  }
+
+private:
+  /// the exact length is reserved up front and the fill loop is counted.
+  template <class I>
+  static Self from_iter_impl(I &iter, BoolVal<true>) {
+    usize len = iter::_impl_iter::exact_len(iter);
+    Self ret = Self::with_capacity(len);
+    T *ptr = ret.as_mut_ptr();
+    for (usize i = 0; i < len; ++i) {
+      ::new (ptr + i) T{iter.next_unchecked()};
+    }
+    ret.size = len;
+    return ret;
+  }
+
+  template <class I>
+  static Self from_iter_impl(I &iter, BoolVal<false>) {
+    Self ret = Self::with_capacity(iter.size_hint().template get<0>());
+    while (true) {
+      auto x = iter.next();
+      if (x.is_none()) {
+        return ret;
+      }
+      ret.push(move(x).unwrap());
+    }
+  }
+};
+} // namespace crust
+
+
+#endif // CRUST_VEC_HPP
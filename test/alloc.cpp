@@ -0,0 +1,327 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <thread>
+
+#include "crust/alloc/arena.hpp"
+#include "crust/alloc/mod.hpp"
+#include "crust/alloc/stats_new.hpp"
+#include "crust/collections/binary_heap.hpp"
+#include "crust/collections/vec_deque.hpp"
+#include "crust/small_vec.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+#include "alloc_checker.hpp"
+
+
+using namespace crust;
+
+
+namespace {
+bool is_aligned(const void *ptr, usize align) {
+  return reinterpret_cast<usize>(ptr) % align == 0;
+}
+
+struct Counted {
+  usize *drops;
+  usize value;
+
+  Counted(usize *drops, usize value) : drops{drops}, value{value} {}
+
+  Counted(Counted &&other) noexcept : drops{other.drops}, value{other.value} {
+    other.drops = nullptr;
+  }
+
+  ~Counted() {
+    if (drops != nullptr) {
+      ++*drops;
+    }
+  }
+};
+
+struct Node {
+  Node *next;
+  i32 value;
+};
+
+struct Budget;
+} // namespace
+
+namespace crust {
+template <class S>
+CRUST_IMPL_FOR(alloc::Allocator<S>, IsSame<S, Budget>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  void *allocate(usize size, usize align) const {
+    *self().used += size;
+    return alloc::Global{}.allocate(size, align);
+  }
+
+  void deallocate(void *ptr, usize size, usize align) const {
+    *self().used -= size;
+    alloc::Global{}.deallocate(ptr, size, align);
+  }
+};
+} // namespace crust
+
+namespace {
+/// counts the bytes in use, relying on the default `grow' and `shrink'.
+struct Budget : Impl<Budget, Trait<alloc::Allocator>> {
+  usize *used;
+
+  explicit Budget(usize &used) : used{&used} {}
+};
+} // namespace
+
+GTEST_TEST(alloc, global) {
+  alloc::Global global;
+
+  void *small = global.allocate(24, 8);
+  EXPECT_TRUE(is_aligned(small, 8));
+  global.deallocate(small, 24, 8);
+
+  for (usize align = 32; align <= 4096; align *= 2) {
+    void *ptr = global.allocate(40, align);
+    EXPECT_TRUE(is_aligned(ptr, align));
+    global.deallocate(ptr, 40, align);
+  }
+}
+
+GTEST_TEST(alloc, thread_cache) {
+  alloc::ThreadCache cache;
+
+  void *block = cache.allocate(100, 8);
+  cache.deallocate(block, 100, 8);
+  EXPECT_EQ(cache.allocate(110, 8), block);
+  cache.deallocate(block, 110, 8);
+
+  void *empty = cache.allocate(0, 1);
+  cache.deallocate(empty, 0, 1);
+  EXPECT_EQ(cache.allocate(16, 8), empty);
+  cache.deallocate(empty, 16, 8);
+
+  void *aligned = cache.allocate(64, 64);
+  EXPECT_TRUE(is_aligned(aligned, 64));
+  cache.deallocate(aligned, 64, 64);
+}
+
+GTEST_TEST(alloc, arena) {
+  alloc::Arena arena;
+
+  void *a = arena.allocate(3, 1);
+  void *b = arena.allocate(8, 8);
+  EXPECT_TRUE(is_aligned(b, 8));
+  EXPECT_GT(static_cast<u8 *>(b), static_cast<u8 *>(a));
+
+  void *large = arena.allocate(10000, 64);
+  EXPECT_TRUE(is_aligned(large, 64));
+
+  arena.reset();
+  EXPECT_EQ(arena.allocate(10000, 64), large);
+}
+
+GTEST_TEST(alloc, arena_values) {
+  usize drops = 0;
+  {
+    alloc::Arena arena;
+    RefMut<Node> first = arena.alloc(Node{nullptr, 1});
+    RefMut<Node> second = arena.alloc(Node{&*first, 2});
+    EXPECT_EQ(second->next->value, 1);
+    EXPECT_TRUE(is_aligned(&*second, alignof(Node)));
+
+    for (usize i = 0; i < 1000; ++i) {
+      EXPECT_EQ(arena.alloc(Counted{&drops, i})->value, i);
+    }
+    EXPECT_EQ(drops, 0u);
+    arena.reset();
+    EXPECT_EQ(drops, 1000u);
+
+    arena.alloc(Counted{&drops, 0});
+  }
+  EXPECT_EQ(drops, 1001u);
+}
+
+GTEST_TEST(alloc, typed_arena) {
+  alloc::TypedArena<Node> nodes;
+  Node *head = nullptr;
+  for (i32 i = 0; i < 10000; ++i) {
+    head = &*nodes.alloc(Node{head, i});
+  }
+  i32 expected = 9999;
+  for (; head != nullptr; head = head->next) {
+    EXPECT_EQ(head->value, expected--);
+  }
+  EXPECT_EQ(expected, -1);
+
+  usize drops = 0;
+  {
+    alloc::TypedArena<Counted> arena;
+    for (usize i = 0; i < 5000; ++i) {
+      EXPECT_EQ(arena.alloc(Counted{&drops, i})->value, i);
+    }
+    EXPECT_EQ(drops, 0u);
+    arena.reset();
+    EXPECT_EQ(drops, 5000u);
+
+    RefMut<Counted> value = arena.alloc(Counted{&drops, 7});
+    EXPECT_EQ(value->value, 7u);
+  }
+  EXPECT_EQ(drops, 5001u);
+}
+
+GTEST_TEST(alloc, allocator_trait) {
+  bool global_impl = Require<alloc::Global, alloc::Allocator>::result;
+  bool cache_impl = Require<alloc::ThreadCache, alloc::Allocator>::result;
+  bool arena_impl = Require<alloc::ArenaRef, alloc::Allocator>::result;
+  EXPECT_TRUE(global_impl);
+  EXPECT_TRUE(cache_impl);
+  EXPECT_TRUE(arena_impl);
+
+  alloc::Global global;
+  u8 *block = static_cast<u8 *>(global.allocate(16, 8));
+  std::memset(block, 7, 16);
+  block = static_cast<u8 *>(global.grow(block, 16, 4096, 8));
+  EXPECT_EQ(block[15], 7);
+  block = static_cast<u8 *>(global.shrink(block, 4096, 8, 8));
+  EXPECT_EQ(block[7], 7);
+  global.deallocate(block, 8, 8);
+
+  void *aligned = global.allocate(64, 128);
+  aligned = global.grow(aligned, 64, 256, 128);
+  EXPECT_TRUE(is_aligned(aligned, 128));
+  global.deallocate(aligned, 256, 128);
+
+  alloc::ThreadCache cache;
+  void *cached = cache.allocate(20, 8);
+  EXPECT_EQ(cache.grow(cached, 20, 30, 8), cached);
+  cached = cache.grow(cached, 30, 100, 8);
+  cache.deallocate(cached, 100, 8);
+
+  alloc::Arena arena;
+  alloc::ArenaRef handle{arena};
+  void *last = handle.allocate(16, 8);
+  EXPECT_EQ(handle.grow(last, 16, 1024, 8), last);
+  void *next = handle.allocate(8, 8);
+  EXPECT_EQ(static_cast<u8 *>(next), static_cast<u8 *>(last) + 1024);
+  EXPECT_NE(handle.grow(last, 1024, 2048, 8), last);
+}
+
+GTEST_TEST(alloc, containers) {
+  alloc::Arena arena;
+  Vec<i32, alloc::ArenaRef> in_arena{arena};
+  for (i32 i = 0; i < 1000; ++i) {
+    in_arena.push(i);
+  }
+  EXPECT_EQ(in_arena[999], 999);
+  Vec<i32, alloc::ArenaRef> copy = in_arena.clone();
+  EXPECT_TRUE(copy == in_arena);
+
+  SmallVec<i32, 4, alloc::ArenaRef> small{arena};
+  for (i32 i = 0; i < 100; ++i) {
+    small.push(i);
+  }
+  EXPECT_TRUE(small.spilled());
+  EXPECT_TRUE(small.clone() == small);
+
+  collections::VecDeque<i32, alloc::ArenaRef> deque{arena};
+  for (i32 i = 0; i < 100; ++i) {
+    deque.push_back(i);
+    deque.push_front(-i);
+  }
+  EXPECT_TRUE(deque.clone() == deque);
+  EXPECT_EQ(deque.pop_front(), make_some(-99));
+
+  using ArenaHeap = collections::BinaryHeap<i32, 4, alloc::ArenaRef>;
+  ArenaHeap heap = ArenaHeap::from_vec(copy.clone());
+  EXPECT_EQ(heap.pop(), make_some(999));
+  EXPECT_EQ(heap.clone().pop(), make_some(998));
+  ArenaHeap reserved = ArenaHeap::with_capacity(16, arena);
+  reserved.push(1);
+  EXPECT_GE(reserved.capacity(), 16u);
+
+  usize used = 0;
+  {
+    Vec<i64, Budget> vec{Budget{used}};
+    vec.push(1);
+    EXPECT_EQ(used, 4 * sizeof(i64));
+    vec.reserve_exact(100);
+    EXPECT_EQ(used, 101 * sizeof(i64));
+    vec.shrink_to_fit();
+    EXPECT_EQ(used, sizeof(i64));
+
+    SmallVec<i32, 2, Budget> small{Budget{used}};
+    small.push(1);
+    small.push(2);
+    EXPECT_EQ(used, sizeof(i64));
+    small.push(3);
+    EXPECT_EQ(used, sizeof(i64) + 4 * sizeof(i32));
+
+    collections::VecDeque<i32, Budget> deque{Budget{used}};
+    deque.push_front(1);
+    EXPECT_GT(used, sizeof(i64) + 4 * sizeof(i32));
+  }
+  EXPECT_EQ(used, 0u);
+}
+
+GTEST_TEST(alloc, stats) {
+  alloc::StatsScope outer;
+  {
+    alloc::StatsScope inner;
+    Vec<i64> vec;
+    vec.push(1);
+    vec.reserve_exact(100);
+    vec.shrink_to_fit();
+    alloc::Stats stats = inner.stats();
+    EXPECT_EQ(stats.allocations, 1u);
+    EXPECT_EQ(stats.reallocations, 2u);
+    EXPECT_EQ(stats.deallocations, 0u);
+    EXPECT_EQ(stats.allocated_bytes, 101 * sizeof(i64));
+    EXPECT_EQ(stats.live_bytes, static_cast<isize>(sizeof(i64)));
+    EXPECT_EQ(stats.peak_bytes, static_cast<isize>(101 * sizeof(i64)));
+  }
+  {
+    alloc::StatsScope inner;
+    alloc::Arena arena;
+    arena.allocate(16, 8);
+    arena.allocate(16, 8);
+    EXPECT_EQ(inner.stats().allocations, 1u);
+  }
+  alloc::Stats stats = outer.stats();
+  EXPECT_EQ(stats.allocations, 2u);
+  EXPECT_EQ(stats.deallocations, 2u);
+  EXPECT_EQ(stats.live_bytes, 0);
+  EXPECT_GE(stats.peak_bytes, static_cast<isize>(101 * sizeof(i64)));
+
+  Vec<i32> vec = Vec<i32>::with_capacity(4);
+  CRUST_EXPECT_NO_ALLOC({
+    vec.push(1);
+    vec.push(2);
+    vec.pop();
+  });
+}
+
+GTEST_TEST(alloc, stats_new) {
+  alloc::StatsScope scope;
+  i64 *value = new i64{1};
+  i32 *array = new i32[10];
+  EXPECT_EQ(scope.stats().allocations, 2u);
+  EXPECT_EQ(
+      scope.stats().live_bytes, static_cast<isize>(sizeof(i64) + 10 * 4));
+  delete value;
+  delete[] array;
+  EXPECT_EQ(scope.stats().deallocations, 2u);
+  EXPECT_EQ(scope.stats().live_bytes, 0);
+
+  // freed by another thread, which sees negative live bytes.
+  value = new i64{2};
+  isize freed = 0;
+  std::thread other{[&]() {
+    alloc::StatsScope scope;
+    delete value;
+    freed = scope.stats().live_bytes;
+    EXPECT_EQ(scope.stats().peak_bytes, 0);
+  }};
+  other.join();
+  EXPECT_EQ(freed, -static_cast<isize>(sizeof(i64)));
+}
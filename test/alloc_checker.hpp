@@ -0,0 +1,28 @@
+#ifndef CRUST_TEST_ALLOC_CHECKER_HPP
+#define CRUST_TEST_ALLOC_CHECKER_HPP
+
+
+#include "gtest/gtest.h"
+
+#include "crust/alloc/mod.hpp"
+
+
+#if !defined(CRUST_ALLOC_STATS)
+#error "allocation checks need `CRUST_ALLOC_STATS' to be defined"
+#endif
+
+/// runs the statements and expects the calling thread to neither allocate,
+/// resize nor free anything meanwhile.
+#define CRUST_EXPECT_NO_ALLOC(...)                                             \
+  do {                                                                         \
+    ::crust::alloc::StatsScope crust_alloc_scope;                              \
+    __VA_ARGS__;                                                               \
+    ::crust::alloc::Stats crust_alloc_stats = crust_alloc_scope.stats();       \
+    EXPECT_TRUE(crust_alloc_stats.is_zero())                                   \
+        << "allocations: " << crust_alloc_stats.allocations                    \
+        << ", reallocations: " << crust_alloc_stats.reallocations              \
+        << ", deallocations: " << crust_alloc_stats.deallocations;             \
+  } while (false)
+
+
+#endif // CRUST_TEST_ALLOC_CHECKER_HPP
@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+#include "crust/collections/binary_heap.hpp"
+#include "crust/ops/range.hpp"
+#include "crust/str.hpp"
+#include "crust/string.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+using namespace crust;
+using collections::BinaryHeap;
+
+
+namespace {
+u32 next_random(u32 &state) {
+  state = state * 1103515245u + 12345u;
+  return state >> 8;
+}
+
+template <usize D>
+void check_arity() {
+  BinaryHeap<i32, D> heap;
+  EXPECT_TRUE(heap.pop().is_none());
+  EXPECT_TRUE(heap.peek().is_none());
+
+  u32 state = static_cast<u32>(D);
+  Vec<i32> values;
+  for (i32 i = 0; i < 1000; ++i) {
+    i32 value = static_cast<i32>(next_random(state) % 500);
+    values.push(value);
+    heap.push(value);
+  }
+  EXPECT_EQ(heap.len(), 1000u);
+
+  BinaryHeap<i32, D> bulk = BinaryHeap<i32, D>::from_vec(values.clone());
+  i32 last = 500;
+  for (i32 i = 0; i < 1000; ++i) {
+    i32 top = *heap.peek().unwrap();
+    EXPECT_EQ(heap.pop(), make_some(top));
+    EXPECT_EQ(bulk.pop(), make_some(top));
+    EXPECT_LE(top, last);
+    last = top;
+  }
+  EXPECT_TRUE(heap.is_empty());
+
+  Vec<i32> sorted =
+      BinaryHeap<i32, D>::from_vec(move(values)).into_sorted_vec();
+  for (usize i = 1; i < sorted.len(); ++i) {
+    EXPECT_LE(sorted[i - 1], sorted[i]);
+  }
+}
+} // namespace
+
+GTEST_TEST(binary_heap, arity) {
+  check_arity<2>();
+  check_arity<4>();
+  check_arity<8>();
+}
+
+GTEST_TEST(binary_heap, peek_mut) {
+  BinaryHeap<i32> heap = range::Range<i32>{0, 10}.collect<BinaryHeap<i32>>();
+  EXPECT_EQ(*heap.peek().unwrap(), 9);
+
+  *heap.peek_mut().unwrap() = -1;
+  EXPECT_EQ(*heap.peek().unwrap(), 8);
+
+  {
+    auto top = heap.peek_mut().unwrap();
+    *top -= 10;
+  }
+  EXPECT_EQ(*heap.peek().unwrap(), 7);
+  EXPECT_EQ(heap.peek_mut().unwrap().pop(), 7);
+  EXPECT_EQ(heap.len(), 9u);
+
+  BinaryHeap<i32> copy = heap.clone();
+  Vec<i32> sorted = move(copy).into_sorted_vec();
+  EXPECT_EQ(sorted[0], -2);
+  EXPECT_EQ(sorted[8], 6);
+  EXPECT_EQ(move(heap).into_vec().len(), 9u);
+}
+
+GTEST_TEST(binary_heap, string) {
+  BinaryHeap<String, 2> heap;
+  const char *words[] = {"timer", "alarm", "wake", "sleep", "tick"};
+  for (const char *word : words) {
+    heap.push(String::from(Str::from_utf8_unchecked(
+        Slice<const u8>::from_raw_parts(
+            reinterpret_cast<const u8 *>(word), std::strlen(word)))));
+  }
+  EXPECT_EQ(heap.pop().unwrap().as_str(), Str::from_static("wake"));
+
+  BinaryHeap<String, 2> copy = heap.clone();
+  Vec<String> sorted = move(copy).into_sorted_vec();
+  EXPECT_EQ(sorted.len(), 4u);
+  EXPECT_EQ(sorted[0].as_str(), Str::from_static("alarm"));
+  EXPECT_EQ(sorted[3].as_str(), Str::from_static("timer"));
+}
@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+
+#include "crust/collections/bit_set.hpp"
+#include "crust/utility.hpp"
+
+
+using namespace crust;
+using collections::BitSet;
+
+
+GTEST_TEST(bit_set, insert_remove) {
+  BitSet<100> set;
+  EXPECT_TRUE(set.is_empty());
+  EXPECT_EQ(BitSet<100>::capacity(), 100u);
+  EXPECT_EQ(sizeof(set), 16u);
+
+  EXPECT_TRUE(set.insert(3));
+  EXPECT_TRUE(set.insert(99));
+  EXPECT_FALSE(set.insert(3));
+  EXPECT_TRUE(set.contains(99));
+  EXPECT_FALSE(set.contains(100));
+  EXPECT_EQ(set.len(), 2u);
+
+  EXPECT_TRUE(set.remove(3));
+  EXPECT_FALSE(set.remove(3));
+  EXPECT_FALSE(set.remove(1000));
+  EXPECT_EQ(set.len(), 1u);
+
+  BitSet<100> copy = set.clone();
+  EXPECT_TRUE(copy == set);
+  copy.clear();
+  EXPECT_TRUE(copy != set);
+}
+
+GTEST_TEST(bit_set, set_ops) {
+  BitSet<130> even;
+  BitSet<130> triple;
+  for (usize i = 0; i < 130; ++i) {
+    if (i % 2 == 0) {
+      even.insert(i);
+    }
+    if (i % 3 == 0) {
+      triple.insert(i);
+    }
+  }
+
+  BitSet<130> sixth = even;
+  sixth.intersect_with(triple);
+  EXPECT_EQ(sixth.len(), 22u);
+  EXPECT_TRUE(sixth.is_subset(even));
+  EXPECT_TRUE(triple.is_superset(sixth));
+  EXPECT_FALSE(even.is_subset(triple));
+
+  BitSet<130> either = even;
+  either.union_with(triple);
+  EXPECT_EQ(either.len(), 87u);
+
+  BitSet<130> rest = even;
+  rest.difference_with(triple);
+  EXPECT_EQ(rest.len(), 43u);
+  EXPECT_TRUE(rest.is_disjoint(triple));
+
+  BitSet<130> one = even;
+  one.symmetric_difference_with(triple);
+  EXPECT_EQ(one.len(), either.len() - sixth.len());
+}
+
+GTEST_TEST(bit_set, iter_rank_select) {
+  BitSet<200> set;
+  usize elems[] = {1, 64, 65, 128, 199};
+  for (usize i : elems) {
+    set.insert(i);
+  }
+
+  auto iter = set.iter();
+  for (usize i : elems) {
+    EXPECT_EQ(iter.next(), make_some(i));
+  }
+  EXPECT_TRUE(iter.next().is_none());
+
+  EXPECT_EQ(set.rank(0), 0u);
+  EXPECT_EQ(set.rank(65), 2u);
+  EXPECT_EQ(set.rank(200), 5u);
+  EXPECT_EQ(set.select(2), make_some(usize{65}));
+  EXPECT_EQ(set.select(4), make_some(usize{199}));
+  EXPECT_TRUE(set.select(5).is_none());
+}
@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+
+#include "crust/collections/bit_vec.hpp"
+#include "crust/num/mod.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+using namespace crust;
+using collections::BitVec;
+
+
+namespace {
+u32 next_random(u32 &state) {
+  state = state * 1103515245u + 12345u;
+  return state >> 8;
+}
+
+BitVec random_bits(usize len, u32 seed) {
+  BitVec ret;
+  for (usize i = 0; i < len; ++i) {
+    ret.push(next_random(seed) % 3 == 0);
+  }
+  return ret;
+}
+} // namespace
+
+GTEST_TEST(bit_vec, num) {
+  EXPECT_EQ(num::count_ones(0), 0u);
+  EXPECT_EQ(num::count_ones(0xF0F0u), 8u);
+  EXPECT_EQ(num::count_ones(~u64{0}), 64u);
+  EXPECT_EQ(num::trailing_zeros(0), 64u);
+  EXPECT_EQ(num::trailing_zeros(1), 0u);
+  EXPECT_EQ(num::trailing_zeros(u64{1} << 63), 63u);
+}
+
+GTEST_TEST(bit_vec, push_get) {
+  BitVec bits;
+  EXPECT_TRUE(bits.pop().is_none());
+  for (usize i = 0; i < 200; ++i) {
+    bits.push(i % 3 == 0);
+  }
+  EXPECT_EQ(bits.len(), 200u);
+  EXPECT_EQ(bits.as_words().len(), 4u);
+  EXPECT_EQ(bits.get(3), make_some(true));
+  EXPECT_EQ(bits.get(4), make_some(false));
+  EXPECT_TRUE(bits.get(200).is_none());
+  EXPECT_EQ(bits.count_ones(), 67u);
+
+  bits.set(4, true);
+  EXPECT_EQ(bits.get(4), make_some(true));
+  EXPECT_EQ(bits.pop(), make_some(false));
+  EXPECT_EQ(bits.pop(), make_some(true));
+  bits.truncate(65);
+  EXPECT_EQ(bits.as_words().len(), 2u);
+  EXPECT_EQ(bits.count_ones(), 23u);
+
+  BitVec ones = BitVec::from_elem(70, true);
+  EXPECT_EQ(ones.count_ones(), 70u);
+  ones.fill(false);
+  EXPECT_FALSE(ones.any());
+  ones.fill(true);
+  EXPECT_EQ(ones.as_words()[1], 0x3Fu);
+
+  BitVec copy = bits.clone();
+  EXPECT_TRUE(copy == bits);
+  copy.set(0, false);
+  EXPECT_TRUE(copy != bits);
+
+  BitVec moved{move(copy)};
+  EXPECT_EQ(moved.len(), 65u);
+  EXPECT_TRUE(copy.is_empty());
+  copy.push(true);
+  EXPECT_EQ(copy.get(0), make_some(true));
+  copy = move(moved);
+  EXPECT_EQ(copy.len(), 65u);
+  EXPECT_TRUE(moved.is_empty());
+}
+
+GTEST_TEST(bit_vec, set_ops) {
+  BitVec a = random_bits(1000, 1);
+  BitVec b = random_bits(1000, 2);
+
+  BitVec both = a.clone();
+  both.intersect_with(b);
+  BitVec either = a.clone();
+  either.union_with(b);
+  BitVec only_a = a.clone();
+  only_a.difference_with(b);
+  BitVec one = a.clone();
+  one.symmetric_difference_with(b);
+
+  for (usize i = 0; i < 1000; ++i) {
+    bool x = a.get(i).unwrap();
+    bool y = b.get(i).unwrap();
+    EXPECT_EQ(both.get(i).unwrap(), x && y);
+    EXPECT_EQ(either.get(i).unwrap(), x || y);
+    EXPECT_EQ(only_a.get(i).unwrap(), x && !y);
+    EXPECT_EQ(one.get(i).unwrap(), x != y);
+  }
+  EXPECT_EQ(either.count_ones(), both.count_ones() + one.count_ones());
+}
+
+GTEST_TEST(bit_vec, iter_ones) {
+  BitVec empty;
+  EXPECT_TRUE(empty.iter_ones().next().is_none());
+
+  BitVec bits = BitVec::from_elem(300, false);
+  usize expected[] = {0, 63, 64, 130, 299};
+  for (usize i : expected) {
+    bits.set(i, true);
+  }
+  auto iter = bits.iter_ones();
+  for (usize i : expected) {
+    EXPECT_EQ(iter.next(), make_some(i));
+  }
+  EXPECT_TRUE(iter.next().is_none());
+  EXPECT_TRUE(iter.next().is_none());
+
+  BitVec random = random_bits(777, 3);
+  usize count = 0;
+  auto ones = random.iter_ones();
+  for (auto x = ones.next(); x.is_some(); x = ones.next()) {
+    EXPECT_EQ(random.get(move(x).unwrap()), make_some(true));
+    ++count;
+  }
+  EXPECT_EQ(count, random.count_ones());
+}
+
+GTEST_TEST(bit_vec, rank_select) {
+  for (usize len : {0u, 1u, 64u, 511u, 512u, 513u, 3000u}) {
+    BitVec bits = random_bits(len, static_cast<u32>(len));
+    auto index = bits.rank_index();
+    EXPECT_EQ(index.count_ones(), bits.count_ones());
+
+    usize ones = 0;
+    for (usize i = 0; i <= len; ++i) {
+      EXPECT_EQ(bits.rank(i), ones);
+      EXPECT_EQ(index.rank(i), ones);
+      if (i < len && bits.get(i).unwrap()) {
+        EXPECT_EQ(bits.select(ones), make_some(i));
+        EXPECT_EQ(index.select(ones), make_some(i));
+        ++ones;
+      }
+    }
+    EXPECT_TRUE(bits.select(ones).is_none());
+    EXPECT_TRUE(index.select(ones).is_none());
+  }
+}
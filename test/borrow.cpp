@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+
+#include "crust/borrow.hpp"
+#include "crust/string.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+#include "alloc_checker.hpp"
+#include "raii_checker.hpp"
+
+
+using namespace crust;
+using borrow::make_borrowed;
+using borrow::make_owned;
+
+
+namespace {
+struct Tracked : test::RAIIChecker<Tracked> {
+  CRUST_USE_BASE_CONSTRUCTORS(Tracked, test::RAIIChecker<Tracked>);
+};
+
+/// clamps negative values to zero, copying only when one is found.
+Cow<Vec<i32>> clamp(const Vec<i32> &values) {
+  Cow<Vec<i32>> ret = make_borrowed(values);
+  for (usize i = 0; i < values.len(); ++i) {
+    if (values[i] < 0) {
+      ret.to_mut()[i] = 0;
+    }
+  }
+  return ret;
+}
+
+/// ends `line' with a newline, copying only when it is missing.
+Cow<Str> terminate(const Str &line) {
+  Cow<Str> ret = make_borrowed(line);
+  if (!line.ends_with(Str::from_static("\n"))) {
+    ret.to_mut().push('\n');
+  }
+  return ret;
+}
+
+Vec<i32> vec_of(std::initializer_list<i32> values) {
+  Vec<i32> ret;
+  for (i32 value : values) {
+    ret.push(value);
+  }
+  return ret;
+}
+} // namespace
+
+GTEST_TEST(borrow, cow) {
+  Vec<i32> clean = vec_of({1, 2, 3});
+  Cow<Vec<i32>> same = make_borrowed(clean);
+  CRUST_EXPECT_NO_ALLOC(same = clamp(clean));
+  EXPECT_TRUE(same.is_borrowed());
+  EXPECT_EQ(&*same, &clean);
+  EXPECT_EQ(same->len(), 3u);
+
+  Vec<i32> dirty = vec_of({-1, 2, -3});
+  Cow<Vec<i32>> fixed = clamp(dirty);
+  EXPECT_TRUE(fixed.is_owned());
+  EXPECT_EQ(*fixed, vec_of({0, 2, 0}));
+  EXPECT_EQ(dirty, vec_of({-1, 2, -3}));
+
+  EXPECT_TRUE(same != fixed);
+  EXPECT_TRUE(make_owned(vec_of({1, 2, 3})) == same);
+
+  Cow<Vec<i32>> copy = same.clone();
+  EXPECT_TRUE(copy.is_borrowed());
+  copy = fixed.clone();
+  EXPECT_TRUE(copy.is_owned());
+  EXPECT_NE(&*copy, &*fixed);
+
+  Vec<i32> owned = move(same).into_owned();
+  EXPECT_EQ(owned, clean);
+  EXPECT_NE(owned.as_ptr(), clean.as_ptr());
+  EXPECT_EQ(move(fixed).into_owned(), vec_of({0, 2, 0}));
+}
+
+GTEST_TEST(borrow, cow_str) {
+  Str done = Str::from_static("a line\n");
+  Cow<Str> same = make_borrowed(done);
+  CRUST_EXPECT_NO_ALLOC(same = terminate(done));
+  EXPECT_TRUE(same.is_borrowed());
+  EXPECT_EQ((*same).as_ptr(), done.as_ptr());
+
+  Str open = Str::from_static("a line");
+  Cow<Str> fixed = terminate(open);
+  EXPECT_TRUE(fixed.is_owned());
+  EXPECT_EQ(*fixed, done);
+  EXPECT_EQ(fixed->len(), 7u);
+  EXPECT_TRUE(fixed == same);
+
+  String owned = move(same).into_owned();
+  EXPECT_EQ(owned.as_str(), done);
+  EXPECT_EQ(move(fixed).into_owned(), owned);
+
+  i32 values[]{1, -2, 3};
+  auto slice = Slice<const i32>::from_raw_parts(values, 3);
+  Cow<Slice<const i32>> view = make_borrowed(slice);
+  view.to_mut()[1] = 2;
+  EXPECT_TRUE(view.is_owned());
+  EXPECT_EQ((*view)[1], 2);
+  EXPECT_EQ(values[1], -2);
+  EXPECT_EQ(move(view).into_owned(), vec_of({1, 2, 3}));
+}
+
+GTEST_TEST(borrow, to_mut) {
+  String base = String::from(Str::from_static("a string past the inline size"));
+  Cow<String> str = make_borrowed(base);
+  str.to_mut().push_str(Str::from_static("!"));
+  EXPECT_TRUE(str.is_owned());
+  const u8 *data = str->as_str().as_bytes().as_ptr();
+  CRUST_EXPECT_NO_ALLOC(str.to_mut());
+  EXPECT_EQ(str->as_str().as_bytes().as_ptr(), data);
+  EXPECT_EQ(base.len() + 1, str->len());
+}
+
+GTEST_TEST(borrow, raii) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  Tracked value{recorder};
+  Cow<Tracked> cow = make_borrowed(value);
+  Cow<Tracked> owned = make_owned(Tracked{recorder});
+  cow.to_mut();
+  cow = move(owned);
+  Tracked taken = move(cow).into_owned();
+}
@@ -0,0 +1,210 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+#include "crust/alloc/arena.hpp"
+#include "crust/boxed.hpp"
+#include "crust/ops/range.hpp"
+#include "crust/str.hpp"
+#include "crust/string.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+#include "raii_checker.hpp"
+
+
+using namespace crust;
+using boxed::Box;
+using boxed::DynBox;
+using boxed::InlineDynBox;
+
+
+namespace {
+struct Checker : test::RAIIChecker<Checker> {
+  CRUST_USE_BASE_CONSTRUCTORS(Checker, test::RAIIChecker<Checker>);
+};
+
+/// the virtual function counterpart of `DynBox<Trait<iter::Iterator, u64>>'.
+struct VirtualIter {
+  virtual ~VirtualIter() = default;
+
+  virtual Option<u64> next() = 0;
+};
+
+template <class I>
+struct VirtualIterOf : VirtualIter {
+  I iter;
+
+  explicit VirtualIterOf(I &&iter) : iter{move(iter)} {}
+
+  Option<u64> next() override { return iter.next(); }
+};
+
+struct VirtualBox {
+  std::unique_ptr<VirtualIter> ptr;
+
+  template <class I>
+  explicit VirtualBox(I &&iter) : ptr{new VirtualIterOf<I>{move(iter)}} {}
+
+  Option<u64> next() { return ptr->next(); }
+};
+
+constexpr u64 BENCH_OBJECTS = 1024;
+constexpr u64 BENCH_CALLS = 1024;
+
+/// half of the objects count up and half count down, so the call site sees
+/// both types.
+template <class Box>
+Vec<Box> bench_objects() {
+  Vec<Box> ret;
+  for (u64 i = 0; i < BENCH_OBJECTS; ++i) {
+    range::Range<u64> range{0, BENCH_CALLS};
+    if (i % 2 == 0) {
+      ret.push(Box{move(range)});
+    } else {
+      ret.push(Box{move(range).rev()});
+    }
+  }
+  return ret;
+}
+
+/// calls `next' round robin over every object until all of them are done.
+template <class Box>
+void bench_dispatch(const char *name, Vec<Box> objects) {
+  u64 sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (u64 call = 0; call < BENCH_CALLS; ++call) {
+    for (usize i = 0; i < objects.len(); ++i) {
+      sum += objects[i].next().unwrap();
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(sum, BENCH_OBJECTS * BENCH_CALLS * (BENCH_CALLS - 1) / 2);
+  std::printf(
+      "%-26s %6.2f ns/call\n",
+      name,
+      elapsed.count() / (BENCH_OBJECTS * BENCH_CALLS) * 1e9);
+}
+} // namespace
+
+struct Point;
+
+namespace crust {
+template <class S>
+CRUST_IMPL_FOR(fmt::Display<S>, IsSame<S, Point>) {
+  CRUST_IMPL_USE_SELF(S);
+
+  bool fmt_display(fmt::Formatter &fmt) const {
+    return fmt.write_str(Str::from_static("(")) && fmt.write_str(self().x) &&
+        fmt.write_str(Str::from_static(", ")) && fmt.write_str(self().y) &&
+        fmt.write_str(Str::from_static(")"));
+  }
+};
+} // namespace crust
+
+struct Point : Impl<Point, Trait<fmt::Display>> {
+  Str x;
+  Str y;
+
+  Point(Str x, Str y) : x{x}, y{y} {}
+};
+
+GTEST_TEST(boxed, box) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  crust_static_assert(sizeof(Box<i32>) == sizeof(void *));
+
+  Box<i32> a{1};
+  Box<i32> b{2};
+  EXPECT_EQ(*a, 1);
+  EXPECT_TRUE(a < b);
+  *a = 2;
+  EXPECT_TRUE(a == b);
+
+  Box<i32> c = clone::clone(a);
+  EXPECT_NE(c.as_ptr(), a.as_ptr());
+  EXPECT_EQ(*c, 2);
+  EXPECT_EQ(move(c).into_inner(), 2);
+
+  Box<Vec<i32>> nested{range::Range<i32>{0, 3}.collect<Vec<i32>>()};
+  Box<Vec<i32>> copy = nested.clone();
+  EXPECT_EQ(*copy, *nested);
+  EXPECT_NE(copy->as_ptr(), nested->as_ptr());
+  copy->push(3);
+  copy.clone_from(nested);
+  EXPECT_EQ(*copy, *nested);
+
+  Box<Checker> checker{Checker{recorder}};
+  Box<Checker> moved{move(checker)};
+  EXPECT_EQ(checker.as_ptr(), nullptr);
+  checker = move(moved);
+  EXPECT_NE(checker.as_ptr(), nullptr);
+
+  Checker *raw = checker.into_raw();
+  Box<Checker> owner = Box<Checker>::from_raw(raw);
+  EXPECT_EQ(owner.as_ptr(), raw);
+
+  alloc::Arena arena;
+  Box<i32, alloc::ArenaRef> in_arena{3, arena};
+  EXPECT_EQ(*in_arena, 3);
+}
+
+GTEST_TEST(boxed, dyn_box) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  crust_static_assert(
+      sizeof(DynBox<Trait<fmt::Display>>) == 2 * sizeof(void *));
+  crust_static_assert(
+      sizeof(InlineDynBox<Trait<fmt::Display>>) == 4 * sizeof(void *));
+
+  DynBox<Trait<fmt::Display>> point{
+      Point{Str::from_static("1"), Str::from_static("-2")}};
+  EXPECT_EQ(to_string(point).as_str(), Str::from_static("(1, -2)"));
+  EXPECT_EQ(point.size_of_val(), sizeof(Point));
+
+  DynBox<Trait<fmt::Display>> text{String::from(Str::from_static("text"))};
+  EXPECT_EQ(to_string(text).as_str(), Str::from_static("text"));
+
+  text = move(point);
+  EXPECT_FALSE(point.is_valid());
+  EXPECT_EQ(to_string(text).as_str(), Str::from_static("(1, -2)"));
+
+  DynBox<Trait<fmt::Debug>> debug{Str::from_static("a\"b")};
+  String out;
+  fmt::Formatter fmt = out.formatter();
+  EXPECT_TRUE(debug.fmt_debug(fmt));
+  EXPECT_EQ(out.as_str(), Str::from_static("\"a\\\"b\""));
+
+  crust_static_assert(
+      !std::is_constructible<DynBox<Trait<fmt::Display>>, Checker>::value);
+}
+
+GTEST_TEST(boxed, inline_dyn_box) {
+  InlineDynBox<Trait<iter::Iterator, i32>> small{range::Range<i32>{0, 4}};
+  EXPECT_EQ(small.size_hint().get<0>(), 4u);
+  EXPECT_EQ(small.next(), make_some(0));
+
+  InlineDynBox<Trait<iter::Iterator, i32>, 1> large{range::Range<i32>{0, 4}};
+  large.next();
+
+  InlineDynBox<Trait<iter::Iterator, i32>> moved{move(small)};
+  EXPECT_EQ(moved.next(), make_some(1));
+  moved = move(large);
+  EXPECT_EQ(moved.next(), make_some(1));
+  EXPECT_EQ(
+      moved.fold(0, ops::bind([](i32 &&acc, i32 &&x) { return acc + x; })),
+      5);
+}
+
+/// run with `--gtest_also_run_disabled_tests'.
+GTEST_TEST(boxed, DISABLED_bench_dispatch) {
+  using Dyn = DynBox<Trait<iter::Iterator, u64>>;
+  using InlineDyn = InlineDynBox<Trait<iter::Iterator, u64>>;
+
+  bench_dispatch("DynBox", bench_objects<Dyn>());
+  bench_dispatch("InlineDynBox", bench_objects<InlineDyn>());
+  bench_dispatch("virtual + std::unique_ptr", bench_objects<VirtualBox>());
+}
@@ -0,0 +1,198 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <map>
+
+#include "crust/collections/btree_map.hpp"
+#include "crust/ops/range.hpp"
+#include "crust/str.hpp"
+#include "crust/string.hpp"
+#include "crust/utility.hpp"
+
+#include "raii_checker.hpp"
+
+
+using namespace crust;
+using collections::BTreeMap;
+
+
+namespace {
+struct Checker : test::RAIIChecker<Checker> {
+  CRUST_USE_BASE_CONSTRUCTORS(Checker, test::RAIIChecker<Checker>);
+};
+
+u32 next_random(u32 &state) {
+  state = state * 1103515245u + 12345u;
+  return state >> 8;
+}
+
+template <class K, class V>
+void expect_same(const BTreeMap<K, V> &map, const std::map<K, V> &expected) {
+  EXPECT_EQ(map.len(), expected.size());
+  auto iter = map.iter();
+  EXPECT_EQ(iter.len(), expected.size());
+  for (auto &pair : expected) {
+    auto next = iter.next();
+    ASSERT_TRUE(next.is_some());
+    EXPECT_EQ(*move(next).unwrap().template get<0>(), pair.first);
+  }
+  EXPECT_TRUE(iter.next().is_none());
+
+  auto back = map.iter();
+  for (auto it = expected.rbegin(); it != expected.rend(); ++it) {
+    EXPECT_EQ(*back.next_back().unwrap().template get<1>(), it->second);
+  }
+  EXPECT_TRUE(back.next_back().is_none());
+}
+} // namespace
+
+GTEST_TEST(btree_map, node) {
+  usize capacity = _impl_btree::LeafNode<i32, i32>::CAPACITY;
+  EXPECT_EQ(capacity, 16u);
+  EXPECT_EQ(capacity * sizeof(i32) % CACHE_LINE, 0u);
+  capacity = _impl_btree::LeafNode<u8, i32>::CAPACITY;
+  EXPECT_EQ(capacity, 64u);
+  capacity = _impl_btree::LeafNode<String, i32>::CAPACITY;
+  EXPECT_GE(capacity, 11u);
+  EXPECT_EQ(alignof(_impl_btree::LeafNode<i64, i64>), 64u);
+}
+
+GTEST_TEST(btree_map, insert_get_remove) {
+  BTreeMap<i32, i32> map;
+  std::map<i32, i32> expected;
+  EXPECT_TRUE(map.get(1).is_none());
+  EXPECT_TRUE(map.first_key_value().is_none());
+
+  u32 state = 42;
+  for (i32 i = 0; i < 5000; ++i) {
+    i32 key = static_cast<i32>(next_random(state) % 4000);
+    EXPECT_EQ(map.insert(key, i).is_none(), expected.count(key) == 0);
+    expected[key] = i;
+  }
+  expect_same(map, expected);
+  for (auto &pair : expected) {
+    EXPECT_EQ(*map.get(pair.first).unwrap(), pair.second);
+  }
+  EXPECT_FALSE(map.contains_key(-1));
+
+  for (i32 i = 0; i < 6000; ++i) {
+    i32 key = static_cast<i32>(next_random(state) % 4000);
+    auto it = expected.find(key);
+    if (it == expected.end()) {
+      EXPECT_TRUE(map.remove(key).is_none());
+    } else {
+      EXPECT_EQ(map.remove(key), make_some(it->second));
+      expected.erase(it);
+    }
+    if (i % 1000 == 0) {
+      expect_same(map, expected);
+    }
+  }
+  expect_same(map, expected);
+
+  *map.get_mut(expected.begin()->first).unwrap() = -1;
+  expected.begin()->second = -1;
+  EXPECT_EQ(*map.first_key_value().unwrap().get<1>(), -1);
+  EXPECT_EQ(*map.last_key_value().unwrap().get<0>(), expected.rbegin()->first);
+
+  while (!expected.empty()) {
+    auto first = map.pop_first().unwrap();
+    EXPECT_EQ(first.get<0>(), expected.begin()->first);
+    expected.erase(expected.begin());
+    if (!expected.empty()) {
+      EXPECT_EQ(map.pop_last().unwrap().get<0>(), expected.rbegin()->first);
+      expected.erase(std::prev(expected.end()));
+    }
+  }
+  EXPECT_TRUE(map.is_empty());
+  EXPECT_TRUE(map.pop_first().is_none());
+  map.insert(1, 1);
+  EXPECT_EQ(map.len(), 1u);
+}
+
+GTEST_TEST(btree_map, range) {
+  BTreeMap<i32, i32> map;
+  for (i32 i = 0; i < 1000; i += 2) {
+    map.insert(i, i * 10);
+  }
+
+  auto range = map.range(range::Range<i32>{101, 200});
+  for (i32 i = 102; i < 200; i += 2) {
+    auto pair = range.next().unwrap();
+    EXPECT_EQ(*pair.get<0>(), i);
+    EXPECT_EQ(*pair.get<1>(), i * 10);
+  }
+  EXPECT_TRUE(range.next().is_none());
+
+  range = map.range(range::Range<i32>{100, 110});
+  EXPECT_EQ(*range.next_back().unwrap().get<0>(), 108);
+  EXPECT_EQ(*range.next().unwrap().get<0>(), 100);
+  EXPECT_EQ(*range.next_back().unwrap().get<0>(), 106);
+  EXPECT_EQ(*range.next().unwrap().get<0>(), 102);
+  EXPECT_EQ(*range.next().unwrap().get<0>(), 104);
+  EXPECT_TRUE(range.next().is_none());
+  EXPECT_TRUE(range.next_back().is_none());
+
+  EXPECT_TRUE(map.range(range::Range<i32>{300, 100}).next().is_none());
+  EXPECT_TRUE(map.range(range::Range<i32>{301, 302}).next().is_none());
+  EXPECT_TRUE(map.range(range::RangeFrom<i32>{999}).next().is_none());
+  range = map.range(range::RangeFrom<i32>{997});
+  EXPECT_EQ(*range.next().unwrap().get<0>(), 998);
+  range = map.range(range::RangeTo<i32>{3});
+  EXPECT_EQ(*range.next_back().unwrap().get<0>(), 2);
+
+  i32 count = 0;
+  auto full = map.range(range::RangeFull{});
+  for (auto pair = full.next(); pair.is_some(); pair = full.next()) {
+    ++count;
+  }
+  EXPECT_EQ(count, 500);
+}
+
+GTEST_TEST(btree_map, traits) {
+  BTreeMap<i32, i32> squares =
+      range::Range<i32>{0, 100}
+          .zip(range::Range<i32>{100, 200})
+          .collect<BTreeMap<i32, i32>>();
+  EXPECT_EQ(squares.len(), 100u);
+  EXPECT_EQ(*squares.get(42).unwrap(), 142);
+
+  BTreeMap<String, i32> map;
+  const char *words[] = {"pear", "apple", "fig", "banana"};
+  for (const char *word : words) {
+    Str key = Str::from_utf8_unchecked(Slice<const u8>::from_raw_parts(
+        reinterpret_cast<const u8 *>(word), std::strlen(word)));
+    map.insert(String::from(key), static_cast<i32>(key.len()));
+  }
+  EXPECT_EQ(
+      map.first_key_value().unwrap().get<0>()->as_str(),
+      Str::from_static("apple"));
+
+  BTreeMap<String, i32> copy = map.clone();
+  EXPECT_TRUE(copy == map);
+  auto iter = copy.iter_mut();
+  for (auto pair = iter.next(); pair.is_some(); pair = iter.next()) {
+    *move(pair).unwrap().get<1>() += 1;
+  }
+  EXPECT_TRUE(copy != map);
+  EXPECT_EQ(*copy.get(String::from(Str::from_static("fig"))).unwrap(), 4);
+}
+
+GTEST_TEST(btree_map, raii) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  BTreeMap<i32, Checker> map;
+  for (i32 i = 0; i < 500; ++i) {
+    map.insert(i, Checker{recorder});
+  }
+  map.insert(3, Checker{recorder});
+  for (i32 i = 0; i < 500; i += 3) {
+    map.remove(i);
+  }
+  BTreeMap<i32, Checker> copy = map.clone();
+  map.clear();
+  EXPECT_EQ(copy.len(), 333u);
+  map = move(copy);
+  map.pop_first();
+  map.pop_last();
+}
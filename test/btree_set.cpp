@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include "crust/collections/btree_set.hpp"
+#include "crust/ops/range.hpp"
+#include "crust/str.hpp"
+#include "crust/string.hpp"
+#include "crust/utility.hpp"
+
+
+using namespace crust;
+using collections::BTreeSet;
+
+
+GTEST_TEST(btree_set, btree_set) {
+  BTreeSet<String> set;
+  EXPECT_TRUE(set.insert(String::from(Str::from_static("b"))));
+  EXPECT_TRUE(set.insert(String::from(Str::from_static("a"))));
+  EXPECT_FALSE(set.insert(String::from(Str::from_static("b"))));
+  EXPECT_EQ(set.len(), 2u);
+  EXPECT_TRUE(set.contains(String::from(Str::from_static("a"))));
+  EXPECT_EQ(set.first().unwrap()->as_str(), Str::from_static("a"));
+  EXPECT_EQ(set.last().unwrap()->as_str(), Str::from_static("b"));
+
+  BTreeSet<String> copy = set.clone();
+  EXPECT_TRUE(copy == set);
+  EXPECT_TRUE(set.remove(String::from(Str::from_static("a"))));
+  EXPECT_FALSE(set.remove(String::from(Str::from_static("a"))));
+  EXPECT_TRUE(copy != set);
+
+  Option<String> taken = copy.take(String::from(Str::from_static("a")));
+  EXPECT_EQ(move(taken).unwrap().as_str(), Str::from_static("a"));
+  EXPECT_TRUE(copy == set);
+}
+
+GTEST_TEST(btree_set, range) {
+  BTreeSet<i32> set = range::Range<i32>{0, 1000}.collect<BTreeSet<i32>>();
+  EXPECT_EQ(set.len(), 1000u);
+
+  i32 sum = 0;
+  auto range = set.range(range::Range<i32>{10, 20});
+  for (auto x = range.next(); x.is_some(); x = range.next()) {
+    sum += *move(x).unwrap();
+  }
+  EXPECT_EQ(sum, 145);
+
+  auto iter = set.iter();
+  EXPECT_EQ(iter.len(), 1000u);
+  EXPECT_EQ(*iter.next_back().unwrap(), 999);
+  EXPECT_EQ(*iter.next().unwrap(), 0);
+  EXPECT_EQ(iter.len(), 998u);
+
+  for (i32 i = 0; i < 1000; ++i) {
+    if (i % 10 != 0) {
+      EXPECT_TRUE(set.remove(i));
+    }
+  }
+  EXPECT_EQ(set.len(), 100u);
+  EXPECT_EQ(*set.range(range::RangeFrom<i32>{11}).next().unwrap(), 20);
+  EXPECT_EQ(set.pop_first(), make_some(0));
+  EXPECT_EQ(set.pop_last(), make_some(990));
+}
@@ -52,7 +52,7 @@ GTEST_TEST(enum_, enum_) {
   crust_static_assert(!Require<EnumA, cmp::PartialEq>::result);
   crust_static_assert(!Require<EnumA, cmp::Eq>::result);
 
-  auto recorder = std::make_shared<test::RAIIRecorder>(test::RAIIRecorder{});
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
 
   EnumA a;
   a = EnumA{ClassA{recorder}};
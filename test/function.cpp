@@ -1,8 +1,12 @@
 #include "gtest/gtest.h"
 
+#include <memory>
+
+#include "crust/alloc/arena.hpp"
 #include "crust/ops/function.hpp"
 #include "crust/utility.hpp"
 
+#include "alloc_checker.hpp"
 #include "raii_checker.hpp"
 
 
@@ -50,7 +54,7 @@ i32 test_dyn_fn_mut(ops::DynFnMut<i32()> fn) { return fn(); }
 } // namespace
 
 GTEST_TEST(function, raii) {
-  auto recorder = std::make_shared<test::RAIIRecorder>();
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
 
   GTEST_ASSERT_EQ(bind(crust_tmpl_val(&fn_d))(11), 11);
   GTEST_ASSERT_EQ(bind(crust_tmpl_val(&fn_e))(12), 12);
@@ -81,3 +85,163 @@ GTEST_TEST(function, raii) {
   GTEST_ASSERT_EQ(test_dyn_fn_mut(A{recorder}), 1);
   GTEST_ASSERT_EQ(test_dyn_fn_mut([]() mutable { return 8; }), 8);
 }
+
+GTEST_TEST(function, dyn_fn_storage) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  crust_static_assert(sizeof(ops::DynFn<i32()>) == 4 * sizeof(void *));
+  crust_static_assert(sizeof(ops::DynFnMut<i32()>) == 4 * sizeof(void *));
+
+  i64 large[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  ops::DynFn<i32()> heap{[large]() { return static_cast<i32>(large[7]); }};
+  ops::DynFn<i32()> inline_{A{recorder}};
+
+  ops::DynFn<i32()> moved{move(heap)};
+  GTEST_ASSERT_EQ(moved(), 8);
+  heap = move(inline_);
+  GTEST_ASSERT_EQ(heap(), 2);
+  moved = move(heap);
+  GTEST_ASSERT_EQ(moved(), 2);
+
+  i32 count = 0;
+  ops::DynFnMut<i32()> counter{[&count, large]() mutable {
+    large[0] += 1;
+    return count += static_cast<i32>(large[0]);
+  }};
+  GTEST_ASSERT_EQ(counter(), 2);
+  ops::DynFnMut<i32()> other{A{recorder}};
+  GTEST_ASSERT_EQ(other(), 1);
+  other = move(counter);
+  GTEST_ASSERT_EQ(other(), 5);
+  GTEST_ASSERT_EQ(count, 5);
+}
+
+namespace {
+i32 test_dyn_fn_ref(ops::DynFnRef<i32(i32)> fn) { return fn(1) + fn(2); }
+
+i32 test_dyn_fn_mut_ref(ops::DynFnMutRef<i32()> fn) { return fn() + fn(); }
+} // namespace
+
+GTEST_TEST(function, dyn_fn_ref) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  crust_static_assert(sizeof(ops::DynFnRef<i32()>) == 2 * sizeof(void *));
+  crust_static_assert(sizeof(ops::DynFnMutRef<i32()>) == 2 * sizeof(void *));
+
+  i32 offset = 10;
+  auto add = [&offset](i32 a) { return a + offset; };
+  GTEST_ASSERT_EQ(test_dyn_fn_ref(add), 23);
+  GTEST_ASSERT_EQ(test_dyn_fn_ref(crust_tmpl_val(&fn_d)), 3);
+  GTEST_ASSERT_EQ(test_dyn_fn_ref([](i32 a) { return a * 2; }), 6);
+
+  i32 count = 0;
+  auto counter = [&count]() mutable { return ++count; };
+  GTEST_ASSERT_EQ(test_dyn_fn_mut_ref(counter), 3);
+  GTEST_ASSERT_EQ(test_dyn_fn_mut_ref(counter), 7);
+  GTEST_ASSERT_EQ(count, 4);
+
+  A a{recorder};
+  GTEST_ASSERT_EQ(test_dyn_fn_mut_ref(a), 2);
+  GTEST_ASSERT_EQ(test_dyn_fn_mut_ref(crust_tmpl_val(&fn_c)), 10);
+}
+
+namespace {
+struct Task : test::RAIIChecker<Task> {
+  std::unique_ptr<i32> value;
+
+  Task(const rc::Rc<test::RAIIRecorder> &recorder, i32 value) :
+      test::RAIIChecker<Task>{recorder},
+      value{new i32{value}} {}
+
+  i32 operator()(i32 a) && { return *value + a; }
+
+  void operator()() && {}
+};
+
+i32 test_fn_once(ops::FnOnce<Task, i32(i32)> fn) { return move(fn)(1); }
+} // namespace
+
+GTEST_TEST(function, dyn_fn_once) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  GTEST_ASSERT_EQ(test_fn_once(ops::bind_once<i32(i32)>(Task{recorder, 2})), 3);
+
+  ops::DynFnOnce<i32(i32)> inline_{Task{recorder, 4}};
+  GTEST_ASSERT_TRUE(inline_.is_callable());
+  GTEST_ASSERT_EQ(move(inline_)(1), 5);
+  GTEST_ASSERT_FALSE(inline_.is_callable());
+
+  i64 large[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  std::unique_ptr<i32> owned{new i32{10}};
+  i32 *raw = owned.get();
+  ops::DynFnOnce<i32(i32)> heap{[large, raw](i32 a) {
+    std::unique_ptr<i32> guard{raw};
+    return *guard + static_cast<i32>(large[7]) + a;
+  }};
+  owned.release();
+  ops::DynFnOnce<i32(i32)> moved{move(heap)};
+  GTEST_ASSERT_FALSE(heap.is_callable());
+  GTEST_ASSERT_EQ(move(moved)(1), 19);
+
+  ops::DynFnOnce<void()> dropped{Task{recorder, 6}};
+  ops::DynFnOnce<i32(i32)> fn{crust_tmpl_val(&fn_d)};
+  GTEST_ASSERT_EQ(move(fn)(7), 7);
+}
+
+namespace {
+struct alignas(32) Wide {
+  i32 lanes[8];
+
+  i32 operator()() const { return lanes[0] + lanes[7]; }
+};
+} // namespace
+
+GTEST_TEST(function, dyn_fn_alloc) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  ops::DynFn<i32()> wide{Wide{{1, 0, 0, 0, 0, 0, 0, 2}}};
+  GTEST_ASSERT_EQ(wide(), 3);
+
+  alloc::Arena arena;
+  i64 large[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  {
+    ops::DynFn<i32(), alloc::ArenaRef> fn{
+        [large]() { return static_cast<i32>(large[7]); }, arena};
+    ops::DynFnMut<i32(), alloc::ArenaRef> fn_mut{
+        [large]() mutable { return static_cast<i32>(++large[0]); }, arena};
+    ops::DynFnOnce<i32(), alloc::ArenaRef> fn_once{
+        [large]() { return static_cast<i32>(large[1]); }, arena};
+    ops::DynFn<i32(), alloc::ArenaRef> small{A{recorder}, arena};
+
+    ops::DynFn<i32(), alloc::ArenaRef> moved{move(fn)};
+    GTEST_ASSERT_EQ(moved(), 8);
+    GTEST_ASSERT_EQ(fn_mut(), 2);
+    GTEST_ASSERT_EQ(move(fn_once)(), 2);
+    GTEST_ASSERT_EQ(small(), 2);
+  }
+  arena.reset();
+
+  ops::DynFn<i32(), alloc::ThreadCache> cached{
+      [large]() { return static_cast<i32>(large[2]); }};
+  GTEST_ASSERT_EQ(cached(), 3);
+}
+
+GTEST_TEST(function, dyn_fn_no_alloc) {
+  i32 result = 0;
+  CRUST_EXPECT_NO_ALLOC({
+    ops::DynFn<i32(i32)> fn{[](i32 value) { return value + 1; }};
+    ops::DynFnMut<i32()> counter{[&result]() { return ++result; }};
+    ops::DynFn<i32(i32)> moved{move(fn)};
+    result = moved(1) + counter();
+  });
+  EXPECT_EQ(result, 3);
+
+  i64 large[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  alloc::StatsScope scope;
+  {
+    ops::DynFn<i32()> heap{[large]() { return static_cast<i32>(large[7]); }};
+    EXPECT_EQ(heap(), 8);
+  }
+  EXPECT_EQ(scope.stats().allocations, 1u);
+  EXPECT_EQ(scope.stats().deallocations, 1u);
+}
@@ -0,0 +1,164 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "crust/iter/generator.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+#if defined(__cpp_impl_coroutine)
+
+using namespace crust;
+using iter::Generator;
+using ops::bind;
+
+
+namespace {
+struct Node {
+  i32 value;
+  const Node *left;
+  const Node *right;
+};
+
+Generator<i32> count_to(i32 limit) {
+  for (i32 i = 0; i < limit; ++i) {
+    co_yield i;
+  }
+}
+
+Generator<i32> walk(const Node *node) {
+  if (node == nullptr) {
+    co_return;
+  }
+
+  auto left = walk(node->left);
+  for (auto value = left.next(); value.is_some(); value = left.next()) {
+    co_yield move(value).unwrap();
+  }
+
+  co_yield node->value;
+
+  auto right = walk(node->right);
+  for (auto value = right.next(); value.is_some(); value = right.next()) {
+    co_yield move(value).unwrap();
+  }
+}
+
+/// the in-order walk of `walk' with an explicit stack of pending nodes.
+struct StackWalk {
+  Vec<const Node *> stack;
+  const Node *node;
+
+  explicit StackWalk(const Node *root) : node{root} {}
+
+  Option<i32> next() {
+    while (node != nullptr) {
+      stack.push(node);
+      node = node->left;
+    }
+    Option<const Node *> top = stack.pop();
+    if (top.is_none()) {
+      return None{};
+    }
+    const Node *ret = move(top).unwrap();
+    node = ret->right;
+    return make_some(ret->value);
+  }
+};
+
+/// fills `nodes[start, end)' with a balanced tree whose in-order walk
+/// yields `start, ..., end - 1'.
+const Node *build_tree(Vec<Node> &nodes, i32 start, i32 end) {
+  if (start == end) {
+    return nullptr;
+  }
+  i32 mid = start + (end - start) / 2;
+  Node &node = nodes[static_cast<usize>(mid)];
+  node.value = mid;
+  node.left = build_tree(nodes, start, mid);
+  node.right = build_tree(nodes, mid + 1, end);
+  return &node;
+}
+
+StackWalk stack_walk(const Node *root) { return StackWalk{root}; }
+
+template <class I>
+void bench_walk(
+    const char *name, I (*make)(const Node *), const Node *root, i32 len) {
+  constexpr i32 ROUNDS = 20;
+  i64 sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (i32 round = 0; round < ROUNDS; ++round) {
+    I iter = make(root);
+    for (auto value = iter.next(); value.is_some(); value = iter.next()) {
+      sum += move(value).unwrap();
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(sum, i64{ROUNDS} * len * (len - 1) / 2);
+  std::printf(
+      "%-12s %6.2f ns/node\n", name, elapsed.count() / ROUNDS / len * 1e9);
+}
+} // namespace
+
+
+GTEST_TEST(generator, generator) {
+  crust_static_assert(Require<Generator<i32>, iter::Iterator, i32>::result);
+
+  auto gen = count_to(3);
+  EXPECT_EQ(gen.next(), make_some(0));
+  EXPECT_EQ(gen.next(), make_some(1));
+  EXPECT_EQ(gen.next(), make_some(2));
+  EXPECT_TRUE(gen.next().is_none());
+  EXPECT_TRUE(gen.next().is_none());
+
+  EXPECT_EQ(
+      count_to(5).fold(
+          0, bind([](i32 &&acc, i32 &&value) { return acc + value; })),
+      10);
+
+  auto moved = count_to(2);
+  auto other = move(moved);
+  EXPECT_TRUE(moved.next().is_none());
+  EXPECT_EQ(other.next(), make_some(0));
+}
+
+GTEST_TEST(generator, recursive) {
+  Node n1{1, nullptr, nullptr};
+  Node n3{3, nullptr, nullptr};
+  Node n2{2, &n1, &n3};
+  Node n5{5, nullptr, nullptr};
+  Node n4{4, &n2, &n5};
+
+  EXPECT_EQ(
+      walk(&n4).fold(
+          0, bind([](i32 &&acc, i32 &&value) { return acc * 10 + value; })),
+      12345);
+}
+
+GTEST_TEST(generator, frame_pool) {
+  for (i32 i = 0; i < 3; ++i) {
+    EXPECT_EQ(
+        count_to(4).fold(
+            0, bind([](i32 &&acc, i32 &&value) { return acc + value; })),
+        6);
+  }
+}
+
+/// run with `--gtest_also_run_disabled_tests'.
+GTEST_TEST(generator, DISABLED_bench_walk) {
+  constexpr i32 LEN = (1 << 16) - 1;
+  Vec<Node> nodes;
+  for (i32 i = 0; i < LEN; ++i) {
+    nodes.push(Node{0, nullptr, nullptr});
+  }
+  const Node *root = build_tree(nodes, 0, LEN);
+
+  bench_walk("generator", walk, root, LEN);
+  bench_walk("stack", stack_walk, root, LEN);
+}
+
+#endif
@@ -0,0 +1,276 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <unordered_map>
+
+#include "crust/collections/hash_map.hpp"
+#include "crust/ops/range.hpp"
+#include "crust/str.hpp"
+#include "crust/string.hpp"
+#include "crust/utility.hpp"
+
+#include "raii_checker.hpp"
+
+
+using namespace crust;
+using collections::HashMap;
+using ops::bind_mut;
+
+
+namespace {
+struct Checker : test::RAIIChecker<Checker> {
+  CRUST_USE_BASE_CONSTRUCTORS(Checker, test::RAIIChecker<Checker>);
+};
+
+String key_of(i32 value) {
+  String ret;
+  do {
+    ret.push(static_cast<u32>('0' + value % 10));
+    value /= 10;
+  } while (value != 0);
+  return ret;
+}
+
+constexpr u64 BENCH_KEYS = u64{1} << 20;
+
+/// distinct for distinct `i', spread over all 64 bits.
+u64 bench_key(u64 i) { return i * 0x9E3779B97F4A7C15u; }
+
+template <class F>
+double seconds(F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+void report(const char *workload, const char *name, double elapsed) {
+  std::printf(
+      "%-6s %-18s %6.2f ns/op\n", workload, name, elapsed / BENCH_KEYS * 1e9);
+}
+} // namespace
+
+GTEST_TEST(hash_map, hash) {
+  hash::BuildHasherDefault<hash::DefaultHasher> fixed;
+  EXPECT_EQ(hash::hash_one(fixed, 42), hash::hash_one(fixed, 42));
+  EXPECT_NE(hash::hash_one(fixed, 42), hash::hash_one(fixed, 43));
+
+  Str text = Str::from_static("swiss table");
+  EXPECT_EQ(
+      hash::hash_one(fixed, text), hash::hash_one(fixed, String::from(text)));
+  EXPECT_NE(
+      hash::hash_one(fixed, text),
+      hash::hash_one(fixed, Str::from_static("swiss tablE")));
+
+  crust_static_assert(Require<i32, hash::Hash>::result);
+  crust_static_assert(Require<String, hash::Hash>::result);
+}
+
+GTEST_TEST(hash_map, group) {
+  u8 ctrl[16] = {
+      0x12,
+      _impl_hash_map::EMPTY,
+      0x7F,
+      _impl_hash_map::DELETED,
+      0x12,
+      0x00,
+      _impl_hash_map::EMPTY,
+      0x13,
+  };
+  for (usize i = 8; i < 16; ++i) {
+    ctrl[i] = ctrl[i - 8];
+  }
+
+  auto bits = [](_impl_hash_map::SwarGroup::Mask mask) {
+    u32 ret = 0;
+    for (; mask.any(); mask = mask.remove_lowest()) {
+      ret |= 1u << mask.lowest();
+    }
+    return ret;
+  };
+  auto group = _impl_hash_map::SwarGroup::load(ctrl);
+  EXPECT_EQ(bits(group.match_byte(0x12)), 0x11u);
+  EXPECT_EQ(bits(group.match_empty()), 0x42u);
+  EXPECT_EQ(bits(group.match_empty_or_deleted()), 0x4Au);
+  EXPECT_EQ(bits(group.match_full()), 0xB5u);
+  EXPECT_EQ(group.match_empty().trailing_zeros(), 1u);
+  EXPECT_EQ(group.match_empty().leading_zeros(), 1u);
+
+#if defined(__SSE2__) || defined(_M_X64)
+  auto wide = _impl_hash_map::SseGroup::load(ctrl);
+  EXPECT_EQ(wide.match_byte(0x12).bits, 0x1111u);
+  EXPECT_EQ(wide.match_empty().bits, 0x4242u);
+  EXPECT_EQ(wide.match_full().bits, 0xB5B5u);
+  EXPECT_EQ(wide.match_empty().leading_zeros(), 1u);
+#endif
+}
+
+GTEST_TEST(hash_map, insert_get_remove) {
+  HashMap<i32, i32> map;
+  EXPECT_TRUE(map.get(1).is_none());
+  EXPECT_EQ(map.capacity(), 0u);
+
+  for (i32 i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(map.insert(i, i * 2).is_none());
+  }
+  EXPECT_EQ(map.len(), 1000u);
+  EXPECT_EQ(map.insert(7, 0), make_some(14));
+  EXPECT_EQ(*map.get(7).unwrap(), 0);
+  *map.get_mut(7).unwrap() = 14;
+
+  for (i32 i = 0; i < 1000; i += 2) {
+    EXPECT_EQ(map.remove(i), make_some(i * 2));
+  }
+  EXPECT_TRUE(map.remove(0).is_none());
+  EXPECT_EQ(map.len(), 500u);
+  for (i32 i = 0; i < 1000; ++i) {
+    EXPECT_EQ(map.contains_key(i), i % 2 == 1);
+  }
+
+  // reinserting after removals reuses deleted slots without leaking them.
+  usize capacity = map.capacity();
+  for (i32 round = 0; round < 20; ++round) {
+    for (i32 i = 0; i < 1000; i += 2) {
+      map.insert(i, i);
+    }
+    for (i32 i = 0; i < 1000; i += 2) {
+      map.remove(i);
+    }
+  }
+  EXPECT_EQ(map.capacity(), capacity);
+  EXPECT_EQ(map.len(), 500u);
+
+  i64 sum = 0;
+  auto iter = map.iter();
+  for (auto pair = iter.next(); pair.is_some(); pair = iter.next()) {
+    sum += *move(pair).unwrap().get<1>();
+  }
+  EXPECT_EQ(sum, 500000);
+
+  map.shrink_to_fit();
+  EXPECT_LT(map.capacity(), capacity);
+  EXPECT_EQ(*map.get(999).unwrap(), 1998);
+  map.clear();
+  EXPECT_TRUE(map.is_empty());
+  map.shrink_to_fit();
+  EXPECT_EQ(map.capacity(), 0u);
+}
+
+GTEST_TEST(hash_map, entry) {
+  HashMap<String, i32> counts;
+  const char *words[] = {"a", "b", "a", "c", "a", "b"};
+  for (const char *word : words) {
+    Str key =
+        Str::from_utf8_unchecked(Slice<const u8>::from_raw_parts(
+            reinterpret_cast<const u8 *>(word), 1));
+    counts.entry(String::from(key)).or_insert(0) += 1;
+  }
+  EXPECT_EQ(counts.len(), 3u);
+  EXPECT_EQ(*counts.get(String::from(Str::from_static("a"))).unwrap(), 3);
+  EXPECT_EQ(*counts.get(String::from(Str::from_static("b"))).unwrap(), 2);
+
+  i32 &c = counts.entry(String::from(Str::from_static("c")))
+               .and_modify(bind_mut([](i32 &value) { value *= 10; }))
+               .or_insert(0);
+  EXPECT_EQ(c, 10);
+
+  auto vacant = counts.entry(String::from(Str::from_static("d")));
+  EXPECT_FALSE(vacant.is_occupied());
+  EXPECT_EQ(vacant.key().as_str(), Str::from_static("d"));
+  EXPECT_EQ(move(vacant).or_default(), 0);
+  EXPECT_EQ(
+      counts.entry(String::from(Str::from_static("d"))).remove(), make_some(0));
+  EXPECT_EQ(counts.len(), 3u);
+}
+
+GTEST_TEST(hash_map, traits) {
+  HashMap<i32, i32> squares =
+      range::Range<i32>{0, 100}
+          .zip(range::Range<i32>{100, 200})
+          .collect<HashMap<i32, i32>>();
+  EXPECT_EQ(squares.len(), 100u);
+  EXPECT_EQ(*squares.get(42).unwrap(), 142);
+  squares.retain(bind_mut([](const i32 &key, i32 &) { return key < 10; }));
+  EXPECT_EQ(squares.len(), 10u);
+  EXPECT_EQ(squares.iter().len(), 10u);
+
+  HashMap<i32, String> map;
+  for (i32 i = 0; i < 100; ++i) {
+    map.insert(i, key_of(i));
+  }
+  EXPECT_EQ(map.get(42).unwrap()->as_str(), Str::from_static("24"));
+
+  HashMap<i32, String> copy = map.clone();
+  EXPECT_TRUE(copy == map);
+  copy.get_mut(1).unwrap()->push(u'!');
+  EXPECT_TRUE(copy != map);
+
+  auto iter = copy.iter_mut();
+  for (auto pair = iter.next(); pair.is_some(); pair = iter.next()) {
+    move(pair).unwrap().get<1>()->clear();
+  }
+  EXPECT_TRUE(copy.get(42).unwrap()->is_empty());
+}
+
+GTEST_TEST(hash_map, raii) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  HashMap<i32, Checker> map;
+  for (i32 i = 0; i < 200; ++i) {
+    map.insert(i, Checker{recorder});
+  }
+  map.insert(3, Checker{recorder});
+  map.remove(4);
+  map.entry(5).or_insert(Checker{recorder});
+  map.entry(500).or_insert(Checker{recorder});
+  HashMap<i32, Checker> copy = map.clone();
+  map.clear();
+  EXPECT_EQ(copy.len(), 200u);
+}
+
+/// run with `--gtest_also_run_disabled_tests'.
+GTEST_TEST(hash_map, DISABLED_bench) {
+  HashMap<u64, u64> map;
+  std::unordered_map<u64, u64> std_map;
+
+  report("insert", "HashMap", seconds([&]() {
+           for (u64 i = 0; i < BENCH_KEYS; ++i) {
+             map.insert(bench_key(i), i);
+           }
+         }));
+  report("insert", "std::unordered_map", seconds([&]() {
+           for (u64 i = 0; i < BENCH_KEYS; ++i) {
+             std_map.emplace(bench_key(i), i);
+           }
+         }));
+
+  u64 sum = 0;
+  u64 std_sum = 0;
+  report("hit", "HashMap", seconds([&]() {
+           for (u64 i = 0; i < BENCH_KEYS; ++i) {
+             sum += *map.get(bench_key(i)).unwrap();
+           }
+         }));
+  report("hit", "std::unordered_map", seconds([&]() {
+           for (u64 i = 0; i < BENCH_KEYS; ++i) {
+             std_sum += std_map.find(bench_key(i))->second;
+           }
+         }));
+  EXPECT_EQ(sum, BENCH_KEYS * (BENCH_KEYS - 1) / 2);
+  EXPECT_EQ(std_sum, sum);
+
+  u64 found = 0;
+  report("miss", "HashMap", seconds([&]() {
+           for (u64 i = BENCH_KEYS; i < 2 * BENCH_KEYS; ++i) {
+             found += map.contains_key(bench_key(i));
+           }
+         }));
+  report("miss", "std::unordered_map", seconds([&]() {
+           for (u64 i = BENCH_KEYS; i < 2 * BENCH_KEYS; ++i) {
+             found += std_map.count(bench_key(i));
+           }
+         }));
+  EXPECT_EQ(found, 0u);
+}
@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+
+#include "crust/collections/hash_set.hpp"
+#include "crust/ops/range.hpp"
+#include "crust/str.hpp"
+#include "crust/string.hpp"
+#include "crust/utility.hpp"
+
+
+using namespace crust;
+using collections::HashSet;
+using ops::bind_mut;
+
+
+GTEST_TEST(hash_set, hash_set) {
+  HashSet<String> set;
+  EXPECT_TRUE(set.insert(String::from(Str::from_static("a"))));
+  EXPECT_TRUE(set.insert(String::from(Str::from_static("b"))));
+  EXPECT_FALSE(set.insert(String::from(Str::from_static("a"))));
+  EXPECT_EQ(set.len(), 2u);
+  EXPECT_TRUE(set.contains(String::from(Str::from_static("b"))));
+  EXPECT_TRUE(
+      set.replace(String::from(Str::from_static("b"))).is_some());
+
+  HashSet<String> copy = set.clone();
+  EXPECT_TRUE(copy == set);
+  EXPECT_TRUE(set.remove(String::from(Str::from_static("a"))));
+  EXPECT_FALSE(set.remove(String::from(Str::from_static("a"))));
+  EXPECT_TRUE(copy != set);
+  EXPECT_TRUE(set.is_subset(copy));
+  EXPECT_FALSE(copy.is_subset(set));
+
+  Option<String> taken = copy.take(String::from(Str::from_static("a")));
+  EXPECT_EQ(move(taken).unwrap().as_str(), Str::from_static("a"));
+  EXPECT_TRUE(copy == set);
+}
+
+GTEST_TEST(hash_set, traits) {
+  HashSet<i32> evens = range::Range<i32>{0, 50}.collect<HashSet<i32>>();
+  evens.retain(bind_mut([](const i32 &x) { return x % 2 == 0; }));
+  EXPECT_EQ(evens.len(), 25u);
+
+  HashSet<i32> odds = range::Range<i32>{0, 50}.collect<HashSet<i32>>();
+  odds.retain(bind_mut([](const i32 &x) { return x % 2 == 1; }));
+  EXPECT_TRUE(evens.is_disjoint(odds));
+  odds.insert(48);
+  EXPECT_FALSE(evens.is_disjoint(odds));
+
+  i32 sum = 0;
+  auto iter = evens.iter();
+  EXPECT_EQ(iter.len(), 25u);
+  for (auto x = iter.next(); x.is_some(); x = iter.next()) {
+    sum += *move(x).unwrap();
+  }
+  EXPECT_EQ(sum, 600);
+}
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+
+#include "crust/collections/hash_map.hpp"
+#include "crust/string.hpp"
+#include "crust/sync/interner.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+using namespace crust;
+using sync::Interner;
+using sync::Symbol;
+
+
+namespace {
+template <usize N>
+Str s(const char (&literal)[N]) {
+  return Str::from_static(literal);
+}
+
+String key(usize i) {
+  String ret = String::from(s("metric.field."));
+  for (; i != 0; i /= 10) {
+    ret.push(static_cast<u32>('0' + i % 10));
+  }
+  return ret;
+}
+} // namespace
+
+GTEST_TEST(interner, intern) {
+  Interner interner;
+  EXPECT_TRUE(interner.is_empty());
+  EXPECT_TRUE(interner.get(s("host")).is_none());
+
+  Symbol host = interner.intern(s("host"));
+  Symbol region = interner.intern(s("region"));
+  Symbol empty = interner.intern(s(""));
+  EXPECT_EQ(interner.len(), 3u);
+  EXPECT_TRUE(host != region);
+  EXPECT_TRUE(host < region);
+  EXPECT_TRUE(interner.intern(s("host")) == host);
+  EXPECT_TRUE(interner.get(s("region")) == make_some(region));
+  EXPECT_EQ(interner.len(), 3u);
+
+  String owned = String::from(s("host"));
+  EXPECT_TRUE(interner.intern(owned.as_str()) == host);
+  EXPECT_TRUE(interner.resolve(host) == s("host"));
+  EXPECT_NE(interner.resolve(host).as_ptr(), owned.as_str().as_ptr());
+  EXPECT_TRUE(interner.resolve(empty).is_empty());
+  EXPECT_EQ(region.as_u32(), 1u);
+
+  collections::HashMap<Symbol, i32> counts;
+  counts.insert(host, 1);
+  counts.insert(region, 2);
+  EXPECT_EQ(*counts.get(interner.intern(s("region"))).unwrap(), 2);
+}
+
+GTEST_TEST(interner, grow) {
+  Interner interner;
+  Vec<Symbol> symbols;
+  for (usize i = 0; i < 20000; ++i) {
+    symbols.push(interner.intern(key(i).as_str()));
+  }
+  EXPECT_EQ(interner.len(), 20000u);
+  for (usize i = 0; i < 20000; ++i) {
+    EXPECT_EQ(symbols[i].as_u32(), i);
+    EXPECT_TRUE(interner.get(key(i).as_str()) == make_some(symbols[i]));
+    EXPECT_TRUE(interner.resolve(symbols[i]) == key(i).as_str());
+  }
+}
+
+GTEST_TEST(interner, threads) {
+  Interner &interner = Interner::global();
+  usize before = interner.len();
+
+  Vec<Symbol> seen[4];
+  std::thread threads[4];
+  for (usize t = 0; t < 4; ++t) {
+    threads[t] = std::thread{[&interner, &seen, t] {
+      for (usize i = 0; i < 5000; ++i) {
+        seen[t].push(interner.intern(key((i * (t + 1)) % 5000).as_str()));
+      }
+    }};
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(interner.len() - before, 5000u);
+  for (usize t = 0; t < 4; ++t) {
+    for (usize i = 0; i < 5000; ++i) {
+      String expected = key((i * (t + 1)) % 5000);
+      EXPECT_TRUE(interner.resolve(seen[t][i]) == expected.as_str());
+      EXPECT_TRUE(seen[t][i] == interner.get(expected.as_str()).unwrap());
+    }
+  }
+}
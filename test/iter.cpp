@@ -1,8 +1,307 @@
 #include "gtest/gtest.h"
 
 #include "crust/iter/mod.hpp"
+#include "crust/ops/range.hpp"
+#include "crust/slice.hpp"
+#include "crust/utility.hpp"
 
 using namespace crust;
+using iter::DoubleEndedIterator;
+using iter::ExactSizeIterator;
+using iter::Iterator;
+using iter::TrustedLen;
+using ops::bind;
 
 
-GTEST_TEST(iter, iter) {}
+namespace {
+/// iterator with unknown length, only implements `next'.
+template <class T>
+struct Counter : Impl<Counter<T>, Trait<Iterator, T>> {
+  T count;
+  T limit;
+
+  Counter(T count, T limit) : count{count}, limit{limit} {}
+};
+
+template <class T>
+struct Collected : Impl<Collected<T>, Trait<iter::FromIterator, T>> {
+  T buffer[16];
+  usize size;
+  bool trusted;
+
+  Collected() : buffer{}, size{0}, trusted{false} {}
+};
+} // namespace
+
+namespace crust {
+template <class T>
+CRUST_IMPL_FOR(CRUST_MACRO(Iterator<Counter<T>, T>)) {
+  CRUST_IMPL_USE_SELF(Counter<T>);
+
+  Option<T> next() {
+    if (self().count >= self().limit) {
+      return None{};
+    }
+    return make_some(self().count++);
+  }
+};
+
+template <class T>
+CRUST_IMPL_FOR(CRUST_MACRO(iter::FromIterator<Collected<T>, T>)) {
+  CRUST_IMPL_USE_SELF(Collected<T>);
+
+  template <class I>
+  static Self from_iter(I &&iter) {
+    return from_iter_impl(
+        move(iter), BoolVal<Require<I, TrustedLen, T>::result>{});
+  }
+
+private:
+  template <class I>
+  static Self from_iter_impl(I &&iter, BoolVal<true>) {
+    Self result;
+    result.trusted = true;
+    for (usize n = iter.len(); n != 0; --n) {
+      result.buffer[result.size++] = iter.next_unchecked();
+    }
+    return result;
+  }
+
+  template <class I>
+  static Self from_iter_impl(I &&iter, BoolVal<false>) {
+    Self result;
+    iter.fold(0, bind([&](i32 &&, T &&value) {
+                result.buffer[result.size++] = value;
+                return 0;
+              }));
+    return result;
+  }
+};
+} // namespace crust
+
+
+GTEST_TEST(iter, traits) {
+  using SliceIter = slice::Iter<i32>;
+  using SliceIterMut = slice::IterMut<i32>;
+  using ZipIter = iter::Zip<SliceIter, SliceIterMut>;
+  using ZipItem = Tuple<Ref<i32>, RefMut<i32>>;
+
+  crust_static_assert(Require<SliceIter, Iterator, Ref<i32>>::result);
+  crust_static_assert(
+      Require<SliceIter, DoubleEndedIterator, Ref<i32>>::result);
+  crust_static_assert(Require<SliceIter, ExactSizeIterator, Ref<i32>>::result);
+  crust_static_assert(Require<SliceIter, TrustedLen, Ref<i32>>::result);
+  crust_static_assert(Require<SliceIterMut, TrustedLen, RefMut<i32>>::result);
+
+  crust_static_assert(Require<ZipIter, Iterator, ZipItem>::result);
+  crust_static_assert(Require<ZipIter, DoubleEndedIterator, ZipItem>::result);
+  crust_static_assert(Require<ZipIter, ExactSizeIterator, ZipItem>::result);
+  crust_static_assert(Require<ZipIter, TrustedLen, ZipItem>::result);
+
+  crust_static_assert(Require<Counter<i32>, Iterator, i32>::result);
+  crust_static_assert(!Require<Counter<i32>, DoubleEndedIterator, i32>::result);
+  crust_static_assert(!Require<Counter<i32>, TrustedLen, i32>::result);
+  crust_static_assert(!Require<
+                      iter::Zip<Counter<i32>, SliceIter>,
+                      TrustedLen,
+                      Tuple<i32, Ref<i32>>>::result);
+  crust_static_assert(!Require<
+                      iter::Enumerate<Counter<i32>>,
+                      TrustedLen,
+                      Tuple<usize, i32>>::result);
+  crust_static_assert(Require<
+                      iter::Enumerate<SliceIter>,
+                      TrustedLen,
+                      Tuple<usize, Ref<i32>>>::result);
+  crust_static_assert(
+      Require<iter::Rev<SliceIter>, TrustedLen, Ref<i32>>::result);
+}
+
+GTEST_TEST(iter, slice) {
+  i32 buffer[]{1, 2, 3, 4, 5};
+  auto slice = Slice<i32>::from_raw_parts(buffer, 5);
+
+  auto it = slice.iter();
+  EXPECT_EQ(it.len(), 5u);
+  EXPECT_EQ(*it.next().unwrap(), 1);
+  EXPECT_EQ(*it.next_back().unwrap(), 5);
+  EXPECT_EQ(it.len(), 3u);
+  EXPECT_EQ(
+      it.fold(0, bind([](i32 &&acc, Ref<i32> &&value) {
+        return acc + *value;
+      })),
+      9);
+  EXPECT_TRUE(it.next().is_none());
+  EXPECT_TRUE(it.is_empty());
+
+  auto rev = slice.iter().rev();
+  EXPECT_EQ(*rev.next().unwrap(), 5);
+  EXPECT_EQ(
+      rev.fold(0, bind([](i32 &&acc, Ref<i32> &&value) {
+                 return acc * 10 + *value;
+               })),
+      4321);
+
+  slice.iter_mut().fold(0, bind([](i32 &&acc, RefMut<i32> &&value) {
+    *value *= 2;
+    return acc;
+  }));
+  EXPECT_EQ(buffer[0], 2);
+  EXPECT_EQ(buffer[4], 10);
+}
+
+GTEST_TEST(iter, zip) {
+  i32 a[]{1, 2, 3, 4};
+  i32 b[]{10, 20, 30};
+  auto sa = Slice<i32>::from_raw_parts(a, 4);
+  auto sb = Slice<i32>::from_raw_parts(b, 3);
+
+  auto zip = sa.iter().zip(sb.iter());
+  EXPECT_EQ(zip.len(), 3u);
+  EXPECT_EQ(
+      zip.fold(0, bind([](i32 &&acc, Tuple<Ref<i32>, Ref<i32>> &&value) {
+                 return acc + *value.get<0>() * *value.get<1>();
+               })),
+      140);
+
+  auto back = sa.iter().zip(sb.iter());
+  auto last = back.next_back().unwrap();
+  EXPECT_EQ(*last.get<0>(), 3);
+  EXPECT_EQ(*last.get<1>(), 30);
+  EXPECT_EQ(back.len(), 2u);
+  EXPECT_EQ(*back.next().unwrap().get<1>(), 10);
+  EXPECT_EQ(*back.next_back().unwrap().get<0>(), 2);
+  EXPECT_TRUE(back.next_back().is_none());
+
+  auto rev = sa.iter().zip(sb.iter()).rev();
+  EXPECT_EQ(
+      rev.fold(0, bind([](i32 &&acc, Tuple<Ref<i32>, Ref<i32>> &&value) {
+                 return acc * 10 + *value.get<0>();
+               })),
+      321);
+
+  auto mixed = Counter<i32>{0, 10}.zip(sb.iter());
+  EXPECT_EQ(
+      mixed.fold(0, bind([](i32 &&acc, Tuple<i32, Ref<i32>> &&value) {
+                   return acc + value.get<0>() * *value.get<1>();
+                 })),
+      80);
+}
+
+GTEST_TEST(iter, enumerate) {
+  i32 a[]{5, 6, 7};
+  auto slice = Slice<i32>::from_raw_parts(a, 3);
+
+  auto it = slice.iter().enumerate();
+  auto first = it.next().unwrap();
+  EXPECT_EQ(first.get<0>(), 0u);
+  EXPECT_EQ(*first.get<1>(), 5);
+  auto last = it.next_back().unwrap();
+  EXPECT_EQ(last.get<0>(), 2u);
+  EXPECT_EQ(*last.get<1>(), 7);
+  auto middle = it.next().unwrap();
+  EXPECT_EQ(middle.get<0>(), 1u);
+  EXPECT_TRUE(it.next().is_none());
+
+  EXPECT_EQ(
+      slice.iter().enumerate().rev().fold(
+          0, bind([](i32 &&acc, Tuple<usize, Ref<i32>> &&value) {
+            return acc * 10 + static_cast<i32>(value.get<0>());
+          })),
+      210);
+
+  auto counter = Counter<i32>{3, 6}.enumerate();
+  EXPECT_EQ(
+      counter.fold(0, bind([](i32 &&acc, Tuple<usize, i32> &&value) {
+        return acc + static_cast<i32>(value.get<0>()) * value.get<1>();
+      })),
+      14);
+}
+
+GTEST_TEST(iter, collect) {
+  Collected<i32> counted = Counter<i32>{0, 4}.collect<Collected<i32>>();
+  EXPECT_FALSE(counted.trusted);
+  EXPECT_EQ(counted.size, 4u);
+  EXPECT_EQ(counted.buffer[3], 3);
+
+  auto ranged = range::Range<i32>{2, 7}.rev().collect<Collected<i32>>();
+  EXPECT_TRUE(ranged.trusted);
+  EXPECT_EQ(ranged.size, 5u);
+  EXPECT_EQ(ranged.buffer[0], 6);
+  EXPECT_EQ(ranged.buffer[4], 2);
+}
+
+GTEST_TEST(iter, next_chunk) {
+  i32 buffer[]{1, 2, 3, 4, 5};
+  auto slice = Slice<i32>::from_raw_parts(buffer, 5);
+
+  auto it = slice.iter();
+  auto chunk = it.next_chunk<2>();
+  EXPECT_TRUE(chunk.is_ok());
+  auto block = move(chunk).unwrap();
+  EXPECT_EQ(block.len(), 2u);
+  EXPECT_EQ(block.as_ptr(), buffer);
+  EXPECT_EQ(it.len(), 3u);
+  auto tail = it.next_chunk<4>().unwrap_err();
+  EXPECT_EQ(tail.len(), 3u);
+  EXPECT_EQ(tail[2], 5);
+  EXPECT_TRUE(it.is_empty());
+
+  auto counter = Counter<i32>{0, 5};
+  auto full = counter.next_chunk<3>().unwrap();
+  EXPECT_TRUE(full.is_full());
+  EXPECT_EQ(full[0], 0);
+  EXPECT_EQ(full[2], 2);
+  auto partial = counter.next_chunk<3>().unwrap_err();
+  EXPECT_EQ(partial.len(), 2u);
+  EXPECT_EQ(partial[1], 4);
+
+  auto range = range::Range<i32>{10, 13};
+  auto ranged = range.next_chunk<2>().unwrap();
+  EXPECT_EQ(ranged[0], 10);
+  EXPECT_EQ(ranged[1], 11);
+  EXPECT_EQ(range.next_chunk<2>().unwrap_err().len(), 1u);
+}
+
+GTEST_TEST(iter, chunked) {
+  i32 buffer[]{1, 2, 3, 4, 5, 6, 7};
+  auto slice = Slice<i32>::from_raw_parts(buffer, 7);
+
+  auto blocks = slice.iter().chunked<2>();
+  EXPECT_EQ(blocks.size_hint().get<0>(), 3u);
+  EXPECT_EQ(
+      blocks.fold(0, bind([](i32 &&acc, Slice<const i32> &&block) {
+        return acc * 10 + block[0] * block[1];
+      })),
+      2 * 100 + 12 * 10 + 30);
+  auto rest = blocks.remainder().unwrap();
+  EXPECT_EQ(rest.len(), 1u);
+  EXPECT_EQ(rest[0], 7);
+
+  slice.iter_mut().chunked<3>().fold(0, bind([](i32 &&acc, Slice<i32> &&block) {
+    block[0] = 0;
+    return acc;
+  }));
+  EXPECT_EQ(buffer[0], 0);
+  EXPECT_EQ(buffer[3], 0);
+  EXPECT_EQ(buffer[6], 7);
+
+  auto counted = Counter<i32>{0, 7}.chunked<3>();
+  auto first = counted.next().unwrap();
+  EXPECT_EQ(first[2], 2);
+  EXPECT_EQ(
+      counted.fold(0, bind([](i32 &&acc, iter::ArrayChunk<i32, 3> &&block) {
+        return acc + block[0] + block[1] + block[2];
+      })),
+      12);
+  EXPECT_EQ(counted.remainder().unwrap().len(), 1u);
+
+  // running past the end keeps the remainder of the first failed chunk.
+  auto drained = slice.iter().chunked<2>();
+  while (drained.next().is_some()) {
+  }
+  EXPECT_TRUE(drained.next().is_none());
+  auto kept = drained.remainder().unwrap();
+  EXPECT_EQ(kept.len(), 1u);
+  EXPECT_EQ(kept[0], 7);
+}
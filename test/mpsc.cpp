@@ -0,0 +1,246 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "crust/sync/mpsc.hpp"
+#include "crust/utility.hpp"
+
+#include "raii_checker.hpp"
+
+
+using namespace crust;
+using namespace sync::mpsc;
+
+
+namespace {
+struct Tracked : test::RAIIChecker<Tracked> {
+  CRUST_USE_BASE_CONSTRUCTORS(Tracked, test::RAIIChecker<Tracked>);
+};
+
+void settle() { std::this_thread::sleep_for(std::chrono::milliseconds{20}); }
+
+/// `producers' threads each send `count' values tagged with their index,
+/// the receiver checks that every producer's values arrive in order.
+template <class Tx, class Rx>
+void check_ordered(Tx &tx, Rx &rx, usize producers, u64 count) {
+  std::thread threads[8];
+  for (usize p = 0; p < producers; ++p) {
+    Tx local = tx.clone();
+    threads[p] = std::thread{[p, count](Tx &&tx) {
+                               for (u64 i = 0; i < count; ++i) {
+                                 crust_assert(tx.send(p << 32 | i).is_ok());
+                               }
+                             },
+                             move(local)};
+  }
+  { Tx dropped = move(tx); }
+
+  u64 next[8] = {};
+  for (auto x = rx.recv(); x.is_ok(); x = rx.recv()) {
+    u64 value = move(x).unwrap();
+    usize p = static_cast<usize>(value >> 32);
+    EXPECT_EQ(value & 0xFFFFFFFF, next[p]);
+    ++next[p];
+  }
+  for (usize p = 0; p < producers; ++p) {
+    threads[p].join();
+    EXPECT_EQ(next[p], count);
+  }
+}
+
+template <class Tx, class Rx>
+void bench(const char *name, usize producers, Tuple<Tx, Rx> pair) {
+  constexpr u64 COUNT = 4000000;
+  auto start = std::chrono::steady_clock::now();
+  std::thread threads[4];
+  for (usize p = 0; p < producers; ++p) {
+    Tx local = pair.template get<0>().clone();
+    threads[p] = std::thread{[producers](Tx &&tx) {
+                               for (u64 i = 0; i < COUNT / producers; ++i) {
+                                 tx.send(i);
+                               }
+                             },
+                             move(local)};
+  }
+  { Tx dropped = move(pair.template get<0>()); }
+  u64 received = 0;
+  while (pair.template get<1>().recv().is_ok()) {
+    ++received;
+  }
+  for (usize p = 0; p < producers; ++p) {
+    threads[p].join();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::printf(
+      "%s producers %zu: %6.2f M msgs/s\n",
+      name,
+      static_cast<size_t>(producers),
+      received / elapsed.count() / 1e6);
+}
+} // namespace
+
+GTEST_TEST(mpsc, channel) {
+  auto pair = channel<i32>();
+  Sender<i32> tx = move(pair.get<0>());
+  Receiver<i32> rx = move(pair.get<1>());
+
+  EXPECT_EQ(rx.try_recv(), Ok<Option<i32>>{None{}});
+  for (i32 i = 0; i < 100; ++i) {
+    EXPECT_TRUE(tx.send(i).is_ok());
+  }
+  EXPECT_EQ(rx.try_recv(), Ok<Option<i32>>{make_some(0)});
+  for (i32 i = 1; i < 100; ++i) {
+    EXPECT_EQ(rx.recv(), Ok<i32>{i});
+  }
+
+  Sender<i32> other = tx.clone();
+  { Sender<i32> dropped = move(tx); }
+  EXPECT_TRUE(other.send(7).is_ok());
+  { Sender<i32> dropped = move(other); }
+  EXPECT_EQ(rx.recv(), Ok<i32>{7});
+  EXPECT_EQ(rx.recv(), Err<RecvError>{RecvError{}});
+  EXPECT_EQ(rx.try_recv(), Err<RecvError>{RecvError{}});
+
+  auto closed = channel<i32>();
+  { Receiver<i32> dropped = move(closed.get<1>()); }
+  EXPECT_EQ(closed.get<0>().send(3).unwrap_err().into_inner(), 3);
+}
+
+GTEST_TEST(mpsc, channel_threads) {
+  auto pair = channel<u64>();
+  check_ordered(pair.get<0>(), pair.get<1>(), 4, 50000);
+}
+
+GTEST_TEST(mpsc, sync_channel) {
+  auto pair = sync_channel<i32>(3);
+  SyncSender<i32> tx = move(pair.get<0>());
+  SyncReceiver<i32> rx = move(pair.get<1>());
+
+  for (i32 round = 0; round < 5; ++round) {
+    for (i32 i = 0; i < 3; ++i) {
+      EXPECT_TRUE(tx.send(round * 3 + i).is_ok());
+    }
+    for (i32 i = 0; i < 3; ++i) {
+      EXPECT_EQ(rx.try_recv(), Ok<Option<i32>>{make_some(round * 3 + i)});
+    }
+    EXPECT_EQ(rx.try_recv(), Ok<Option<i32>>{None{}});
+  }
+
+  // a full channel blocks the sender until a value is taken.
+  for (i32 i = 0; i < 3; ++i) {
+    tx.send(i);
+  }
+  std::atomic<bool> sent{false};
+  std::thread sender{[&]() {
+    tx.send(3);
+    sent = true;
+  }};
+  settle();
+  EXPECT_FALSE(sent.load());
+  EXPECT_EQ(rx.recv(), Ok<i32>{0});
+  sender.join();
+  EXPECT_TRUE(sent.load());
+
+  SyncReceiver<i32> other = rx.clone();
+  { SyncReceiver<i32> dropped = move(rx); }
+  for (i32 i = 1; i < 4; ++i) {
+    EXPECT_EQ(other.recv(), Ok<i32>{i});
+  }
+  { SyncReceiver<i32> dropped = move(other); }
+  EXPECT_EQ(tx.send(9).unwrap_err().into_inner(), 9);
+}
+
+GTEST_TEST(mpsc, sync_channel_threads) {
+  auto pair = sync_channel<u64>(16);
+  check_ordered(pair.get<0>(), pair.get<1>(), 4, 50000);
+
+  // several receivers share the values.
+  auto shared = sync_channel<u64>(8);
+  SyncSender<u64> tx = move(shared.get<0>());
+  SyncReceiver<u64> rx = move(shared.get<1>());
+  std::atomic<u64> total{0};
+  std::thread consumers[3];
+  for (auto &consumer : consumers) {
+    SyncReceiver<u64> local = rx.clone();
+    consumer = std::thread{[&total](SyncReceiver<u64> &&rx) {
+                             u64 sum = 0;
+                             auto x = rx.recv();
+                             for (; x.is_ok(); x = rx.recv()) {
+                               sum += move(x).unwrap();
+                             }
+                             total += sum;
+                           },
+                           move(local)};
+  }
+  { SyncReceiver<u64> dropped = move(rx); }
+  for (u64 i = 1; i <= 100000; ++i) {
+    tx.send(i);
+  }
+  { SyncSender<u64> dropped = move(tx); }
+  for (auto &consumer : consumers) {
+    consumer.join();
+  }
+  EXPECT_EQ(total.load(), 5000050000u);
+}
+
+GTEST_TEST(mpsc, blocking) {
+  auto pair = channel<i32>();
+  Sender<i32> tx = move(pair.get<0>());
+  Receiver<i32> rx = move(pair.get<1>());
+
+  // a parked receiver wakes up for a value and for the disconnect.
+  Result<i32, RecvError> first = Err<RecvError>{RecvError{}};
+  Result<i32, RecvError> second = Ok<i32>{0};
+  std::thread receiver{[&]() {
+    first = rx.recv();
+    second = rx.recv();
+  }};
+  settle();
+  tx.send(5);
+  settle();
+  { Sender<i32> dropped = move(tx); }
+  receiver.join();
+  EXPECT_EQ(first, Ok<i32>{5});
+  EXPECT_EQ(second, Err<RecvError>{RecvError{}});
+
+  // a sender parked on a full channel wakes up for the disconnect.
+  auto bounded = sync_channel<i32>(1);
+  bounded.get<0>().send(1);
+  bool failed = false;
+  std::thread sender{
+      [&]() { failed = bounded.get<0>().send(2).is_err(); }};
+  settle();
+  { SyncReceiver<i32> dropped = move(bounded.get<1>()); }
+  sender.join();
+  EXPECT_TRUE(failed);
+}
+
+GTEST_TEST(mpsc, raii) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  auto pair = channel<Tracked>();
+  for (i32 i = 0; i < 100; ++i) {
+    pair.get<0>().send(Tracked{recorder});
+  }
+  for (i32 i = 0; i < 40; ++i) {
+    pair.get<1>().recv();
+  }
+
+  auto bounded = sync_channel<Tracked>(5);
+  for (i32 i = 0; i < 5; ++i) {
+    bounded.get<0>().send(Tracked{recorder});
+  }
+  bounded.get<1>().recv();
+}
+
+/// run with `--gtest_also_run_disabled_tests'.
+GTEST_TEST(mpsc, DISABLED_bench) {
+  for (usize producers : {1, 4}) {
+    bench("channel", producers, channel<u64>());
+    bench("sync_channel(1024)", producers, sync_channel<u64>(1024));
+  }
+}
@@ -4,6 +4,8 @@
 #include "crust/option.hpp"
 #include "crust/utility.hpp"
 
+#include "alloc_checker.hpp"
+
 
 using namespace crust;
 using ops::bind;
@@ -28,3 +30,14 @@ GTEST_TEST(option, option) {
            .map(bind([](const i32 &value) { return &value; }))
            .unwrap_or(0) == 1234);
 }
+
+GTEST_TEST(option, no_alloc) {
+  i32 offset = 3;
+  Option<i32> result;
+  CRUST_EXPECT_NO_ALLOC({
+    result = make_some(1)
+                 .map(bind([&](const i32 &value) { return value + offset; }))
+                 .map(bind([](const i32 &value) { return value * 2; }));
+  });
+  EXPECT_EQ(result, make_some(8));
+}
@@ -2,9 +2,9 @@
 #define CRUST_TEST_RAII_CHECKER_HPP
 
 
-#include <memory>
 #include <unordered_map>
 
+#include "crust/rc.hpp"
 #include "crust/utility.hpp"
 
 
@@ -17,17 +17,18 @@ private:
     const RAIITypeInfo *type_info;
   };
 
-  std::unordered_map<void *, Record> record;
+  /// shared behind an `Rc', which only hands out const access.
+  mutable std::unordered_map<void *, Record> record;
 
 public:
   RAIIRecorder() : record{} {}
 
-  void construct(const RAIITypeInfo *type_info, void *self) {
+  void construct(const RAIITypeInfo *type_info, void *self) const {
     crust_assert(record.find(self) == record.end());
     record.emplace(self, Record{type_info});
   }
 
-  void deconstruct(const RAIITypeInfo *type_info, void *self) {
+  void deconstruct(const RAIITypeInfo *type_info, void *self) const {
     auto ptr = record.find(self);
     crust_assert(ptr != record.end() && ptr->second.type_info == type_info);
     record.erase(ptr);
@@ -41,29 +42,30 @@ struct RAIIChecker {
 private:
   static const RAIITypeInfo TYPE_INFO;
 
-  std::shared_ptr<RAIIRecorder> recorder;
+  crust::rc::Rc<RAIIRecorder> recorder;
 
 public:
-  explicit RAIIChecker(std::shared_ptr<RAIIRecorder> recorder) :
-      recorder{std::move(recorder)} {
+  explicit RAIIChecker(const crust::rc::Rc<RAIIRecorder> &recorder) :
+      recorder{recorder.clone()} {
     this->recorder->construct(&TYPE_INFO, this);
   }
 
-  RAIIChecker(const RAIIChecker &other) : recorder{other.recorder} {
+  RAIIChecker(const RAIIChecker &other) : recorder{other.recorder.clone()} {
     this->recorder->construct(&TYPE_INFO, this);
   }
 
-  RAIIChecker(RAIIChecker &&other) noexcept : recorder{other.recorder} {
+  RAIIChecker(RAIIChecker &&other) noexcept :
+      recorder{other.recorder.clone()} {
     this->recorder->construct(&TYPE_INFO, this);
   }
 
   RAIIChecker &operator=(const RAIIChecker &other) {
-    crust_assert(recorder == other.recorder);
+    crust_assert(recorder.ptr_eq(other.recorder));
     return *this;
   }
 
   RAIIChecker &operator=(RAIIChecker &&other) noexcept {
-    crust_assert(recorder == other.recorder);
+    crust_assert(recorder.ptr_eq(other.recorder));
     return *this;
   }
 
@@ -1,8 +1,34 @@
 #include "gtest/gtest.h"
 
+#include "crust/num/mod.hpp"
 #include "crust/ops/range.hpp"
 
 using namespace crust;
+using ops::bind;
 
 
-GTEST_TEST(range, range) {}
+GTEST_TEST(range, range) {
+  crust_static_assert(
+      Require<range::Range<i32>, iter::TrustedLen, i32>::result);
+  crust_static_assert(
+      !Require<range::Range<const char *>, iter::Iterator, const char *>::
+          result);
+
+  range::Range<i32> range{0, 4};
+  EXPECT_EQ(range.len(), 4u);
+  EXPECT_EQ(range.next(), make_some(0));
+  EXPECT_EQ(range.next_back(), make_some(3));
+  EXPECT_EQ(range.len(), 2u);
+  EXPECT_EQ(
+      range.fold(0, bind([](i32 &&acc, i32 &&value) { return acc + value; })),
+      3);
+  EXPECT_TRUE(range.next().is_none());
+  EXPECT_TRUE(range.next_back().is_none());
+
+  range::Range<i32> empty{5, 2};
+  EXPECT_EQ(empty.len(), 0u);
+  EXPECT_TRUE(empty.next().is_none());
+
+  range::Range<i32> wide{num::Int<i32>::MIN, num::Int<i32>::MAX};
+  EXPECT_EQ(wide.len(), 0xFFFFFFFFu);
+}
@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+
+#include "crust/rc.hpp"
+#include "crust/string.hpp"
+#include "crust/sync/arc.hpp"
+#include "crust/utility.hpp"
+
+#include "raii_checker.hpp"
+
+
+using namespace crust;
+using rc::Rc;
+using sync::Arc;
+
+
+namespace {
+struct Checker : test::RAIIChecker<Checker> {
+  CRUST_USE_BASE_CONSTRUCTORS(Checker, test::RAIIChecker<Checker>);
+};
+} // namespace
+
+GTEST_TEST(rc, rc) {
+  Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  crust_static_assert(sizeof(Rc<i32>) == sizeof(void *));
+
+  Rc<Checker> a{Checker{recorder}};
+  EXPECT_EQ(recorder.strong_count(), 2u);
+  Rc<Checker> b = a.clone();
+  EXPECT_TRUE(a.ptr_eq(b));
+  EXPECT_EQ(a.strong_count(), 2u);
+  EXPECT_TRUE(a.get_mut().is_none());
+
+  rc::Weak<Checker> weak = a.downgrade();
+  EXPECT_EQ(a.weak_count(), 1u);
+  b = Rc<Checker>{Checker{recorder}};
+  EXPECT_TRUE(a.get_mut().is_none());
+  EXPECT_TRUE(weak.upgrade().unwrap().ptr_eq(a));
+
+  a = Rc<Checker>{Checker{recorder}};
+  EXPECT_EQ(weak.strong_count(), 0u);
+  EXPECT_TRUE(weak.upgrade().is_none());
+  EXPECT_TRUE(a.get_mut().is_some());
+  EXPECT_TRUE(rc::Weak<Checker>{}.upgrade().is_none());
+
+  Rc<i32> x{1};
+  Rc<i32> y{2};
+  EXPECT_TRUE(x < y);
+  EXPECT_EQ(move(x).try_unwrap().unwrap(), 1);
+  Rc<i32> z = y.clone();
+  EXPECT_TRUE(move(y).try_unwrap().unwrap_err().ptr_eq(z));
+}
+
+GTEST_TEST(rc, make_mut) {
+  Rc<String> a{String::from(Str::from_static("shared"))};
+  Rc<String> b = a.clone();
+  a.make_mut().push_str(Str::from_static(" copy"));
+  EXPECT_EQ(a->as_str(), Str::from_static("shared copy"));
+  EXPECT_EQ(b->as_str(), Str::from_static("shared"));
+
+  const String *before = a.as_ptr();
+  a.make_mut().push(u'!');
+  EXPECT_EQ(a.as_ptr(), before);
+
+  rc::Weak<String> weak = a.downgrade();
+  a.make_mut().clear();
+  EXPECT_NE(a.as_ptr(), before);
+  EXPECT_TRUE(weak.upgrade().is_none());
+  EXPECT_TRUE(a->is_empty());
+
+  Rc<i32> x{1};
+  Rc<i32> y = x.clone();
+  x.make_mut() += 1;
+  EXPECT_EQ(*x, 2);
+  EXPECT_EQ(*y, 1);
+  EXPECT_FALSE(x.ptr_eq(y));
+}
+
+GTEST_TEST(rc, arc) {
+  Arc<i32> shared{7};
+  sync::Weak<i32> weak = shared.downgrade();
+
+  std::thread threads[4];
+  for (auto &thread : threads) {
+    Arc<i32> local = shared.clone();
+    thread = std::thread{[](Arc<i32> &&value) {
+                           for (i32 i = 0; i < 1000; ++i) {
+                             Arc<i32> copy = value.clone();
+                             crust_assert(*copy == 7);
+                           }
+                         },
+                         move(local)};
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(shared.strong_count(), 1u);
+  EXPECT_TRUE(shared.get_mut().is_none());
+  weak = sync::Weak<i32>{};
+  EXPECT_TRUE(shared.get_mut().is_some());
+  *shared.get_mut().unwrap() = 8;
+  EXPECT_EQ(*shared, 8);
+}
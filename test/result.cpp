@@ -5,4 +5,25 @@
 using namespace crust;
 
 
-GTEST_TEST(result, result) {}
+namespace {
+Result<i32, char> make_ok(i32 value) { return Ok<i32>{value}; }
+
+Result<i32, char> make_err(char value) { return Err<char>{value}; }
+} // namespace
+
+
+GTEST_TEST(result, result) {
+  EXPECT_TRUE(make_ok(1).is_ok());
+  EXPECT_FALSE(make_ok(1).is_err());
+  EXPECT_TRUE(make_err('e').is_err());
+  EXPECT_TRUE(make_ok(1).contains(1));
+  EXPECT_TRUE(make_err('e').contains_err('e'));
+
+  EXPECT_EQ(make_ok(2).ok(), make_some(2));
+  EXPECT_TRUE(make_ok(2).err().is_none());
+  EXPECT_EQ(make_err('e').err(), make_some('e'));
+  EXPECT_TRUE(make_err('e').ok().is_none());
+
+  EXPECT_EQ(make_ok(3).unwrap(), 3);
+  EXPECT_EQ(make_err('f').unwrap_err(), 'f');
+}
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include "crust/collections/hash_set.hpp"
+#include "crust/collections/slab.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+#include "raii_checker.hpp"
+
+
+using namespace crust;
+using collections::Slab;
+
+
+namespace {
+struct Tracked : test::RAIIChecker<Tracked> {
+  CRUST_USE_BASE_CONSTRUCTORS(Tracked, test::RAIIChecker<Tracked>);
+};
+} // namespace
+
+GTEST_TEST(slab, insert_remove) {
+  Slab<i32> slab;
+  EXPECT_TRUE(slab.is_empty());
+
+  slab::Handle a = slab.insert(1);
+  slab::Handle b = slab.insert(2);
+  EXPECT_EQ(slab.len(), 2u);
+  EXPECT_EQ(slab.capacity(), 64u);
+  EXPECT_EQ(*slab.get(a).unwrap(), 1);
+  const i32 *stable = &*slab.get(b).unwrap();
+
+  *slab.get_mut(a).unwrap() = 10;
+  EXPECT_EQ(slab.remove(a), make_some(10));
+  EXPECT_TRUE(slab.remove(a).is_none());
+  EXPECT_TRUE(slab.get(a).is_none());
+  EXPECT_FALSE(slab.contains(a));
+
+  // the freed slot is reused, the old handle stays stale.
+  slab::Handle c = slab.insert(3);
+  EXPECT_EQ(c.slot(), a.slot());
+  EXPECT_TRUE(c != a);
+  EXPECT_TRUE(slab.get(a).is_none());
+  EXPECT_EQ(*slab.get(c).unwrap(), 3);
+
+  for (i32 i = 0; i < 1000; ++i) {
+    slab.insert(i);
+  }
+  EXPECT_EQ(slab.len(), 1002u);
+  EXPECT_EQ(&*slab.get(b).unwrap(), stable);
+
+  slab.clear();
+  EXPECT_TRUE(slab.is_empty());
+  EXPECT_TRUE(slab.get(b).is_none());
+  EXPECT_EQ(slab.insert(4).slot(), 0u);
+}
+
+GTEST_TEST(slab, iter) {
+  Slab<i32> slab = Slab<i32>::with_capacity(100);
+  EXPECT_EQ(slab.capacity(), 128u);
+
+  Vec<slab::Handle> handles;
+  for (i32 i = 0; i < 200; ++i) {
+    handles.push(slab.insert(i));
+  }
+  for (usize i = 0; i < 200; i += 3) {
+    slab.remove(handles[i]);
+  }
+
+  collections::HashSet<slab::Handle> seen;
+  i32 expected = 1;
+  auto iter = slab.iter();
+  for (auto x = iter.next(); x.is_some(); x = iter.next()) {
+    auto entry = move(x).unwrap();
+    EXPECT_EQ(*entry.get<1>(), expected);
+    EXPECT_TRUE(entry.get<0>() == handles[static_cast<usize>(expected)]);
+    EXPECT_TRUE(seen.insert(entry.get<0>()));
+    expected += expected % 3 == 1 ? 1 : 2;
+  }
+  EXPECT_EQ(seen.len(), slab.len());
+  EXPECT_EQ(seen.len(), 133u);
+}
+
+GTEST_TEST(slab, raii) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  Slab<Tracked> slab;
+  Vec<slab::Handle> handles;
+  for (i32 i = 0; i < 100; ++i) {
+    handles.push(slab.insert(Tracked{recorder}));
+  }
+  slab.remove(handles[5]);
+  slab.insert(Tracked{recorder});
+
+  Slab<Tracked> other = move(slab);
+  other.remove(handles[7]);
+  slab = move(other);
+  slab.clear();
+  slab.insert(Tracked{recorder});
+}
@@ -0,0 +1,163 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "crust/ops/range.hpp"
+#include "crust/small_vec.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+#include "alloc_checker.hpp"
+#include "raii_checker.hpp"
+
+
+using namespace crust;
+using ops::bind_mut;
+
+
+namespace {
+struct Tracked : test::RAIIChecker<Tracked> {
+  CRUST_USE_BASE_CONSTRUCTORS(Tracked, test::RAIIChecker<Tracked>);
+};
+
+/// builds `lists' lists of `len' elements one after another, summing them.
+template <class List>
+double build_lists(usize lists, u64 len, u64 &sum) {
+  auto start = std::chrono::steady_clock::now();
+  for (usize i = 0; i < lists; ++i) {
+    List list;
+    for (u64 j = 0; j < len; ++j) {
+      list.push(i + j);
+    }
+    for (usize j = 0; j < list.len(); ++j) {
+      sum += list[j];
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+} // namespace
+
+GTEST_TEST(small_vec, inline_and_spill) {
+  crust_static_assert(
+      sizeof(SmallVec<u64, 4>) == 4 * sizeof(u64) + sizeof(usize));
+
+  SmallVec<i32, 4> vec;
+  CRUST_EXPECT_NO_ALLOC({
+    for (i32 i = 0; i < 4; ++i) {
+      vec.push(i);
+    }
+  });
+  EXPECT_FALSE(vec.spilled());
+  EXPECT_EQ(vec.capacity(), 4u);
+
+  vec.push(4);
+  EXPECT_TRUE(vec.spilled());
+  EXPECT_EQ(vec.len(), 5u);
+  for (i32 i = 0; i < 5; ++i) {
+    EXPECT_EQ(vec[static_cast<usize>(i)], i);
+  }
+
+  EXPECT_EQ(vec.pop(), make_some(4));
+  vec.shrink_to_fit();
+  EXPECT_FALSE(vec.spilled());
+  EXPECT_EQ(vec.as_slice().len(), 4u);
+  EXPECT_EQ(*vec.last().unwrap(), 3);
+
+  vec.insert(1, 10);
+  EXPECT_EQ(vec.remove(0), 0);
+  EXPECT_EQ(vec.swap_remove(0), 10);
+  EXPECT_EQ(vec[0], 3);
+
+  // a list that never outgrows its inline buffer never touches the heap.
+  CRUST_EXPECT_NO_ALLOC({
+    SmallVec<u64, 8> list;
+    for (u64 i = 0; i < 8; ++i) {
+      list.push(i);
+    }
+    list.insert(0, list.pop().unwrap());
+    list.remove(3);
+    SmallVec<u64, 8> moved{move(list)};
+    moved.clone_from(moved.clone());
+  });
+}
+
+GTEST_TEST(small_vec, traits) {
+  SmallVec<i32, 2> a = range::Range<i32>{0, 5}.collect<SmallVec<i32, 2>>();
+  SmallVec<i32, 2> b = a.clone();
+  EXPECT_EQ(a, b);
+
+  b.retain(bind_mut([](const i32 &value) { return value != 4; }));
+  EXPECT_TRUE(b < a);
+
+  SmallVec<i32, 2> moved{move(a)};
+  EXPECT_TRUE(a.is_empty());
+  EXPECT_EQ(moved.len(), 5u);
+
+  i32 buffer[] = {1, 1, 2, 2};
+  SmallVec<i32, 8> dup;
+  dup.extend_from_slice(Slice<i32>::from_raw_parts(buffer, 4));
+  dup.dedup();
+  EXPECT_EQ(dup.len(), 2u);
+}
+
+GTEST_TEST(small_vec, clone_nested) {
+  SmallVec<Vec<i32>, 2> nested;
+  for (i32 i = 0; i < 3; ++i) {
+    nested.push(range::Range<i32>{0, i}.collect<Vec<i32>>());
+  }
+  SmallVec<Vec<i32>, 2> copy = nested.clone();
+  EXPECT_EQ(copy, nested);
+  copy.clone_from(nested);
+  EXPECT_EQ(copy, nested);
+
+  // spilling out of the inline buffer while copying from it.
+  SmallVec<Vec<i32>, 4> grow;
+  grow.push(range::Range<i32>{0, 3}.collect<Vec<i32>>());
+  grow.push(Vec<i32>{});
+  grow.push(Vec<i32>{});
+  grow.extend_from_slice(grow.as_slice());
+  EXPECT_TRUE(grow.spilled());
+  EXPECT_EQ(grow.len(), 6u);
+  EXPECT_EQ(grow[3], grow[0]);
+}
+
+GTEST_TEST(small_vec, raii) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  SmallVec<Tracked, 3> vec;
+  for (i32 i = 0; i < 3; ++i) {
+    vec.push(Tracked{recorder});
+  }
+  SmallVec<Tracked, 3> inline_{move(vec)};
+
+  for (i32 i = 0; i < 6; ++i) {
+    vec.push(Tracked{recorder});
+  }
+  vec.remove(2);
+  vec.truncate(2);
+  vec.shrink_to_fit();
+  EXPECT_FALSE(vec.spilled());
+
+  inline_ = move(vec);
+  inline_.pop();
+}
+
+/// run with `--gtest_also_run_disabled_tests'.
+GTEST_TEST(small_vec, DISABLED_bench) {
+  constexpr usize LISTS = usize{1} << 20;
+  for (u64 len : {1, 2, 4, 8, 16}) {
+    u64 sum = 0;
+    u64 vec_sum = 0;
+    double small = build_lists<SmallVec<u64, 8>>(LISTS, len, sum);
+    double vec = build_lists<Vec<u64>>(LISTS, len, vec_sum);
+    EXPECT_EQ(sum, vec_sum);
+    std::printf(
+        "len %2zu: SmallVec<u64, 8> %6.2f ns/list, Vec<u64> %6.2f ns/list\n",
+        static_cast<size_t>(len),
+        small / LISTS * 1e9,
+        vec / LISTS * 1e9);
+  }
+}
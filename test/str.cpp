@@ -0,0 +1,171 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "crust/str.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+using namespace crust;
+
+
+namespace {
+Str s(const char *literal) {
+  return Str::from_utf8_unchecked(Slice<const u8>::from_raw_parts(
+      reinterpret_cast<const u8 *>(literal), std::strlen(literal)));
+}
+
+Result<Str, str::Utf8Error> validate(const char *bytes, usize len) {
+  return Str::from_utf8(Slice<const u8>::from_raw_parts(
+      reinterpret_cast<const u8 *>(bytes), len));
+}
+
+usize valid_up_to(const char *bytes, usize len) {
+  return validate(bytes, len).unwrap_err().valid_up_to();
+}
+
+Option<usize> error_len(const char *bytes, usize len) {
+  return validate(bytes, len).unwrap_err().error_len();
+}
+
+/// `pattern' repeated to about `len' bytes, ending with `needle'.
+Vec<u8> bench_text(const char *pattern, const char *needle, usize len) {
+  Vec<u8> ret = Vec<u8>::with_capacity(len);
+  usize pattern_len = std::strlen(pattern);
+  while (ret.len() + pattern_len <= len) {
+    ret.extend_from_slice(Slice<const u8>::from_raw_parts(
+        reinterpret_cast<const u8 *>(pattern), pattern_len));
+  }
+  ret.extend_from_slice(Slice<const u8>::from_raw_parts(
+      reinterpret_cast<const u8 *>(needle), std::strlen(needle)));
+  return ret;
+}
+
+template <class F>
+void bench_bytes(const char *op, const char *text, usize len, F &&f) {
+  constexpr i32 ROUNDS = 20;
+  auto start = std::chrono::steady_clock::now();
+  for (i32 i = 0; i < ROUNDS; ++i) {
+    f();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::printf(
+      "%-9s %-5s %6.2f GB/s\n",
+      op,
+      text,
+      len * ROUNDS / elapsed.count() / 1e9);
+}
+} // namespace
+
+GTEST_TEST(str, from_utf8) {
+  EXPECT_TRUE(validate("", 0).is_ok());
+  const char ascii[] = "plain ascii text, long enough for a block";
+  EXPECT_TRUE(validate(ascii, sizeof(ascii) - 1).is_ok());
+  const char multibyte[] = "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80";
+  EXPECT_TRUE(validate(multibyte, sizeof(multibyte) - 1).is_ok());
+
+  const char overlong[] = "0123456789abcdef0123\xc0\xaf";
+  EXPECT_EQ(valid_up_to(overlong, 22), 20u);
+  EXPECT_EQ(error_len(overlong, 22), make_some<usize>(1));
+
+  const char surrogate[] = "ab\xed\xa0\x80";
+  EXPECT_EQ(valid_up_to(surrogate, 5), 2u);
+  EXPECT_EQ(error_len(surrogate, 5), make_some<usize>(1));
+
+  const char bad_tail[] = "\xe2\x82x";
+  EXPECT_EQ(error_len(bad_tail, 3), make_some<usize>(2));
+
+  const char truncated[] = "ok\xf0\x9f\x98";
+  EXPECT_EQ(valid_up_to(truncated, 5), 2u);
+  EXPECT_TRUE(error_len(truncated, 5).is_none());
+
+  const char too_large[] = "\xf4\x90\x80\x80";
+  EXPECT_EQ(error_len(too_large, 4), make_some<usize>(1));
+}
+
+GTEST_TEST(str, search) {
+  Str text = s("the quick brown fox jumps over the lazy dog");
+  EXPECT_EQ(text.find(s("the")), make_some<usize>(0));
+  EXPECT_EQ(text.find(s("lazy")), make_some<usize>(35));
+  EXPECT_TRUE(text.find(s("cat")).is_none());
+  EXPECT_EQ(text.find(s("")), make_some<usize>(0));
+  EXPECT_EQ(text.find_byte('q'), make_some<usize>(4));
+  EXPECT_TRUE(text.contains(s("fox")));
+  EXPECT_TRUE(text.starts_with(s("the ")));
+  EXPECT_TRUE(text.ends_with(s(" dog")));
+  EXPECT_FALSE(text.ends_with(s("cat")));
+
+  Str accented = s("caf\xc3\xa9");
+  EXPECT_TRUE(accented.get(0, 3).is_some());
+  EXPECT_TRUE(accented.get(0, 4).is_none());
+}
+
+GTEST_TEST(str, split_lines_trim) {
+  auto split = s("a,b,,c").split(s(","));
+  EXPECT_EQ(split.next(), make_some(s("a")));
+  EXPECT_EQ(split.next(), make_some(s("b")));
+  EXPECT_EQ(split.next(), make_some(s("")));
+  EXPECT_EQ(split.next(), make_some(s("c")));
+  EXPECT_TRUE(split.next().is_none());
+
+  auto multi = s("a::b").split(s("::"));
+  EXPECT_EQ(multi.next(), make_some(s("a")));
+  EXPECT_EQ(multi.next(), make_some(s("b")));
+  EXPECT_TRUE(multi.next().is_none());
+
+  auto lines = s("one\r\ntwo\n\nthree\n").lines();
+  EXPECT_EQ(lines.next(), make_some(s("one")));
+  EXPECT_EQ(lines.next(), make_some(s("two")));
+  EXPECT_EQ(lines.next(), make_some(s("")));
+  EXPECT_EQ(lines.next(), make_some(s("three")));
+  EXPECT_TRUE(lines.next().is_none());
+
+  EXPECT_EQ(s("  \t padded \n").trim(), s("padded"));
+  EXPECT_EQ(s("  left").trim_start(), s("left"));
+  EXPECT_EQ(s("right  ").trim_end(), s("right"));
+  EXPECT_TRUE(s("   ").trim().is_empty());
+}
+
+GTEST_TEST(str, cmp) {
+  EXPECT_TRUE(s("abc") == s("abc"));
+  EXPECT_TRUE(s("abc") != s("abd"));
+  EXPECT_TRUE(s("abc") < s("abd"));
+  EXPECT_TRUE(s("ab") < s("abc"));
+  EXPECT_TRUE(s("b") > s("abc"));
+  EXPECT_TRUE(s("abc").cmp(s("abc")) == cmp::make_equal());
+}
+
+/// run with `--gtest_also_run_disabled_tests'.
+GTEST_TEST(str, DISABLED_bench) {
+  constexpr usize LEN = usize{4} << 20;
+  Str needle = s("needle!");
+  Vec<u8> ascii = bench_text("plain ascii text, ", "needle!", LEN);
+  Vec<u8> mixed = bench_text(
+      "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 text, ", "needle!", LEN);
+  Vec<u8> copy = Vec<u8>::with_capacity(ascii.len());
+
+  bench_bytes("memcpy", "ascii", ascii.len(), [&]() {
+    std::memcpy(copy.as_mut_ptr(), ascii.as_ptr(), ascii.len());
+  });
+  EXPECT_EQ(copy.as_mut_ptr()[0], ascii[0]);
+  const char *names[]{"ascii", "mixed"};
+  const Vec<u8> *texts[]{&ascii, &mixed};
+  for (usize i = 0; i < 2; ++i) {
+    Slice<const u8> bytes = texts[i]->as_slice();
+    Str text = Str::from_utf8_unchecked(bytes);
+    bool valid = true;
+    bench_bytes("from_utf8", names[i], bytes.len(), [&]() {
+      valid = valid && Str::from_utf8(bytes).is_ok();
+    });
+    EXPECT_TRUE(valid);
+    usize found = 0;
+    bench_bytes("find", names[i], bytes.len(), [&]() {
+      found = text.find(needle).unwrap();
+    });
+    EXPECT_EQ(found, bytes.len() - needle.len());
+  }
+}
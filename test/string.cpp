@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+
+#include "crust/string.hpp"
+#include "crust/utility.hpp"
+
+
+using namespace crust;
+
+
+namespace {
+template <usize N>
+Str s(const char (&literal)[N]) {
+  return Str::from_static(literal);
+}
+
+String debug(Str str) {
+  String ret;
+  fmt::Formatter fmt = ret.formatter();
+  str.fmt_debug(fmt);
+  return ret;
+}
+} // namespace
+
+GTEST_TEST(string, sso) {
+  crust_static_assert(sizeof(String) == 3 * sizeof(usize));
+
+  String str;
+  EXPECT_TRUE(str.is_empty());
+  EXPECT_EQ(str.capacity(), 3 * sizeof(usize) - 1);
+
+  str.push_str(s("0123456789"));
+  str.push_str(s("0123456789"));
+  str.push_str(s("012"));
+  EXPECT_EQ(str.len(), 23u);
+  EXPECT_EQ(str.capacity(), 23u);
+  EXPECT_EQ(str.as_str(), s("01234567890123456789012"));
+
+  str.push('3');
+  EXPECT_EQ(str.len(), 24u);
+  EXPECT_GE(str.capacity(), 24u);
+  EXPECT_EQ(str.as_str(), s("012345678901234567890123"));
+
+  String moved{move(str)};
+  EXPECT_TRUE(str.is_empty());
+  EXPECT_EQ(moved.len(), 24u);
+  moved.truncate(2);
+  EXPECT_EQ(moved.as_str(), s("01"));
+}
+
+GTEST_TEST(string, push_self) {
+  // inline to heap.
+  String str = String::from(s("0123456789ab"));
+  str.push_str(str.as_str());
+  EXPECT_EQ(str.as_str(), s("0123456789ab0123456789ab"));
+
+  // heap to a larger heap buffer.
+  EXPECT_LT(str.capacity(), 48u);
+  str.push_str(str.as_str());
+  EXPECT_EQ(str.len(), 48u);
+  EXPECT_EQ(str.as_str().get(24, 48).unwrap(), s("0123456789ab0123456789ab"));
+}
+
+GTEST_TEST(string, chars) {
+  String str;
+  str.push('a');
+  str.push(0xE9);
+  str.push(0x20AC);
+  str.push(0x1F600);
+  EXPECT_EQ(str.as_str(), s("a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80"));
+
+  EXPECT_EQ(str.pop(), make_some<u32>(0x1F600));
+  EXPECT_EQ(str.pop(), make_some<u32>(0x20AC));
+  EXPECT_EQ(str.pop(), make_some<u32>(0xE9));
+  EXPECT_EQ(str.pop(), make_some<u32>('a'));
+  EXPECT_TRUE(str.pop().is_none());
+
+  const u8 invalid[] = {'a', 0xFF};
+  EXPECT_TRUE(String::from_utf8(Slice<const u8>::from_raw_parts(invalid, 2))
+                  .is_err());
+  EXPECT_EQ(
+      String::from_utf8(Slice<const u8>::from_raw_parts(invalid, 1)).unwrap(),
+      String::from(s("a")));
+}
+
+GTEST_TEST(string, traits) {
+  String a = String::from(s("a fairly long string that lives on the heap"));
+  String b = a.clone();
+  EXPECT_EQ(a, b);
+  b.push('!');
+  EXPECT_TRUE(a < b);
+
+  EXPECT_EQ(to_string(s("display")), String::from(s("display")));
+  EXPECT_EQ(to_string(a), a);
+  EXPECT_EQ(
+      debug(s("say \"hi\"\n\x01")).as_str(), s("\"say \\\"hi\\\"\\n\\x01\""));
+}
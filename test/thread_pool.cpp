@@ -0,0 +1,157 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "crust/sync/thread_pool.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+
+using namespace crust;
+using sync::ThreadPool;
+
+
+namespace {
+u64 fib(ThreadPool &pool, u32 n) {
+  if (n < 2) {
+    return n;
+  }
+  u64 a = 0;
+  u64 b = 0;
+  pool.join([&]() { a = fib(pool, n - 1); }, [&]() { b = fib(pool, n - 2); });
+  return a + b;
+}
+
+u64 sum(ThreadPool &pool, const u64 *values, usize len) {
+  if (len <= 4096) {
+    u64 ret = 0;
+    for (usize i = 0; i < len; ++i) {
+      ret += values[i];
+    }
+    return ret;
+  }
+  u64 a = 0;
+  u64 b = 0;
+  usize mid = len / 2;
+  pool.join(
+      [&]() { a = sum(pool, values, mid); },
+      [&]() { b = sum(pool, values + mid, len - mid); });
+  return a + b;
+}
+
+Vec<u64> iota(usize len) {
+  Vec<u64> ret = Vec<u64>::with_capacity(len);
+  for (usize i = 0; i < len; ++i) {
+    ret.push(i);
+  }
+  return ret;
+}
+
+/// pool sizes from one up to every hardware thread, doubling.
+Vec<usize> thread_counts() {
+  Vec<usize> ret;
+  usize cores = std::thread::hardware_concurrency();
+  for (usize i = 1; i < cores; i *= 2) {
+    ret.push(i);
+  }
+  ret.push(cores == 0 ? 1 : cores);
+  return ret;
+}
+
+template <class F>
+double seconds(F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+} // namespace
+
+GTEST_TEST(thread_pool, spawn) {
+  std::atomic<usize> count{0};
+  {
+    ThreadPool pool{4};
+    EXPECT_EQ(pool.num_threads(), 4u);
+    for (usize i = 0; i < 1000; ++i) {
+      pool.spawn([&pool, &count]() {
+        count.fetch_add(1);
+        pool.spawn([&count]() { count.fetch_add(1); });
+      });
+    }
+  }
+  EXPECT_EQ(count.load(), 2000u);
+}
+
+GTEST_TEST(thread_pool, join) {
+  ThreadPool pool{4};
+  EXPECT_EQ(fib(pool, 20), 6765u);
+
+  // from a thread outside the pool.
+  u64 result = 0;
+  std::thread outside{[&]() { result = fib(pool, 15); }};
+  outside.join();
+  EXPECT_EQ(result, 610u);
+
+  Vec<u64> values = iota(100000);
+  EXPECT_EQ(sum(pool, values.as_ptr(), values.len()), 4999950000u);
+}
+
+GTEST_TEST(thread_pool, scope) {
+  ThreadPool pool{3};
+  u64 partial[16] = {};
+  std::atomic<usize> nested{0};
+  pool.scope([&](sync::Scope &scope) {
+    for (usize i = 0; i < 16; ++i) {
+      scope.spawn([&, i]() {
+        for (u64 j = 0; j < 1000; ++j) {
+          partial[i] += j * i;
+        }
+        scope.spawn([&nested]() { nested.fetch_add(1); });
+      });
+    }
+  });
+  EXPECT_EQ(nested.load(), 16u);
+  for (usize i = 0; i < 16; ++i) {
+    EXPECT_EQ(partial[i], 499500u * i);
+  }
+}
+
+/// run with `--gtest_also_run_disabled_tests'.
+GTEST_TEST(thread_pool, DISABLED_bench_fib) {
+  Vec<usize> counts = thread_counts();
+  for (usize i = 0; i < counts.len(); ++i) {
+    usize threads = counts[i];
+    ThreadPool pool{threads};
+    u64 result = 0;
+    double elapsed = seconds([&]() { result = fib(pool, 30); });
+    EXPECT_EQ(result, 832040u);
+    // every call above the leaves is one join.
+    std::printf(
+        "fib(30) threads %2zu: %8.3f ms, %6.2f M joins/s\n",
+        static_cast<size_t>(threads),
+        elapsed * 1e3,
+        1346268 / elapsed / 1e6);
+  }
+}
+
+GTEST_TEST(thread_pool, DISABLED_bench_sum) {
+  Vec<u64> values = iota(usize{1} << 26);
+  Vec<usize> counts = thread_counts();
+  for (usize i = 0; i < counts.len(); ++i) {
+    usize threads = counts[i];
+    ThreadPool pool{threads};
+    u64 result = 0;
+    double elapsed =
+        seconds([&]() { result = sum(pool, values.as_ptr(), values.len()); });
+    EXPECT_EQ(result, values.len() * (values.len() - 1) / 2);
+    std::printf(
+        "sum(2^26) threads %2zu: %8.3f ms, %6.2f GB/s\n",
+        static_cast<size_t>(threads),
+        elapsed * 1e3,
+        values.len() * sizeof(u64) / elapsed / 1e9);
+  }
+}
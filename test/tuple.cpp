@@ -187,7 +187,7 @@ GTEST_TEST(tuple, size_two) {
 }
 
 GTEST_TEST(tuple, raii) {
-  auto recorder = std::make_shared<test::RAIIRecorder>(test::RAIIRecorder{});
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
 
   auto a = tuple(C{recorder}, D{recorder}, C{recorder}, D{recorder});
   auto b = a;
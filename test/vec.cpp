@@ -0,0 +1,230 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "crust/ops/range.hpp"
+#include "crust/utility.hpp"
+#include "crust/vec.hpp"
+
+#include "raii_checker.hpp"
+
+
+using namespace crust;
+using ops::bind_mut;
+
+
+namespace {
+struct Tracked : test::RAIIChecker<Tracked> {
+  CRUST_USE_BASE_CONSTRUCTORS(Tracked, test::RAIIChecker<Tracked>);
+};
+
+Vec<i32> range_vec(i32 start, i32 end) {
+  return range::Range<i32>{start, end}.collect<Vec<i32>>();
+}
+
+template <class F>
+double seconds(F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+void report(const char *workload, const char *name, double elapsed, u64 ops) {
+  std::printf("%-5s %-11s %6.2f ns/op\n", workload, name, elapsed / ops * 1e9);
+}
+} // namespace
+
+GTEST_TEST(vec, push_pop) {
+  Vec<i32> vec;
+  EXPECT_TRUE(vec.is_empty());
+  EXPECT_TRUE(vec.pop().is_none());
+
+  for (i32 i = 0; i < 100; ++i) {
+    vec.push(i);
+  }
+  EXPECT_EQ(vec.len(), 100u);
+  EXPECT_GE(vec.capacity(), 100u);
+  EXPECT_EQ(vec[42], 42);
+  EXPECT_EQ(*vec.last().unwrap(), 99);
+  EXPECT_TRUE(vec.get(100).is_none());
+  EXPECT_EQ(vec.pop(), make_some(99));
+  EXPECT_EQ(vec.len(), 99u);
+
+  vec.insert(0, -1);
+  EXPECT_EQ(*vec.first().unwrap(), -1);
+  EXPECT_EQ(vec.remove(0), -1);
+  EXPECT_EQ(vec.swap_remove(0), 0);
+  EXPECT_EQ(vec[0], 98);
+
+  vec.truncate(10);
+  vec.shrink_to_fit();
+  EXPECT_EQ(vec.capacity(), 10u);
+
+  Vec<i32> exact = Vec<i32>::with_capacity(3);
+  exact.reserve_exact(5);
+  EXPECT_EQ(exact.capacity(), 5u);
+
+  // sizes that would wrap around panic instead of reserving a tiny buffer.
+  EXPECT_DEATH(exact.reserve(static_cast<usize>(-1)), "capacity overflow!");
+  EXPECT_DEATH(
+      Vec<u64>::with_capacity(static_cast<usize>(-1) / 4),
+      "capacity overflow!");
+}
+
+GTEST_TEST(vec, extend_retain_dedup) {
+  i32 buffer[] = {1, 1, 2, 3, 3, 3, 4, 5, 5};
+  Vec<i32> vec;
+  vec.extend_from_slice(Slice<i32>::from_raw_parts(buffer, 9));
+  EXPECT_EQ(vec.len(), 9u);
+
+  vec.dedup();
+  EXPECT_EQ(vec, range_vec(1, 6));
+
+  vec.retain(bind_mut([](const i32 &value) { return value % 2 == 1; }));
+  Vec<i32> odd;
+  odd.push(1);
+  odd.push(3);
+  odd.push(5);
+  EXPECT_EQ(vec, odd);
+}
+
+GTEST_TEST(vec, drain) {
+  Vec<i32> vec = range_vec(0, 10);
+
+  {
+    auto drain = vec.drain(range::Range<usize>{2, 5});
+    EXPECT_EQ(drain.len(), 3u);
+    EXPECT_EQ(drain.next(), make_some(2));
+    EXPECT_EQ(drain.next_back(), make_some(4));
+  }
+
+  Vec<i32> expected = range_vec(0, 2);
+  expected.extend_from_slice(range_vec(5, 10).as_slice());
+  EXPECT_EQ(vec, expected);
+
+  auto all = vec.drain(range::Range<usize>{0, vec.len()}).collect<Vec<i32>>();
+  EXPECT_EQ(all, expected);
+  EXPECT_TRUE(vec.is_empty());
+}
+
+GTEST_TEST(vec, traits) {
+  Vec<i32> a = range_vec(0, 5);
+  Vec<i32> b = a.clone();
+  EXPECT_EQ(a, b);
+  EXPECT_TRUE(a.cmp(b) == cmp::make_equal());
+
+  b.push(0);
+  EXPECT_TRUE(a < b);
+  b[0] = -1;
+  EXPECT_TRUE(b < a);
+  EXPECT_TRUE(a.cmp(b) == cmp::make_greater());
+
+  a.clone_from(b);
+  EXPECT_EQ(a, b);
+
+  Vec<Ref<i32>> refs = a.iter().collect<Vec<Ref<i32>>>();
+  EXPECT_EQ(refs.len(), a.len());
+  EXPECT_EQ(&*refs[1], &a[1]);
+}
+
+GTEST_TEST(vec, clone_nested) {
+  Vec<Vec<i32>> nested;
+  nested.push(range_vec(0, 3));
+  nested.push(range_vec(3, 7));
+  Vec<Vec<i32>> copy = nested.clone();
+  EXPECT_EQ(copy, nested);
+  EXPECT_NE(copy[0].as_ptr(), nested[0].as_ptr());
+
+  copy.push(Vec<i32>{});
+  copy.clone_from(nested);
+  EXPECT_EQ(copy, nested);
+}
+
+GTEST_TEST(vec, extend_from_self) {
+  Vec<i32> vec = range_vec(0, 4);
+  vec.shrink_to_fit();
+  vec.extend_from_slice(vec.as_slice());
+  Vec<i32> expected = range_vec(0, 4);
+  expected.extend_from_slice(range_vec(0, 4).as_slice());
+  EXPECT_EQ(vec, expected);
+
+  Vec<Vec<i32>> nested;
+  nested.push(range_vec(0, 2));
+  nested.shrink_to_fit();
+  for (usize i = 0; i < 4; ++i) {
+    nested.extend_from_slice(nested.as_slice());
+  }
+  EXPECT_EQ(nested.len(), 16u);
+  EXPECT_EQ(nested[15], range_vec(0, 2));
+
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+  Vec<Tracked> tracked;
+  tracked.push(Tracked{recorder});
+  tracked.shrink_to_fit();
+  tracked.extend_from_slice(tracked.as_slice());
+  EXPECT_EQ(tracked.len(), 2u);
+}
+
+GTEST_TEST(vec, raii) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  Vec<Tracked> vec;
+  for (i32 i = 0; i < 20; ++i) {
+    vec.push(Tracked{recorder});
+  }
+  vec.insert(3, Tracked{recorder});
+  vec.remove(7);
+  vec.swap_remove(0);
+
+  usize index = 0;
+  vec.retain(bind_mut([&](const Tracked &) { return index++ % 3 != 0; }));
+  vec.drain(range::Range<usize>{1, 4}).next();
+  vec.pop();
+
+  Vec<Tracked> moved{move(vec)};
+  moved.shrink_to_fit();
+  moved = Vec<Tracked>{};
+}
+
+/// run with `--gtest_also_run_disabled_tests'.
+GTEST_TEST(vec, DISABLED_bench) {
+  constexpr u64 PUSHES = u64{1} << 24;
+  constexpr u64 ERASES = u64{1} << 15;
+
+  Vec<u64> vec;
+  std::vector<u64> std_vec;
+  report("push", "Vec", seconds([&]() {
+           for (u64 i = 0; i < PUSHES; ++i) {
+             vec.push(i);
+           }
+         }), PUSHES);
+  report("push", "std::vector", seconds([&]() {
+           for (u64 i = 0; i < PUSHES; ++i) {
+             std_vec.push_back(i);
+           }
+         }), PUSHES);
+  EXPECT_EQ(vec.len(), std_vec.size());
+
+  vec.truncate(ERASES);
+  std_vec.resize(ERASES);
+  u64 sum = 0;
+  u64 std_sum = 0;
+  report("erase", "Vec", seconds([&]() {
+           while (!vec.is_empty()) {
+             sum += vec.remove(vec.len() / 2);
+           }
+         }), ERASES);
+  report("erase", "std::vector", seconds([&]() {
+           while (!std_vec.empty()) {
+             auto middle = std_vec.begin() + std_vec.size() / 2;
+             std_sum += *middle;
+             std_vec.erase(middle);
+           }
+         }), ERASES);
+  EXPECT_EQ(sum, ERASES * (ERASES - 1) / 2);
+  EXPECT_EQ(std_sum, sum);
+}
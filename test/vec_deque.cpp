@@ -0,0 +1,131 @@
+#include "gtest/gtest.h"
+
+#include "crust/collections/vec_deque.hpp"
+#include "crust/ops/range.hpp"
+#include "crust/utility.hpp"
+
+#include "raii_checker.hpp"
+
+
+using namespace crust;
+using collections::VecDeque;
+
+
+namespace {
+struct Tracked : test::RAIIChecker<Tracked> {
+  CRUST_USE_BASE_CONSTRUCTORS(Tracked, test::RAIIChecker<Tracked>);
+};
+
+/// deque of `len' elements counting up from 0. the first `head' of them sit
+/// at the end of the buffer, the rest wraps around to its front.
+VecDeque<i32> wrapped(usize cap, usize len, usize head) {
+  VecDeque<i32> deque = VecDeque<i32>::with_capacity(cap);
+  for (usize i = 0; i < cap - head; ++i) {
+    deque.push_back(0);
+    deque.pop_front();
+  }
+  for (usize i = 0; i < len; ++i) {
+    deque.push_back(static_cast<i32>(i));
+  }
+  return deque;
+}
+} // namespace
+
+GTEST_TEST(vec_deque, push_pop) {
+  VecDeque<i32> deque;
+  EXPECT_TRUE(deque.pop_front().is_none());
+  EXPECT_TRUE(deque.pop_back().is_none());
+
+  for (i32 i = 0; i < 50; ++i) {
+    deque.push_back(i);
+    deque.push_front(-i - 1);
+  }
+  EXPECT_EQ(deque.len(), 100u);
+  EXPECT_EQ(deque.capacity(), 128u);
+  EXPECT_EQ(*deque.front().unwrap(), -50);
+  EXPECT_EQ(*deque.back().unwrap(), 49);
+  EXPECT_EQ(deque[50], 0);
+  EXPECT_TRUE(deque.get(100).is_none());
+
+  for (i32 i = 50; i > 0; --i) {
+    EXPECT_EQ(deque.pop_front(), make_some(-i));
+  }
+  EXPECT_EQ(deque.pop_back(), make_some(49));
+  EXPECT_EQ(deque.len(), 49u);
+
+  i32 expected = 0;
+  auto iter = deque.iter();
+  EXPECT_EQ(iter.len(), 49u);
+  EXPECT_EQ(*iter.next_back().unwrap(), 48);
+  for (auto x = iter.next(); x.is_some(); x = iter.next()) {
+    EXPECT_EQ(*move(x).unwrap(), expected++);
+  }
+  EXPECT_EQ(expected, 48);
+
+  deque.truncate(10);
+  EXPECT_EQ(deque.len(), 10u);
+  deque.clear();
+  EXPECT_TRUE(deque.is_empty());
+}
+
+GTEST_TEST(vec_deque, slices) {
+  VecDeque<i32> deque = wrapped(8, 6, 2);
+  auto slices = deque.as_slices();
+  EXPECT_EQ(slices.get<0>().len(), 2u);
+  EXPECT_EQ(slices.get<1>().len(), 4u);
+  EXPECT_EQ(slices.get<1>()[0], 2);
+
+  // every wrapped layout: room for the front part, for the back part or
+  // for neither.
+  for (usize len = 1; len <= 8; ++len) {
+    for (usize head = 0; head <= len; ++head) {
+      VecDeque<i32> deque = wrapped(8, len, head);
+      Slice<i32> slice = deque.make_contiguous();
+      ASSERT_EQ(slice.len(), len);
+      for (usize i = 0; i < len; ++i) {
+        EXPECT_EQ(slice[i], static_cast<i32>(i));
+      }
+      EXPECT_TRUE(deque.as_slices().get<1>().is_empty());
+      EXPECT_EQ(deque.capacity(), 8u);
+    }
+  }
+
+  // a sliding window keeps its capacity.
+  VecDeque<i32> window;
+  for (i32 i = 0; i < 1000; ++i) {
+    window.push_back(i);
+    if (window.len() > 5) {
+      window.pop_front();
+    }
+  }
+  EXPECT_EQ(window.capacity(), 8u);
+  EXPECT_EQ(*window.front().unwrap(), 995);
+}
+
+GTEST_TEST(vec_deque, traits) {
+  VecDeque<i32> deque = range::Range<i32>{0, 10}.collect<VecDeque<i32>>();
+  VecDeque<i32> copy = deque.clone();
+  EXPECT_TRUE(copy == deque);
+  copy.push_front(copy.pop_back().unwrap());
+  EXPECT_TRUE(copy != deque);
+  copy[0] = 10;
+  copy.push_front(0);
+  copy.pop_back();
+  EXPECT_EQ(copy[1], 10);
+}
+
+GTEST_TEST(vec_deque, raii) {
+  rc::Rc<test::RAIIRecorder> recorder{test::RAIIRecorder{}};
+
+  VecDeque<Tracked> deque;
+  for (i32 i = 0; i < 20; ++i) {
+    deque.push_back(Tracked{recorder});
+    deque.push_front(Tracked{recorder});
+  }
+  deque.pop_front();
+  deque.pop_back();
+  deque.make_contiguous();
+  VecDeque<Tracked> copy = deque.clone();
+  copy.truncate(5);
+  deque = move(copy);
+}